@@ -51,6 +51,10 @@ include common_features.mk
 include $(TMK_PATH)/common.mk
 include $(QUANTUM_PATH)/sequencer/tests/rules.mk
 include $(QUANTUM_PATH)/serial_link/tests/rules.mk
+include $(DRIVER_PATH)/eeprom/tests/rules.mk
+include $(DRIVER_PATH)/tests/rules.mk
+include $(QUANTUM_PATH)/tests/rules.mk
+include $(QUANTUM_PATH)/split_common/tests/rules.mk
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
 include build_full_test.mk
 endif
@@ -83,7 +83,7 @@ ifeq ($(strip $(POINTING_DEVICE_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/pointing_device.c
 endif
 
-VALID_EEPROM_DRIVER_TYPES := vendor custom transient i2c spi
+VALID_EEPROM_DRIVER_TYPES := vendor custom transient i2c spi journal
 EEPROM_DRIVER ?= vendor
 ifeq ($(filter $(EEPROM_DRIVER),$(VALID_EEPROM_DRIVER_TYPES)),)
   $(error EEPROM_DRIVER="$(EEPROM_DRIVER)" is not a valid EEPROM driver)
@@ -107,6 +107,20 @@ else
     OPT_DEFS += -DEEPROM_DRIVER -DEEPROM_TRANSIENT
     COMMON_VPATH += $(DRIVER_PATH)/eeprom
     SRC += eeprom_driver.c eeprom_transient.c
+  else ifeq ($(strip $(EEPROM_DRIVER)), journal)
+    OPT_DEFS += -DEEPROM_DRIVER -DEEPROM_JOURNAL
+    COMMON_VPATH += $(DRIVER_PATH)/eeprom
+    SRC += eeprom_driver.c eeprom_journal.c
+    SRC += $(PLATFORM_COMMON_DIR)/flash_stm32.c
+    ifeq ($(MCU_SERIES), STM32F3xx)
+      OPT_DEFS += -DEEPROM_EMU_STM32F303xC
+    else ifeq ($(MCU_SERIES), STM32F1xx)
+      OPT_DEFS += -DEEPROM_EMU_STM32F103xB
+    else ifeq ($(MCU_SERIES)_$(MCU_LDSCRIPT), STM32F0xx_STM32F072xB)
+      OPT_DEFS += -DEEPROM_EMU_STM32F072xB
+    else ifeq ($(MCU_SERIES)_$(MCU_LDSCRIPT), STM32F0xx_STM32F042x6)
+      OPT_DEFS += -DEEPROM_EMU_STM32F042x6
+    endif
   else ifeq ($(strip $(EEPROM_DRIVER)), vendor)
     OPT_DEFS += -DEEPROM_VENDOR
     ifeq ($(PLATFORM),AVR)
@@ -396,6 +410,19 @@ ifeq ($(strip $(DYNAMIC_KEYMAP_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/dynamic_keymap.c
 endif
 
+ifeq ($(strip $(EEPROM_DEFERRED_ENABLE)), yes)
+    OPT_DEFS += -DEEPROM_DEFERRED_ENABLE
+    SRC += $(QUANTUM_DIR)/eeprom_deferred.c
+endif
+
+ifeq ($(strip $(I2C_ASYNC_ENABLE)), yes)
+    ifneq ($(PLATFORM),CHIBIOS)
+        $(error I2C_ASYNC_ENABLE is only supported on ChibiOS)
+    endif
+    OPT_DEFS += -DI2C_ASYNC_ENABLE
+    QUANTUM_LIB_SRC += i2c_async.c i2c_master.c
+endif
+
 ifeq ($(strip $(DIP_SWITCH_ENABLE)), yes)
     OPT_DEFS += -DDIP_SWITCH_ENABLE
     SRC += $(QUANTUM_DIR)/dip_switch.c
@@ -412,6 +439,7 @@ ifneq ($(strip $(CUSTOM_MATRIX)), yes)
 
     # Include common stuff for all non custom matrix users
     QUANTUM_SRC += $(QUANTUM_DIR)/matrix_common.c
+    QUANTUM_SRC += $(QUANTUM_DIR)/matrix_ports.c
 
     # if 'lite' then skip the actual matrix implementation
     ifneq ($(strip $(CUSTOM_MATRIX)), lite)
@@ -424,6 +452,14 @@ ifneq ($(strip $(CUSTOM_MATRIX)), yes)
     endif
 endif
 
+ifeq ($(strip $(MATRIX_IDLE_ENABLE)), yes)
+    ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
+        $(error MATRIX_IDLE_ENABLE is not supported on split keyboards)
+    endif
+    OPT_DEFS += -DMATRIX_IDLE_ENABLE
+    QUANTUM_SRC += $(QUANTUM_DIR)/matrix_idle.c
+endif
+
 # Support for translating old names to new names:
 ifeq ($(strip $(DEBOUNCE_TYPE)),sym_g)
     DEBOUNCE_TYPE:=sym_defer_g
@@ -452,6 +488,20 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
     # Determine which (if any) transport files are required
     ifneq ($(strip $(SPLIT_TRANSPORT)), custom)
         QUANTUM_SRC += $(QUANTUM_DIR)/split_common/transport.c
+        ifeq ($(strip $(SPLIT_TRANSPORT_DELTA)), yes)
+            OPT_DEFS += -DSPLIT_TRANSPORT_DELTA
+            QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_delta.c
+            SPLIT_CRC_REQUIRED = yes
+        endif
+        ifeq ($(strip $(SPLIT_SHARED_STATE_ENABLE)), yes)
+            OPT_DEFS += -DSPLIT_SHARED_STATE_ENABLE
+            QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_shared.c
+            SPLIT_CRC_REQUIRED = yes
+        endif
+        ifeq ($(strip $(SPLIT_TELEMETRY_ENABLE)), yes)
+            OPT_DEFS += -DSPLIT_TELEMETRY_ENABLE
+            QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_telemetry.c
+        endif
         # Functions added via QUANTUM_LIB_SRC are only included in the final binary if they're called.
         # Unused functions are pruned away, which is why we can add multiple drivers here without bloat.
         ifeq ($(PLATFORM),AVR)
@@ -468,6 +518,14 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
         else
             QUANTUM_LIB_SRC += serial_$(strip $(SERIAL_DRIVER)).c
         endif
+        ifeq ($(strip $(SERIAL_DRIVER)), usart_duplex)
+            QUANTUM_LIB_SRC += serial_duplex.c
+            QUANTUM_SRC += $(QUANTUM_DIR)/serial_link/protocol/byte_stuffer.c
+            SPLIT_CRC_REQUIRED = yes
+        endif
+        ifeq ($(strip $(SPLIT_CRC_REQUIRED)), yes)
+            QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_crc.c
+        endif
     endif
     COMMON_VPATH += $(QUANTUM_PATH)/split_common
 endif
@@ -557,11 +615,13 @@ endif
 ifeq ($(strip $(COMBO_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/process_keycode/process_combo.c
     OPT_DEFS += -DCOMBO_ENABLE
+    DEFERRED_EXEC_ENABLE = yes
 endif
 
 ifeq ($(strip $(TAP_DANCE_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/process_keycode/process_tap_dance.c
     OPT_DEFS += -DTAP_DANCE_ENABLE
+    DEFERRED_EXEC_ENABLE = yes
 endif
 
 ifeq ($(strip $(KEY_LOCK_ENABLE)), yes)
@@ -577,11 +637,17 @@ endif
 ifeq ($(strip $(AUTO_SHIFT_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/process_keycode/process_auto_shift.c
     OPT_DEFS += -DAUTO_SHIFT_ENABLE
+    DEFERRED_EXEC_ENABLE = yes
     ifeq ($(strip $(AUTO_SHIFT_MODIFIERS)), yes)
         OPT_DEFS += -DAUTO_SHIFT_MODIFIERS
     endif
 endif
 
+ifeq ($(strip $(DEFERRED_EXEC_ENABLE)), yes)
+    OPT_DEFS += -DDEFERRED_EXEC_ENABLE
+    SRC += $(QUANTUM_DIR)/deferred_exec.c
+endif
+
 JOYSTICK_ENABLE ?= no
 ifneq ($(strip $(JOYSTICK_ENABLE)), no)
     OPT_DEFS += -DJOYSTICK_ENABLE
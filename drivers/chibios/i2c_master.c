@@ -29,6 +29,21 @@
 #include <string.h>
 #include <hal.h>
 
+#ifdef I2C_ASYNC_ENABLE
+#    include "i2c_async.h"
+
+#    if !I2C_USE_MUTUAL_EXCLUSION
+#        error "I2C_ASYNC_ENABLE requires I2C_USE_MUTUAL_EXCLUSION to be TRUE in halconf.h"
+#    endif
+
+// The worker thread and the main thread's i2c_start()/i2c_stop() share the driver
+#    define i2c_lock() i2cAcquireBus(&I2C_DRIVER)
+#    define i2c_unlock() i2cReleaseBus(&I2C_DRIVER)
+#else
+#    define i2c_lock()
+#    define i2c_unlock()
+#endif
+
 static uint8_t i2c_address;
 
 static const I2CConfig i2cconfig = {
@@ -78,44 +93,142 @@ __attribute__((weak)) void i2c_init(void) {
 }
 
 i2c_status_t i2c_start(uint8_t address) {
+    i2c_lock();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
+    i2c_unlock();
     return I2C_STATUS_SUCCESS;
 }
 
-i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+static i2c_status_t i2c_transfer_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_lock();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
+    i2c_unlock();
     return chibios_to_qmk(&status);
 }
 
-i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+static i2c_status_t i2c_transfer_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_lock();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
+    i2c_unlock();
     return chibios_to_qmk(&status);
 }
 
-i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
-    i2c_address = devaddr;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
-
+static i2c_status_t i2c_transfer_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
     uint8_t complete_packet[length + 1];
     for (uint8_t i = 0; i < length; i++) {
         complete_packet[i + 1] = data[i];
     }
     complete_packet[0] = regaddr;
 
+    i2c_lock();
+    i2c_address = devaddr;
+    i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), complete_packet, length + 1, 0, 0, TIME_MS2I(timeout));
+    i2c_unlock();
     return chibios_to_qmk(&status);
 }
 
-i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+static i2c_status_t i2c_transfer_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_lock();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
+    i2c_unlock();
     return chibios_to_qmk(&status);
 }
 
-void i2c_stop(void) { i2cStop(&I2C_DRIVER); }
+#ifdef I2C_ASYNC_ENABLE
+// With I2C_ASYNC_ENABLE, transactions are carried out by a background thread,
+// and the blocking functions below queue them and wait for them.
+static THD_WORKING_AREA(waI2CAsyncThread, I2C_ASYNC_THREAD_STACK_SIZE);
+static binary_semaphore_t i2c_async_wakeup;
+static binary_semaphore_t i2c_async_done;
+
+static i2c_status_t i2c_async_execute(const i2c_async_request_t* request) {
+    switch (request->operation) {
+        case I2C_ASYNC_TRANSMIT:
+            return i2c_transfer_transmit(request->address, request->data, request->length, request->timeout);
+        case I2C_ASYNC_RECEIVE:
+            return i2c_transfer_receive(request->address, request->data, request->length, request->timeout);
+        case I2C_ASYNC_WRITE_REG:
+            return i2c_transfer_writeReg(request->address, request->reg, request->data, request->length, request->timeout);
+        case I2C_ASYNC_READ_REG:
+            return i2c_transfer_readReg(request->address, request->reg, request->data, request->length, request->timeout);
+    }
+    return I2C_STATUS_ERROR;
+}
+
+// Sleeps while the I2C driver moves the data with DMA, so the main loop keeps running
+static THD_FUNCTION(i2c_async_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("i2c_async");
+    while (true) {
+        chBSemWait(&i2c_async_wakeup);
+
+        const i2c_async_request_t* request;
+        while ((request = i2c_async_next()) != NULL) {
+            i2c_async_complete(i2c_async_execute(request));
+            chBSemSignal(&i2c_async_done);
+        }
+    }
+}
+
+void i2c_async_backend_init(void) {
+    chBSemObjectInit(&i2c_async_wakeup, true);
+    chBSemObjectInit(&i2c_async_done, true);
+    chThdCreateStatic(waI2CAsyncThread, sizeof(waI2CAsyncThread), I2C_ASYNC_THREAD_PRIORITY, i2c_async_thread, NULL);
+}
+
+void i2c_async_backend_kick(void) { chBSemSignal(&i2c_async_wakeup); }
+
+void i2c_async_backend_lock(void) { chSysLock(); }
+
+void i2c_async_backend_unlock(void) { chSysUnlock(); }
+
+// Sleeps until the worker thread has completed a transaction. A completion
+// nobody waited for leaves the semaphore signalled, so it is never missed.
+void i2c_async_backend_wait(void) { chBSemWait(&i2c_async_done); }
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_request_t request = {.operation = I2C_ASYNC_TRANSMIT, .address = address, .data = (uint8_t*)data, .length = length, .timeout = timeout};
+    return i2c_async_transfer(&request);
+}
+
+i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_request_t request = {.operation = I2C_ASYNC_RECEIVE, .address = address, .data = data, .length = length, .timeout = timeout};
+    return i2c_async_transfer(&request);
+}
+
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_request_t request = {.operation = I2C_ASYNC_WRITE_REG, .address = devaddr, .reg = regaddr, .data = (uint8_t*)data, .length = length, .timeout = timeout};
+    return i2c_async_transfer(&request);
+}
+
+i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_request_t request = {.operation = I2C_ASYNC_READ_REG, .address = devaddr, .reg = regaddr, .data = data, .length = length, .timeout = timeout};
+    return i2c_async_transfer(&request);
+}
+#else
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) { return i2c_transfer_transmit(address, data, length, timeout); }
+
+i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) { return i2c_transfer_receive(address, data, length, timeout); }
+
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) { return i2c_transfer_writeReg(devaddr, regaddr, data, length, timeout); }
+
+i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) { return i2c_transfer_readReg(devaddr, regaddr, data, length, timeout); }
+#endif
+
+void i2c_stop(void) {
+#ifdef I2C_ASYNC_ENABLE
+    // Let queued transactions finish before the driver is stopped underneath them
+    i2c_async_flush();
+#endif
+    i2c_lock();
+    i2cStop(&I2C_DRIVER);
+    i2c_unlock();
+}
@@ -98,6 +98,14 @@
 #    endif
 #endif
 
+#ifndef I2C_ASYNC_THREAD_STACK_SIZE
+#    define I2C_ASYNC_THREAD_STACK_SIZE 512
+#endif
+
+#ifndef I2C_ASYNC_THREAD_PRIORITY
+#    define I2C_ASYNC_THREAD_PRIORITY (NORMALPRIO + 1)
+#endif
+
 typedef int16_t i2c_status_t;
 
 #define I2C_STATUS_SUCCESS (0)
@@ -0,0 +1,153 @@
+#include "quantum.h"
+#include "serial_duplex.h"
+
+#include <ch.h>
+#include <hal.h>
+
+#ifndef USART_CR1_M0
+#    define USART_CR1_M0 USART_CR1_M  // some platforms (f1xx) dont have this so
+#endif
+
+#ifndef USE_GPIOV1
+// The default PAL alternate modes are used to signal that the pins are used for USART
+#    ifndef SERIAL_USART_TX_PAL_MODE
+#        define SERIAL_USART_TX_PAL_MODE 7
+#    endif
+#    ifndef SERIAL_USART_RX_PAL_MODE
+#        define SERIAL_USART_RX_PAL_MODE 7
+#    endif
+#endif
+
+#ifndef SERIAL_USART_DRIVER
+#    define SERIAL_USART_DRIVER UARTD1
+#endif
+
+#ifndef SERIAL_USART_CR1
+#    define SERIAL_USART_CR1 (USART_CR1_PCE | USART_CR1_PS | USART_CR1_M0)  // parity enable, odd parity, 9 bit length
+#endif
+
+#ifndef SERIAL_USART_CR2
+#    define SERIAL_USART_CR2 (USART_CR2_STOP_1)  // 2 stop bits
+#endif
+
+#ifndef SERIAL_USART_CR3
+#    define SERIAL_USART_CR3 0
+#endif
+
+#ifdef SOFT_SERIAL_PIN
+#    define SERIAL_USART_TX_PIN SOFT_SERIAL_PIN
+#endif
+
+#ifndef SERIAL_USART_RX_PIN
+#    error "SERIAL_USART_RX_PIN has to be defined for the full-duplex driver"
+#endif
+
+#ifndef SELECT_SOFT_SERIAL_SPEED
+#    define SELECT_SOFT_SERIAL_SPEED 1
+#endif
+
+#ifdef SERIAL_USART_SPEED
+// Allow advanced users to directly set SERIAL_USART_SPEED
+#elif SELECT_SOFT_SERIAL_SPEED == 0
+#    define SERIAL_USART_SPEED 460800
+#elif SELECT_SOFT_SERIAL_SPEED == 1
+#    define SERIAL_USART_SPEED 230400
+#elif SELECT_SOFT_SERIAL_SPEED == 2
+#    define SERIAL_USART_SPEED 115200
+#elif SELECT_SOFT_SERIAL_SPEED == 3
+#    define SERIAL_USART_SPEED 57600
+#elif SELECT_SOFT_SERIAL_SPEED == 4
+#    define SERIAL_USART_SPEED 38400
+#elif SELECT_SOFT_SERIAL_SPEED == 5
+#    define SERIAL_USART_SPEED 19200
+#else
+#    error invalid SELECT_SOFT_SERIAL_SPEED value
+#endif
+
+static binary_semaphore_t rx_wakeup;
+static bool               is_slave = false;
+// Size of the block being sent by DMA, 0 when idle
+static uint16_t sending = 0;
+
+// Starts sending the next block, with the system locked
+static void serial_duplex_start_next(void) {
+    if (sending) {
+        return;
+    }
+    const uint8_t* data;
+    sending = serial_duplex_tx_next(&data);
+    if (sending) {
+        uartStartSendI(&SERIAL_USART_DRIVER, sending, data);
+    }
+}
+
+static void serial_duplex_txend(UARTDriver* uartp) {
+    (void)uartp;
+    chSysLockFromISR();
+    serial_duplex_tx_done(sending);
+    sending = 0;
+    serial_duplex_start_next();
+    chSysUnlockFromISR();
+}
+
+// Received bytes come in through DMA one at a time, as no receive is ever started
+static void serial_duplex_rxchar(UARTDriver* uartp, uint16_t c) {
+    (void)uartp;
+    serial_duplex_receive(c);
+    if (is_slave) {
+        chSysLockFromISR();
+        chBSemSignalI(&rx_wakeup);
+        chSysUnlockFromISR();
+    }
+}
+
+static UARTConfig uartcfg = {
+    .txend1_cb = serial_duplex_txend,
+    .rxchar_cb = serial_duplex_rxchar,
+    .speed     = (SERIAL_USART_SPEED),
+    .cr1       = (SERIAL_USART_CR1),
+    .cr2       = (SERIAL_USART_CR2),
+    .cr3       = (SERIAL_USART_CR3),
+};
+
+/*
+ * This thread runs on the slave and answers the frames sent by the master
+ */
+static THD_WORKING_AREA(waSlaveThread, 1024);
+static THD_FUNCTION(SlaveThread, arg) {
+    (void)arg;
+    chRegSetThreadName("slave_transport");
+
+    while (true) {
+        chBSemWait(&rx_wakeup);
+        serial_duplex_task();
+    }
+}
+
+__attribute__((weak)) void usart_init(void) {
+#if defined(USE_GPIOV1)
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_STM32_ALTERNATE_PUSHPULL);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_INPUT);
+#else
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_STM32_OTYPE_PUSHPULL);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_RX_PAL_MODE));
+#endif
+}
+
+void serial_duplex_backend_init(bool master) {
+    usart_init();
+
+    is_slave = !master;
+    chBSemObjectInit(&rx_wakeup, true);
+    uartStart(&SERIAL_USART_DRIVER, &uartcfg);
+
+    if (is_slave) {
+        chThdCreateStatic(waSlaveThread, sizeof(waSlaveThread), HIGHPRIO, SlaveThread, NULL);
+    }
+}
+
+void serial_duplex_backend_kick(void) {
+    chSysLock();
+    serial_duplex_start_next();
+    chSysUnlock();
+}
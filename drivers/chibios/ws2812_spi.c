@@ -39,7 +39,18 @@
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * 1250))
 #define PREAMBLE_SIZE 4
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+#define TXBUF_SIZE (PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE)
+
+/*
+ * Two frame buffers, so that the next frame can be encoded while the previous
+ * one is still being streamed out by the DMA. txbuf[front] is the one being
+ * sent, the other one is only ever written to from ws2812_setleds_async().
+ */
+static uint8_t txbuf[2][TXBUF_SIZE] = {{0}};
+static uint8_t front                = 0;
+
+static volatile bool in_flight = false;  // a frame is being streamed out
+static volatile bool pending   = false;  // the back buffer holds a frame waiting to be sent
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
@@ -59,8 +70,8 @@ static uint8_t get_protocol_eq(uint8_t data, int pos) {
     return eq;
 }
 
-static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+static void set_led_color_rgb(uint8_t* buf, LED_TYPE color, int pos) {
+    uint8_t* tx_start = &buf[PREAMBLE_SIZE];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
     for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
@@ -73,12 +84,29 @@ static void set_led_color_rgb(LED_TYPE color, int pos) {
 #endif
 }
 
+__attribute__((weak)) void ws2812_frame_complete(void) {}
+
+// Called from the SPI interrupt once a frame has been sent
+static void ws2812_spi_end(SPIDriver* spip) {
+    osalSysLockFromISR();
+    if (pending) {
+        pending = false;
+        front ^= 1;
+        spiStartSendI(spip, TXBUF_SIZE, txbuf[front]);
+    } else {
+        in_flight = false;
+    }
+    osalSysUnlockFromISR();
+
+    ws2812_frame_complete();
+}
+
 void ws2812_init(void) {
     palSetLineMode(RGB_DI_PIN, WS2812_OUTPUT_MODE);
 
     // TODO: more dynamic baudrate
     static const SPIConfig spicfg = {
-        0, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN),
+        0, ws2812_spi_end, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN),
         SPI_CR1_BR_1 | SPI_CR1_BR_0  // baudrate : fpclk / 8 => 1tick is 0.32us (2.25 MHz)
     };
 
@@ -87,22 +115,44 @@ void ws2812_init(void) {
     spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
 }
 
-void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
+bool ws2812_frame_in_flight(void) { return in_flight; }
+
+void ws2812_setleds_async(LED_TYPE* ledarray, uint16_t leds) {
     static bool s_init = false;
     if (!s_init) {
         ws2812_init();
         s_init = true;
     }
 
+    // Take back a frame that is still waiting, so that the interrupt doesn't
+    // start sending the back buffer while it is being overwritten.
+    osalSysLock();
+    pending      = false;
+    uint8_t* buf = txbuf[front ^ 1];
+    osalSysUnlock();
+
     for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+        set_led_color_rgb(buf, ledarray[i], i);
     }
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
+    // Each led takes ~0.03ms, 50 leds ~1.5ms. If the previous frame is still
+    // being sent, this one goes out as soon as it is done.
+    osalSysLock();
+    if (in_flight) {
+        pending = true;
+    } else {
+        in_flight = true;
+        front ^= 1;
+        spiStartSendI(&WS2812_SPI, TXBUF_SIZE, txbuf[front]);
+    }
+    osalSysUnlock();
+}
+
+void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
+    ws2812_setleds_async(ledarray, leds);
+
 #ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
-#else
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    while (in_flight) {
+    }
 #endif
 }
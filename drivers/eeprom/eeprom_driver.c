@@ -17,6 +17,16 @@
 #include <stdint.h>
 #include <string.h>
 
+// Compare and write external EEPROMs a page at a time
+#if defined(EEPROM_I2C)
+#    include "eeprom_i2c.h"
+#elif defined(EEPROM_SPI)
+#    include "eeprom_spi.h"
+#endif
+#if defined(EXTERNAL_EEPROM_PAGE_SIZE) && !defined(EEPROM_DRIVER_UPDATE_CHUNK_SIZE)
+#    define EEPROM_DRIVER_UPDATE_CHUNK_SIZE EXTERNAL_EEPROM_PAGE_SIZE
+#endif
+
 #include "eeprom_driver.h"
 
 uint8_t eeprom_read_byte(const uint8_t *addr) {
@@ -43,11 +53,41 @@ void eeprom_write_word(uint16_t *addr, uint16_t value) { eeprom_write_block(&val
 
 void eeprom_write_dword(uint32_t *addr, uint32_t value) { eeprom_write_block(&value, addr, 4); }
 
-void eeprom_update_block(const void *buf, void *addr, size_t len) {
-    uint8_t read_buf[len];
-    eeprom_read_block(read_buf, addr, len);
-    if (memcmp(buf, read_buf, len) != 0) {
-        eeprom_write_block(buf, addr, len);
+__attribute__((weak)) void eeprom_update_block(const void *buf, void *addr, size_t len) {
+    uint8_t        read_buf[EEPROM_DRIVER_UPDATE_CHUNK_SIZE];
+    const uint8_t *source = (const uint8_t *)buf;
+    uintptr_t      target = (uintptr_t)addr;
+    // Start of the current run of chunks that need writing
+    const uint8_t *run_source = source;
+    uintptr_t      run_target = target;
+    size_t         run_length = 0;
+
+    while (len > 0) {
+        // Chunks are aligned, so that they line up with the pages of paged memory
+        size_t chunk = EEPROM_DRIVER_UPDATE_CHUNK_SIZE - target % EEPROM_DRIVER_UPDATE_CHUNK_SIZE;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        eeprom_read_block(read_buf, (const void *)target, chunk);
+        if (memcmp(source, read_buf, chunk) != 0) {
+            if (run_length == 0) {
+                run_source = source;
+                run_target = target;
+            }
+            run_length += chunk;
+        } else if (run_length > 0) {
+            eeprom_write_block(run_source, (void *)run_target, run_length);
+            run_length = 0;
+        }
+
+        source += chunk;
+        target += chunk;
+        len -= chunk;
+    }
+
+    if (run_length > 0) {
+        eeprom_write_block(run_source, (void *)run_target, run_length);
     }
 }
 
@@ -20,3 +20,16 @@
 
 void eeprom_driver_init(void);
 void eeprom_driver_erase(void);
+
+/*
+    Drivers only need to provide eeprom_read_block() and eeprom_write_block().
+
+    eeprom_update_block() is the preferred way of writing more than a few bytes:
+    the default implementation compares the EEPROM in aligned chunks of
+    EEPROM_DRIVER_UPDATE_CHUNK_SIZE bytes, and writes each run of contiguous
+    chunks that differ with a single eeprom_write_block(). For the external
+    I2C and SPI EEPROMs, a chunk is one page.
+*/
+#ifndef EEPROM_DRIVER_UPDATE_CHUNK_SIZE
+#    define EEPROM_DRIVER_UPDATE_CHUNK_SIZE 32
+#endif
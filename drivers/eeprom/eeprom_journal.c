@@ -0,0 +1,231 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Append-only EEPROM emulation for STM32 flash.
+ *
+ * Two banks of flash are used. Each bank starts with a header, followed by a
+ * snapshot of the whole EEPROM, followed by a log of (address, value) records.
+ * Changing a byte only appends a record to the log of the active bank. Only
+ * when the log is full, the current contents are compacted into a snapshot in
+ * the spare bank, and the old bank is erased.
+ *
+ * The contents of the EEPROM are kept in RAM, and rebuilt from the snapshot and
+ * the log at startup, so reads never touch the flash.
+ *
+ * Every header field is programmed exactly once after an erase, which keeps it
+ * compatible with flash that can't reprogram a half word:
+ *   - receiving: set when a snapshot starts being copied into the bank
+ *   - active:    set when the bank holds the current contents
+ *   - obsolete:  set when the bank has been superseded by the other bank
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "eeprom_driver.h"
+#include "eeprom_journal.h"
+#include "flash_stm32.h"
+
+#define JOURNAL_MAGIC 0x4A4C  // "JL"
+#define JOURNAL_ERASED_HALFWORD 0xFFFF
+
+#define JOURNAL_HEADER_RECEIVING 0
+#define JOURNAL_HEADER_ACTIVE 2
+#define JOURNAL_HEADER_OBSOLETE 4
+
+#define JOURNAL_BANK_ADDRESS(bank) (JOURNAL_FLASH_BASE_ADDRESS + (bank)*JOURNAL_FLASH_BANK_SIZE)
+
+// A record is the EEPROM address, followed by the value in the low byte and its
+// complement in the high byte, so that an interrupted write can be detected.
+#define JOURNAL_RECORD_VALUE(value) ((uint16_t)(value) | ((uint16_t)(uint8_t)~(value) << 8))
+#define JOURNAL_RECORD_IS_VALID(data) (((data) >> 8) == (uint8_t) ~(data))
+
+typedef enum { BANK_ERASED, BANK_RECEIVING, BANK_ACTIVE, BANK_OBSOLETE, BANK_INVALID } journal_bank_state_t;
+
+__attribute__((aligned(4))) static uint8_t journal_image[JOURNAL_EEPROM_SIZE];
+
+static uint8_t  journal_bank;
+static uint32_t journal_log_position;
+
+static journal_bank_state_t journal_bank_state(uint8_t bank) {
+    uint32_t base      = JOURNAL_BANK_ADDRESS(bank);
+    uint16_t receiving = FLASH_ReadHalfWord(base + JOURNAL_HEADER_RECEIVING);
+    uint16_t active    = FLASH_ReadHalfWord(base + JOURNAL_HEADER_ACTIVE);
+    uint16_t obsolete  = FLASH_ReadHalfWord(base + JOURNAL_HEADER_OBSOLETE);
+
+    if (obsolete != JOURNAL_ERASED_HALFWORD) {
+        return BANK_OBSOLETE;
+    }
+    if (active == JOURNAL_MAGIC && receiving == JOURNAL_MAGIC) {
+        return BANK_ACTIVE;
+    }
+    if (active == JOURNAL_ERASED_HALFWORD && receiving == JOURNAL_MAGIC) {
+        return BANK_RECEIVING;
+    }
+    if (active == JOURNAL_ERASED_HALFWORD && receiving == JOURNAL_ERASED_HALFWORD) {
+        return BANK_ERASED;
+    }
+    return BANK_INVALID;
+}
+
+static void journal_bank_erase(uint8_t bank) {
+    // Only erase what needs erasing, to save both time and wear
+    uint32_t base = JOURNAL_BANK_ADDRESS(bank);
+    for (uint32_t page = 0; page < JOURNAL_FLASH_BANK_SIZE; page += JOURNAL_FLASH_PAGE_SIZE) {
+        for (uint32_t offset = 0; offset < JOURNAL_FLASH_PAGE_SIZE; offset += 2) {
+            if (FLASH_ReadHalfWord(base + page + offset) != JOURNAL_ERASED_HALFWORD) {
+                FLASH_ErasePage(base + page);
+                break;
+            }
+        }
+    }
+}
+
+// Writes the RAM image as a snapshot into the given (erased) bank, and makes it the active one.
+static void journal_bank_write_snapshot(uint8_t bank) {
+    uint32_t base = JOURNAL_BANK_ADDRESS(bank);
+
+    journal_bank_erase(bank);
+
+    FLASH_ProgramHalfWord(base + JOURNAL_HEADER_RECEIVING, JOURNAL_MAGIC);
+    for (uint32_t offset = 0; offset < JOURNAL_EEPROM_SIZE; offset += 2) {
+        uint16_t data = journal_image[offset] | (journal_image[offset + 1] << 8);
+        if (data != JOURNAL_ERASED_HALFWORD) {
+            FLASH_ProgramHalfWord(base + JOURNAL_HEADER_SIZE + offset, data);
+        }
+    }
+
+    // The previous bank is marked obsolete before the new one is marked active,
+    // so that there is never more than one active bank.
+    uint8_t previous = bank ^ 1;
+    if (journal_bank_state(previous) == BANK_ACTIVE) {
+        FLASH_ProgramHalfWord(JOURNAL_BANK_ADDRESS(previous) + JOURNAL_HEADER_OBSOLETE, 0);
+    }
+    FLASH_ProgramHalfWord(base + JOURNAL_HEADER_ACTIVE, JOURNAL_MAGIC);
+
+    journal_bank_erase(previous);
+
+    journal_bank         = bank;
+    journal_log_position = JOURNAL_LOG_OFFSET;
+}
+
+// Rebuilds the RAM image from the snapshot and the log of the active bank.
+static void journal_bank_load(uint8_t bank) {
+    uint32_t base = JOURNAL_BANK_ADDRESS(bank);
+
+    for (uint32_t offset = 0; offset < JOURNAL_EEPROM_SIZE; offset += 2) {
+        uint16_t data             = FLASH_ReadHalfWord(base + JOURNAL_HEADER_SIZE + offset);
+        journal_image[offset]     = data & 0xFF;
+        journal_image[offset + 1] = data >> 8;
+    }
+
+    uint32_t position = JOURNAL_LOG_OFFSET;
+    while (position + JOURNAL_RECORD_SIZE <= JOURNAL_FLASH_BANK_SIZE) {
+        uint16_t address = FLASH_ReadHalfWord(base + position);
+        uint16_t value   = FLASH_ReadHalfWord(base + position + 2);
+        if (address == JOURNAL_ERASED_HALFWORD && value == JOURNAL_ERASED_HALFWORD) {
+            break;
+        }
+        // Skip records that were only partially written
+        if (address < JOURNAL_EEPROM_SIZE && JOURNAL_RECORD_IS_VALID(value)) {
+            journal_image[address] = value & 0xFF;
+        }
+        position += JOURNAL_RECORD_SIZE;
+    }
+
+    journal_bank         = bank;
+    journal_log_position = position;
+}
+
+// Appends a record to the log of the active bank. Returns false if the log is full.
+static bool journal_append(uint16_t address, uint8_t value) {
+    if (journal_log_position + JOURNAL_RECORD_SIZE > JOURNAL_FLASH_BANK_SIZE) {
+        return false;
+    }
+
+    uint32_t record = JOURNAL_BANK_ADDRESS(journal_bank) + journal_log_position;
+    FLASH_ProgramHalfWord(record, address);
+    FLASH_ProgramHalfWord(record + 2, JOURNAL_RECORD_VALUE(value));
+    journal_log_position += JOURNAL_RECORD_SIZE;
+    return true;
+}
+
+void eeprom_driver_init(void) {
+    FLASH_Unlock();
+
+    journal_bank_state_t state[2] = {journal_bank_state(0), journal_bank_state(1)};
+
+    for (uint8_t bank = 0; bank < 2; bank++) {
+        uint8_t other = bank ^ 1;
+        if (state[bank] == BANK_ACTIVE) {
+            // Clean up after an interrupted compaction, or a bank that was never fully erased
+            journal_bank_erase(other);
+            journal_bank_load(bank);
+            return;
+        }
+        if (state[bank] == BANK_RECEIVING && state[other] == BANK_OBSOLETE) {
+            // The snapshot was complete, but the bank was never marked as active
+            FLASH_ProgramHalfWord(JOURNAL_BANK_ADDRESS(bank) + JOURNAL_HEADER_ACTIVE, JOURNAL_MAGIC);
+            journal_bank_erase(other);
+            journal_bank_load(bank);
+            return;
+        }
+    }
+
+    // Nothing usable in flash, start from scratch
+    memset(journal_image, 0xFF, JOURNAL_EEPROM_SIZE);
+    journal_bank_erase(1);
+    journal_bank_write_snapshot(0);
+}
+
+void eeprom_driver_erase(void) {
+    memset(journal_image, 0xFF, JOURNAL_EEPROM_SIZE);
+    journal_bank_write_snapshot(journal_bank ^ 1);
+}
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    uintptr_t offset = (uintptr_t)addr;
+    memset(buf, 0xFF, len);
+    if (offset >= JOURNAL_EEPROM_SIZE) {
+        return;
+    }
+    if (offset + len > JOURNAL_EEPROM_SIZE) {
+        len = JOURNAL_EEPROM_SIZE - offset;
+    }
+    memcpy(buf, &journal_image[offset], len);
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    uintptr_t      offset = (uintptr_t)addr;
+    const uint8_t *src    = (const uint8_t *)buf;
+
+    for (size_t i = 0; i < len && offset + i < JOURNAL_EEPROM_SIZE; i++) {
+        uint16_t address = offset + i;
+        if (journal_image[address] == src[i]) {
+            continue;
+        }
+        journal_image[address] = src[i];
+        if (!journal_append(address, src[i])) {
+            // The snapshot includes the new value, so there is nothing left to append
+            journal_bank_write_snapshot(journal_bank ^ 1);
+        }
+    }
+}
+
+// Writing already skips unchanged bytes
+void eeprom_update_block(const void *buf, void *addr, size_t len) { eeprom_write_block(buf, addr, len); }
@@ -0,0 +1,88 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+    The size of the emulated EEPROM, in bytes. A copy of it is kept in RAM.
+*/
+#ifndef JOURNAL_EEPROM_SIZE
+#    ifdef VIA_ENABLE
+#        define JOURNAL_EEPROM_SIZE 1024
+#    else
+#        include "eeconfig.h"
+#        define JOURNAL_EEPROM_SIZE (((EECONFIG_SIZE + 3) / 4) * 4)  // based off eeconfig's current usage, aligned to 4-byte sizes
+#    endif
+#endif
+
+/*
+    The erase granularity of the flash, in bytes.
+*/
+#ifndef JOURNAL_FLASH_PAGE_SIZE
+#    if defined(EEPROM_EMU_STM32F103xB) || defined(EEPROM_EMU_STM32F042x6)
+#        define JOURNAL_FLASH_PAGE_SIZE 0x400
+#    elif defined(EEPROM_EMU_STM32F303xC) || defined(EEPROM_EMU_STM32F072xB)
+#        define JOURNAL_FLASH_PAGE_SIZE 0x800
+#    else
+#        error "JOURNAL_FLASH_PAGE_SIZE is not defined for this MCU."
+#    endif
+#endif
+
+/*
+    The total size of the MCU's flash, in bytes. The journal lives at the top of it.
+*/
+#ifndef JOURNAL_FLASH_SIZE
+#    if defined(EEPROM_EMU_STM32F103xB) || defined(EEPROM_EMU_STM32F072xB)
+#        define JOURNAL_FLASH_SIZE (128 * 1024)
+#    elif defined(EEPROM_EMU_STM32F042x6)
+#        define JOURNAL_FLASH_SIZE (32 * 1024)
+#    elif defined(EEPROM_EMU_STM32F303xC)
+#        define JOURNAL_FLASH_SIZE (256 * 1024)
+#    else
+#        error "JOURNAL_FLASH_SIZE is not defined for this MCU."
+#    endif
+#endif
+
+/*
+    The size of each of the two flash banks, in bytes. One bank is active, the
+    other one is kept erased and is used when the active bank's log is full.
+    Anything not taken up by the header and the snapshot of the EEPROM is log space.
+*/
+#ifndef JOURNAL_FLASH_BANK_SIZE
+#    define JOURNAL_FLASH_BANK_SIZE (2 * JOURNAL_FLASH_PAGE_SIZE)
+#endif
+
+#ifndef JOURNAL_FLASH_BASE_ADDRESS
+#    define JOURNAL_FLASH_BASE_ADDRESS (0x08000000 + JOURNAL_FLASH_SIZE - 2 * JOURNAL_FLASH_BANK_SIZE)
+#endif
+
+// DONT CHANGE
+#define JOURNAL_HEADER_SIZE 8
+#define JOURNAL_RECORD_SIZE 4
+#define JOURNAL_LOG_OFFSET (JOURNAL_HEADER_SIZE + JOURNAL_EEPROM_SIZE)
+#define JOURNAL_LOG_RECORDS ((JOURNAL_FLASH_BANK_SIZE - JOURNAL_LOG_OFFSET) / JOURNAL_RECORD_SIZE)
+
+#if (JOURNAL_EEPROM_SIZE % 4) != 0
+#    error "JOURNAL_EEPROM_SIZE must be a multiple of 4."
+#endif
+
+#if (JOURNAL_FLASH_BANK_SIZE % JOURNAL_FLASH_PAGE_SIZE) != 0
+#    error "JOURNAL_FLASH_BANK_SIZE must be a multiple of JOURNAL_FLASH_PAGE_SIZE."
+#endif
+
+#if JOURNAL_FLASH_BANK_SIZE < JOURNAL_LOG_OFFSET + 64 * JOURNAL_RECORD_SIZE
+#    error "JOURNAL_FLASH_BANK_SIZE is too small to hold the EEPROM and a useful amount of log records."
+#endif
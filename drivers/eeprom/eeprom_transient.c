@@ -50,3 +50,5 @@ void eeprom_write_block(const void *buf, void *addr, size_t len) {
         memcpy(&transientBuffer[offset], buf, len);
     }
 }
+
+void eeprom_update_block(const void *buf, void *addr, size_t len) { eeprom_write_block(buf, addr, len); }
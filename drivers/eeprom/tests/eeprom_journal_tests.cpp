@@ -0,0 +1,160 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "eeprom_driver.h"
+#include "eeprom_journal.h"
+#include "flash_stm32.h"
+}
+
+class EepromJournalTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        flash_sim_reset();
+        eeprom_driver_init();
+    }
+
+    void reboot(void) {
+        flash_sim_restore_power();
+        FLASH_Lock();
+        eeprom_driver_init();
+    }
+};
+
+TEST_F(EepromJournalTest, StartsOutErased) {
+    for (uint16_t i = 0; i < JOURNAL_EEPROM_SIZE; i++) {
+        EXPECT_EQ(eeprom_read_byte((uint8_t *)(uintptr_t)i), 0xFF);
+    }
+    EXPECT_EQ(flash_sim_error_count(), 0);
+}
+
+TEST_F(EepromJournalTest, ReadsBackWrittenValues) {
+    eeprom_write_byte((uint8_t *)10, 0x12);
+    eeprom_write_word((uint16_t *)20, 0x3456);
+    eeprom_write_dword((uint32_t *)30, 0x789ABCDE);
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)10), 0x12);
+    EXPECT_EQ(eeprom_read_word((uint16_t *)20), 0x3456);
+    EXPECT_EQ(eeprom_read_dword((uint32_t *)30), 0x789ABCDE);
+}
+
+TEST_F(EepromJournalTest, ValuesSurviveAReboot) {
+    eeprom_write_byte((uint8_t *)0, 0x00);
+    eeprom_write_byte((uint8_t *)1, 0x5A);
+    eeprom_write_byte((uint8_t *)1, 0xA5);
+    eeprom_write_byte((uint8_t *)(JOURNAL_EEPROM_SIZE - 1), 0x42);
+    reboot();
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)0), 0x00);
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)1), 0xA5);
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)(JOURNAL_EEPROM_SIZE - 1)), 0x42);
+    EXPECT_EQ(flash_sim_error_count(), 0);
+}
+
+TEST_F(EepromJournalTest, WritingAByteDoesNotEraseFlash) {
+    uint32_t erases = flash_sim_total_erase_count();
+    uint64_t start  = flash_sim_busy_time();
+    eeprom_write_byte((uint8_t *)5, 0x01);
+    EXPECT_EQ(flash_sim_total_erase_count(), erases);
+    EXPECT_EQ(flash_sim_busy_time() - start, 2 * FLASH_SIM_PROGRAM_TIME_US);
+}
+
+TEST_F(EepromJournalTest, UnchangedValuesAreNotWritten) {
+    eeprom_update_byte((uint8_t *)5, 0x01);
+    uint32_t programs = flash_sim_program_count();
+    eeprom_update_byte((uint8_t *)5, 0x01);
+    eeprom_write_byte((uint8_t *)5, 0x01);
+    EXPECT_EQ(flash_sim_program_count(), programs);
+}
+
+TEST_F(EepromJournalTest, ContentsSurviveCompaction) {
+    uint8_t expected[JOURNAL_EEPROM_SIZE];
+    memset(expected, 0xFF, sizeof(expected));
+    srand(1);
+    for (int i = 0; i < 5 * JOURNAL_LOG_RECORDS; i++) {
+        uint16_t address  = rand() % JOURNAL_EEPROM_SIZE;
+        uint8_t  value    = rand();
+        expected[address] = value;
+        eeprom_write_byte((uint8_t *)(uintptr_t)address, value);
+    }
+    EXPECT_GT(flash_sim_total_erase_count(), 0);
+    reboot();
+    uint8_t actual[JOURNAL_EEPROM_SIZE];
+    eeprom_read_block(actual, 0, JOURNAL_EEPROM_SIZE);
+    EXPECT_EQ(memcmp(expected, actual, JOURNAL_EEPROM_SIZE), 0);
+    EXPECT_EQ(flash_sim_error_count(), 0);
+}
+
+TEST_F(EepromJournalTest, ErasingResetsContents) {
+    eeprom_write_byte((uint8_t *)7, 0x00);
+    eeprom_driver_erase();
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)7), 0xFF);
+    reboot();
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)7), 0xFF);
+    EXPECT_EQ(flash_sim_error_count(), 0);
+}
+
+TEST_F(EepromJournalTest, PowerLossNeverCorruptsOtherBytes) {
+    uint8_t expected[JOURNAL_EEPROM_SIZE];
+    memset(expected, 0xFF, sizeof(expected));
+    srand(2);
+    // Cut the power at every possible point of a series of writes, which includes compactions
+    for (uint32_t operations = 0; operations < 3 * JOURNAL_LOG_RECORDS; operations++) {
+        uint16_t address = rand() % JOURNAL_EEPROM_SIZE;
+        uint8_t  value   = rand();
+        flash_sim_cut_power_after(operations % (JOURNAL_EEPROM_SIZE / 2 + 8));
+        eeprom_write_byte((uint8_t *)(uintptr_t)address, value);
+        reboot();
+
+        uint8_t actual[JOURNAL_EEPROM_SIZE];
+        eeprom_read_block(actual, 0, JOURNAL_EEPROM_SIZE);
+        ASSERT_TRUE(actual[address] == expected[address] || actual[address] == value);
+        expected[address] = actual[address];
+        ASSERT_EQ(memcmp(expected, actual, JOURNAL_EEPROM_SIZE), 0);
+    }
+    EXPECT_EQ(flash_sim_error_count(), 0);
+}
+
+TEST_F(EepromJournalTest, WearAndWorstCaseLatency) {
+    const int writes = 10000;
+    uint64_t  worst  = 0;
+    uint64_t  total  = 0;
+    srand(3);
+    for (int i = 0; i < writes; i++) {
+        // Settings tend to be clustered at the start of the EEPROM
+        uint16_t address = rand() % 64;
+        uint8_t  value   = eeprom_read_byte((uint8_t *)(uintptr_t)address) + 1;
+        uint64_t start   = flash_sim_busy_time();
+        eeprom_write_byte((uint8_t *)(uintptr_t)address, value);
+        uint64_t elapsed = flash_sim_busy_time() - start;
+        total += elapsed;
+        if (elapsed > worst) {
+            worst = elapsed;
+        }
+    }
+
+    // A page rewrite per changed byte would erase a page on every single write
+    uint32_t max_erases = flash_sim_max_erase_count();
+    EXPECT_LE(max_erases, writes / JOURNAL_LOG_RECORDS + 1);
+    // Compaction programs the snapshot and erases the previous bank
+    EXPECT_LE(worst, (JOURNAL_EEPROM_SIZE / 2 + 4) * FLASH_SIM_PROGRAM_TIME_US + (JOURNAL_FLASH_BANK_SIZE / JOURNAL_FLASH_PAGE_SIZE) * FLASH_SIM_ERASE_TIME_US);
+    EXPECT_EQ(flash_sim_error_count(), 0);
+
+    printf("%d writes: max erases per page %u, average write %u us, worst case write %u us\n", writes, (unsigned)max_erases, (unsigned)(total / writes), (unsigned)worst);
+}
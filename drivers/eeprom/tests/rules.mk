@@ -0,0 +1,8 @@
+eeprom_journal_DEFS := -DJOURNAL_EEPROM_SIZE=1024 -DJOURNAL_FLASH_PAGE_SIZE=0x400 -DJOURNAL_FLASH_SIZE=0x8000
+eeprom_journal_INC := $(DRIVER_PATH)/eeprom
+
+eeprom_journal_SRC := \
+	$(DRIVER_PATH)/eeprom/tests/eeprom_journal_tests.cpp \
+	$(DRIVER_PATH)/eeprom/eeprom_journal.c \
+	$(DRIVER_PATH)/eeprom/eeprom_driver.c \
+	$(TMK_PATH)/common/test/flash_stm32.c
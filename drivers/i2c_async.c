@@ -0,0 +1,218 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+
+#include "i2c_async.h"
+
+#if I2C_ASYNC_QUEUE_SIZE > 127
+#    error "I2C_ASYNC_QUEUE_SIZE must be 127 or less."
+#endif
+
+typedef enum {
+    SLOT_FREE,
+    SLOT_QUEUED,
+    SLOT_ACTIVE,
+    SLOT_DONE,
+} i2c_async_slot_state_t;
+
+typedef struct {
+    i2c_async_request_t             request;
+    volatile i2c_async_slot_state_t state;
+    volatile i2c_status_t           status;
+    uint8_t                         priority;
+    uint16_t                        sequence;
+} i2c_async_slot_t;
+
+typedef struct {
+    uint8_t address;
+    uint8_t priority;
+} i2c_async_priority_t;
+
+static i2c_async_slot_t     slots[I2C_ASYNC_QUEUE_SIZE];
+static i2c_async_slot_t *   active_slot = NULL;
+static uint16_t             next_sequence;
+static i2c_async_priority_t priorities[I2C_ASYNC_PRIORITY_DEVICES];
+static uint8_t              priority_count;
+static bool                 backend_initialised = false;
+
+static uint8_t i2c_async_get_priority(uint8_t address) {
+    for (uint8_t i = 0; i < priority_count; i++) {
+        if (priorities[i].address == address) {
+            return priorities[i].priority;
+        }
+    }
+    return 0;
+}
+
+void i2c_async_set_priority(uint8_t address, uint8_t priority) {
+    for (uint8_t i = 0; i < priority_count; i++) {
+        if (priorities[i].address == address) {
+            priorities[i].priority = priority;
+            return;
+        }
+    }
+    if (priority_count < I2C_ASYNC_PRIORITY_DEVICES) {
+        priorities[priority_count].address  = address;
+        priorities[priority_count].priority = priority;
+        priority_count++;
+    }
+}
+
+i2c_async_handle_t i2c_async_submit(const i2c_async_request_t *request) {
+    if (!backend_initialised) {
+        backend_initialised = true;
+        i2c_async_backend_init();
+    }
+
+    i2c_async_handle_t handle = I2C_ASYNC_INVALID_HANDLE;
+    i2c_async_backend_lock();
+    for (uint8_t i = 0; i < I2C_ASYNC_QUEUE_SIZE; i++) {
+        if (slots[i].state == SLOT_FREE) {
+            slots[i].request  = *request;
+            slots[i].priority = i2c_async_get_priority(request->address);
+            slots[i].sequence = next_sequence++;
+            slots[i].state    = SLOT_QUEUED;
+            handle            = i;
+            break;
+        }
+    }
+    i2c_async_backend_unlock();
+
+    if (handle != I2C_ASYNC_INVALID_HANDLE) {
+        i2c_async_backend_kick();
+    }
+    return handle;
+}
+
+static i2c_async_handle_t i2c_async_queue(i2c_async_operation_t operation, uint8_t address, uint8_t reg, uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context) {
+    i2c_async_request_t request = {
+        .operation = operation,
+        .address   = address,
+        .reg       = reg,
+        .data      = data,
+        .length    = length,
+        .timeout   = timeout,
+        .callback  = callback,
+        .context   = context,
+    };
+    return i2c_async_submit(&request);
+}
+
+i2c_async_handle_t i2c_async_transmit(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context) { return i2c_async_queue(I2C_ASYNC_TRANSMIT, address, 0, (uint8_t *)data, length, timeout, callback, context); }
+
+i2c_async_handle_t i2c_async_receive(uint8_t address, uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context) { return i2c_async_queue(I2C_ASYNC_RECEIVE, address, 0, data, length, timeout, callback, context); }
+
+i2c_async_handle_t i2c_async_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context) { return i2c_async_queue(I2C_ASYNC_WRITE_REG, devaddr, regaddr, (uint8_t *)data, length, timeout, callback, context); }
+
+i2c_async_handle_t i2c_async_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context) { return i2c_async_queue(I2C_ASYNC_READ_REG, devaddr, regaddr, data, length, timeout, callback, context); }
+
+const i2c_async_request_t *i2c_async_next(void) {
+    i2c_async_backend_lock();
+    i2c_async_slot_t *next = NULL;
+    for (uint8_t i = 0; i < I2C_ASYNC_QUEUE_SIZE; i++) {
+        if (slots[i].state != SLOT_QUEUED) {
+            continue;
+        }
+        // Sequence numbers are compared as a difference, so that they can wrap around
+        if (next == NULL || slots[i].priority > next->priority || (slots[i].priority == next->priority && (int16_t)(slots[i].sequence - next->sequence) < 0)) {
+            next = &slots[i];
+        }
+    }
+    if (next != NULL) {
+        next->state = SLOT_ACTIVE;
+    }
+    active_slot = next;
+    i2c_async_backend_unlock();
+
+    return next != NULL ? &next->request : NULL;
+}
+
+void i2c_async_complete(i2c_status_t status) {
+    i2c_async_backend_lock();
+    if (active_slot != NULL) {
+        active_slot->status = status;
+        active_slot->state  = SLOT_DONE;
+        active_slot         = NULL;
+    }
+    i2c_async_backend_unlock();
+}
+
+i2c_status_t i2c_async_wait(i2c_async_handle_t handle) {
+    if (handle < 0 || handle >= I2C_ASYNC_QUEUE_SIZE) {
+        return I2C_STATUS_ERROR;
+    }
+
+    while (slots[handle].state == SLOT_QUEUED || slots[handle].state == SLOT_ACTIVE) {
+        i2c_async_backend_wait();
+    }
+
+    i2c_status_t status = slots[handle].status;
+    slots[handle].state = SLOT_FREE;
+    return status;
+}
+
+i2c_status_t i2c_async_transfer(const i2c_async_request_t *request) {
+    i2c_async_request_t blocking = *request;
+    blocking.callback            = NULL;
+
+    i2c_async_handle_t handle = i2c_async_submit(&blocking);
+    while (handle == I2C_ASYNC_INVALID_HANDLE) {
+        // Queue is full, release the completed transactions, or wait for one to complete
+        i2c_async_task();
+        handle = i2c_async_submit(&blocking);
+        if (handle == I2C_ASYNC_INVALID_HANDLE) {
+            if (!i2c_async_busy()) {
+                // Every slot holds a completed transaction nobody waited for
+                return I2C_STATUS_ERROR;
+            }
+            i2c_async_backend_wait();
+        }
+    }
+    return i2c_async_wait(handle);
+}
+
+bool i2c_async_busy(void) {
+    for (uint8_t i = 0; i < I2C_ASYNC_QUEUE_SIZE; i++) {
+        if (slots[i].state == SLOT_QUEUED || slots[i].state == SLOT_ACTIVE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void i2c_async_flush(void) {
+    while (i2c_async_busy()) {
+        i2c_async_backend_wait();
+    }
+    i2c_async_task();
+}
+
+void i2c_async_task(void) {
+    for (uint8_t i = 0; i < I2C_ASYNC_QUEUE_SIZE; i++) {
+        if (slots[i].state != SLOT_DONE) {
+            continue;
+        }
+        // Transactions without a callback are released by i2c_async_wait()
+        if (slots[i].request.callback != NULL) {
+            // Free the slot first, so that the callback can queue the next transaction
+            i2c_async_request_t request = slots[i].request;
+            i2c_status_t        status  = slots[i].status;
+            slots[i].state              = SLOT_FREE;
+            request.callback(status, request.context);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_master.h"
+
+/*
+ * Non-blocking I2C transactions.
+ *
+ * Transactions are queued and carried out in the background by the platform's
+ * I2C backend, so that the main loop can carry on scanning the matrix while a
+ * display or LED driver is being updated. The data passed in has to stay valid
+ * until the transaction has completed.
+ *
+ * Queued transactions are started highest priority first, and in the order
+ * they were submitted for the same priority. Completion callbacks are called
+ * from i2c_async_task(), in the main loop.
+ */
+
+#ifndef I2C_ASYNC_QUEUE_SIZE
+#    define I2C_ASYNC_QUEUE_SIZE 8
+#endif
+
+#ifndef I2C_ASYNC_PRIORITY_DEVICES
+#    define I2C_ASYNC_PRIORITY_DEVICES 4
+#endif
+
+typedef enum {
+    I2C_ASYNC_TRANSMIT,
+    I2C_ASYNC_RECEIVE,
+    I2C_ASYNC_WRITE_REG,
+    I2C_ASYNC_READ_REG,
+} i2c_async_operation_t;
+
+typedef void (*i2c_async_callback_t)(i2c_status_t status, void *context);
+
+typedef struct {
+    i2c_async_operation_t operation;
+    uint8_t               address;  // already shifted, as for i2c_master
+    uint8_t               reg;      // only used by I2C_ASYNC_WRITE_REG and I2C_ASYNC_READ_REG
+    uint8_t *             data;
+    uint16_t              length;
+    uint16_t              timeout;
+    i2c_async_callback_t  callback;
+    void *                context;
+} i2c_async_request_t;
+
+// Identifies a queued transaction, negative if it couldn't be queued
+typedef int8_t i2c_async_handle_t;
+
+#define I2C_ASYNC_INVALID_HANDLE (-1)
+
+i2c_async_handle_t i2c_async_submit(const i2c_async_request_t *request);
+i2c_async_handle_t i2c_async_transmit(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context);
+i2c_async_handle_t i2c_async_receive(uint8_t address, uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context);
+i2c_async_handle_t i2c_async_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context);
+i2c_async_handle_t i2c_async_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void *context);
+
+// Transactions for devices with a higher priority are started first. Devices default to 0.
+void i2c_async_set_priority(uint8_t address, uint8_t priority);
+
+// Blocks until the transaction has completed, releases it and returns its
+// status. Transactions without a callback have to be waited for, the others
+// are released once their callback has been called.
+i2c_status_t i2c_async_wait(i2c_async_handle_t handle);
+
+// Queues a transaction and waits for it, as the blocking I2C functions do
+i2c_status_t i2c_async_transfer(const i2c_async_request_t *request);
+
+bool i2c_async_busy(void);
+void i2c_async_flush(void);
+void i2c_async_task(void);
+
+/*
+ * Backend interface, implemented by the platform's I2C driver.
+ *
+ * The backend is kicked whenever a transaction is queued. It then takes
+ * transactions with i2c_async_next() and reports their outcome with
+ * i2c_async_complete(), until there are none left.
+ */
+
+void i2c_async_backend_init(void);
+void i2c_async_backend_kick(void);
+void i2c_async_backend_lock(void);
+void i2c_async_backend_unlock(void);
+// Called while a transaction is queued or in progress, returns once a
+// transaction has completed since the previous call
+void i2c_async_backend_wait(void);
+
+const i2c_async_request_t *i2c_async_next(void);
+void                       i2c_async_complete(i2c_status_t status);
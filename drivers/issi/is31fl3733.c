@@ -68,6 +68,12 @@ uint8_t g_twi_transfer_buffer[20];
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
 bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
 
+// The PWM buffer is tracked in chunks of 16 bytes, one bit per chunk, so that
+// only the parts that actually changed are sent to the device.
+#define ISSI_PWM_CHUNK_SIZE 16
+#define ISSI_PWM_CHUNK_COUNT (192 / ISSI_PWM_CHUNK_SIZE)
+static uint16_t g_pwm_buffer_dirty_chunks[DRIVER_COUNT] = {0};
+
 uint8_t g_led_control_registers[DRIVER_COUNT][24]             = {{0}, {0}};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
 
@@ -121,6 +127,60 @@ bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     return true;
 }
 
+static bool IS31FL3733_write_pwm_run(uint8_t addr, uint8_t reg, const uint8_t *data, uint8_t length) {
+    // Device will auto-increment register for data after the first byte
+#if ISSI_PERSISTENCE > 0
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_writeReg(addr << 1, reg, data, length, ISSI_TIMEOUT) != 0) {
+            return false;
+        }
+    }
+#else
+    if (i2c_writeReg(addr << 1, reg, data, length, ISSI_TIMEOUT) != 0) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+// Sends the dirty chunks of the PWM buffer, with adjacent ones merged into a
+// single transfer. Returns the number of bytes sent, chunks that failed to
+// send are left dirty.
+static uint16_t IS31FL3733_write_dirty_pwm_chunks(uint8_t addr, uint8_t index) {
+    // Assumes PG1 is already selected.
+    uint16_t sent  = 0;
+    uint8_t  chunk = 0;
+    while (chunk < ISSI_PWM_CHUNK_COUNT) {
+        if (!(g_pwm_buffer_dirty_chunks[index] & (1 << chunk))) {
+            chunk++;
+            continue;
+        }
+
+        uint8_t first = chunk;
+        while (chunk < ISSI_PWM_CHUNK_COUNT && (g_pwm_buffer_dirty_chunks[index] & (1 << chunk))) {
+            chunk++;
+        }
+
+        uint8_t start  = first * ISSI_PWM_CHUNK_SIZE;
+        uint8_t length = (chunk - first) * ISSI_PWM_CHUNK_SIZE;
+        if (!IS31FL3733_write_pwm_run(addr, start, &g_pwm_buffer[index][start], length)) {
+            // Leave the remaining chunks dirty, so they are retried on the next update
+            return sent;
+        }
+        g_pwm_buffer_dirty_chunks[index] &= ~(((1 << (chunk - first)) - 1) << first);
+        sent += 1 + length;
+    }
+    return sent;
+}
+
+static inline void IS31FL3733_set_pwm(uint8_t index, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[index][reg] != value) {
+        g_pwm_buffer[index][reg] = value;
+        g_pwm_buffer_dirty_chunks[index] |= 1 << (reg / ISSI_PWM_CHUNK_SIZE);
+        g_pwm_buffer_update_required[index] = true;
+    }
+}
+
 void IS31FL3733_init(uint8_t addr, uint8_t sync) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -148,6 +208,11 @@ void IS31FL3733_init(uint8_t addr, uint8_t sync) {
     for (int i = 0x00; i <= 0xBF; i++) {
         IS31FL3733_write_register(addr, i, 0x00);
     }
+    // The PWM buffer no longer matches the device, send all of it on the next update.
+    for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+        g_pwm_buffer_dirty_chunks[i]    = (1 << ISSI_PWM_CHUNK_COUNT) - 1;
+        g_pwm_buffer_update_required[i] = true;
+    }
 
     // Unlock the command register.
     IS31FL3733_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
@@ -167,10 +232,9 @@ void IS31FL3733_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3733_set_pwm(led.driver, led.r, red);
+        IS31FL3733_set_pwm(led.driver, led.g, green);
+        IS31FL3733_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -209,7 +273,8 @@ void IS31FL3733_set_led_control_register(uint8_t index, bool red, bool green, bo
     g_led_control_registers_update_required[led.driver] = true;
 }
 
-void IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index) {
+uint16_t IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index) {
+    uint16_t sent = 0;
     if (g_pwm_buffer_update_required[index]) {
         // Firstly we need to unlock the command register and select PG1.
         IS31FL3733_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
@@ -217,11 +282,13 @@ void IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index) {
 
         // If any of the transactions fail we risk writing dirty PG0,
         // refresh page 0 just in case.
-        if (!IS31FL3733_write_pwm_buffer(addr, g_pwm_buffer[index])) {
+        sent = IS31FL3733_write_dirty_pwm_chunks(addr, index);
+        if (g_pwm_buffer_dirty_chunks[index] != 0) {
             g_led_control_registers_update_required[index] = true;
         }
     }
-    g_pwm_buffer_update_required[index] = false;
+    g_pwm_buffer_update_required[index] = g_pwm_buffer_dirty_chunks[index] != 0;
+    return sent;
 }
 
 void IS31FL3733_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -68,6 +68,12 @@ uint8_t g_twi_transfer_buffer[20];
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
 bool    g_pwm_buffer_update_required = false;
 
+// The PWM buffer is tracked in chunks of 16 bytes, one bit per chunk, so that
+// only the parts that actually changed are sent to the device.
+#define ISSI_PWM_CHUNK_SIZE 16
+#define ISSI_PWM_CHUNK_COUNT (192 / ISSI_PWM_CHUNK_SIZE)
+static uint16_t g_pwm_buffer_dirty_chunks[DRIVER_COUNT] = {0};
+
 uint8_t g_led_control_registers[DRIVER_COUNT][24] = {{0}};
 bool    g_led_control_registers_update_required   = false;
 
@@ -110,6 +116,56 @@ void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     }
 }
 
+static bool IS31FL3737_write_pwm_run(uint8_t addr, uint8_t reg, const uint8_t *data, uint8_t length) {
+    // device will auto-increment register for data after the first byte
+#if ISSI_PERSISTENCE > 0
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_writeReg(addr << 1, reg, data, length, ISSI_TIMEOUT) == 0) return true;
+    }
+    return false;
+#else
+    return i2c_writeReg(addr << 1, reg, data, length, ISSI_TIMEOUT) == 0;
+#endif
+}
+
+// sends the dirty chunks of the PWM buffer, with adjacent ones merged into a
+// single transfer, and returns the number of bytes sent. Chunks that failed to
+// send are left dirty.
+static uint16_t IS31FL3737_write_dirty_pwm_chunks(uint8_t addr, uint8_t index) {
+    // assumes PG1 is already selected
+    uint16_t sent  = 0;
+    uint8_t  chunk = 0;
+    while (chunk < ISSI_PWM_CHUNK_COUNT) {
+        if (!(g_pwm_buffer_dirty_chunks[index] & (1 << chunk))) {
+            chunk++;
+            continue;
+        }
+
+        uint8_t first = chunk;
+        while (chunk < ISSI_PWM_CHUNK_COUNT && (g_pwm_buffer_dirty_chunks[index] & (1 << chunk))) {
+            chunk++;
+        }
+
+        uint8_t start  = first * ISSI_PWM_CHUNK_SIZE;
+        uint8_t length = (chunk - first) * ISSI_PWM_CHUNK_SIZE;
+        if (!IS31FL3737_write_pwm_run(addr, start, &g_pwm_buffer[index][start], length)) {
+            // leave the remaining chunks dirty, so they are retried on the next update
+            return sent;
+        }
+        g_pwm_buffer_dirty_chunks[index] &= ~(((1 << (chunk - first)) - 1) << first);
+        sent += 1 + length;
+    }
+    return sent;
+}
+
+static inline void IS31FL3737_set_pwm(uint8_t index, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[index][reg] != value) {
+        g_pwm_buffer[index][reg] = value;
+        g_pwm_buffer_dirty_chunks[index] |= 1 << (reg / ISSI_PWM_CHUNK_SIZE);
+        g_pwm_buffer_update_required = true;
+    }
+}
+
 void IS31FL3737_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -136,6 +192,11 @@ void IS31FL3737_init(uint8_t addr) {
     for (int i = 0x00; i <= 0xBF; i++) {
         IS31FL3737_write_register(addr, i, 0x00);
     }
+    // the PWM buffer no longer matches the device, send all of it on the next update
+    for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+        g_pwm_buffer_dirty_chunks[i] = (1 << ISSI_PWM_CHUNK_COUNT) - 1;
+    }
+    g_pwm_buffer_update_required = true;
 
     // Unlock the command register.
     IS31FL3737_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
@@ -155,10 +216,9 @@ void IS31FL3737_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3737_set_pwm(led.driver, led.r, red);
+        IS31FL3737_set_pwm(led.driver, led.g, green);
+        IS31FL3737_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -197,16 +257,18 @@ void IS31FL3737_set_led_control_register(uint8_t index, bool red, bool green, bo
     g_led_control_registers_update_required = true;
 }
 
-void IS31FL3737_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
+uint16_t IS31FL3737_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
+    uint16_t sent = 0;
     if (g_pwm_buffer_update_required) {
         // Firstly we need to unlock the command register and select PG1
         IS31FL3737_write_register(addr1, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3737_write_register(addr1, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        IS31FL3737_write_pwm_buffer(addr1, g_pwm_buffer[0]);
-        // IS31FL3737_write_pwm_buffer(addr2, g_pwm_buffer[1]);
+        sent = IS31FL3737_write_dirty_pwm_chunks(addr1, 0);
+        // sent += IS31FL3737_write_dirty_pwm_chunks(addr2, 1);
     }
-    g_pwm_buffer_update_required = false;
+    g_pwm_buffer_update_required = g_pwm_buffer_dirty_chunks[0] != 0;
+    return sent;
 }
 
 void IS31FL3737_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
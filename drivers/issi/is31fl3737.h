@@ -42,8 +42,9 @@ void IS31FL3737_set_led_control_register(uint8_t index, bool red, bool green, bo
 // This should not be called from an interrupt
 // (eg. from a timer interrupt).
 // Call this while idle (in between matrix scans).
-// If the buffer is dirty, it will update the driver with the buffer.
-void IS31FL3737_update_pwm_buffers(uint8_t addr1, uint8_t addr2);
+// If the buffer is dirty, it will update the driver with the parts of the
+// buffer that changed, and return the number of bytes sent.
+uint16_t IS31FL3737_update_pwm_buffers(uint8_t addr1, uint8_t addr2);
 void IS31FL3737_update_led_control_registers(uint8_t addr1, uint8_t addr2);
 
 #define A_1 0x00
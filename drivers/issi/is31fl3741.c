@@ -76,6 +76,14 @@ uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
 bool    g_pwm_buffer_update_required                      = false;
 bool    g_scaling_registers_update_required[DRIVER_COUNT] = {false};
 
+// The PWM buffer is tracked in chunks of 18 bytes, one bit per chunk, so that
+// only the parts that actually changed are sent to the device. The first 10
+// chunks are on PG0, the remaining ones on PG1.
+#define ISSI_PWM_CHUNK_SIZE 18
+#define ISSI_PWM_CHUNK_COUNT ((ISSI_MAX_LEDS + ISSI_PWM_CHUNK_SIZE - 1) / ISSI_PWM_CHUNK_SIZE)
+#define ISSI_PWM_PAGE0_SIZE 180
+static uint32_t g_pwm_buffer_dirty_chunks[DRIVER_COUNT] = {0};
+
 uint8_t g_scaling_registers[DRIVER_COUNT][ISSI_MAX_LEDS];
 
 void IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
@@ -138,6 +146,70 @@ bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     return true;
 }
 
+static bool IS31FL3741_write_pwm_run(uint8_t addr, uint8_t reg, const uint8_t *data, uint16_t length) {
+    // device will auto-increment register for data after the first byte
+#if ISSI_PERSISTENCE > 0
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_writeReg(addr << 1, reg, data, length, ISSI_TIMEOUT) != 0) {
+            return false;
+        }
+    }
+#else
+    if (i2c_writeReg(addr << 1, reg, data, length, ISSI_TIMEOUT) != 0) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+// sends the dirty chunks of the PWM buffer, with adjacent ones on the same
+// page merged into a single transfer, and returns the number of bytes sent
+static uint16_t IS31FL3741_write_dirty_pwm_chunks(uint8_t addr, uint8_t index) {
+    uint16_t sent  = 0;
+    uint8_t  page  = 0xFF;
+    uint8_t  chunk = 0;
+    while (chunk < ISSI_PWM_CHUNK_COUNT) {
+        if (!(g_pwm_buffer_dirty_chunks[index] & (1UL << chunk))) {
+            chunk++;
+            continue;
+        }
+
+        uint8_t first = chunk;
+        uint8_t run_page = first * ISSI_PWM_CHUNK_SIZE >= ISSI_PWM_PAGE0_SIZE;
+        while (chunk < ISSI_PWM_CHUNK_COUNT && (g_pwm_buffer_dirty_chunks[index] & (1UL << chunk)) && (chunk * ISSI_PWM_CHUNK_SIZE >= ISSI_PWM_PAGE0_SIZE) == run_page) {
+            chunk++;
+        }
+
+        if (page != run_page) {
+            // unlock the command register and select PG0 or PG1
+            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
+            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, run_page ? ISSI_PAGE_PWM1 : ISSI_PAGE_PWM0);
+            page = run_page;
+        }
+
+        uint16_t start = first * ISSI_PWM_CHUNK_SIZE;
+        uint16_t end   = chunk * ISSI_PWM_CHUNK_SIZE;
+        if (end > ISSI_MAX_LEDS) {
+            end = ISSI_MAX_LEDS;
+        }
+        if (!IS31FL3741_write_pwm_run(addr, start % ISSI_PWM_PAGE0_SIZE, &g_pwm_buffer[index][start], end - start)) {
+            // leave the remaining chunks dirty, so they are retried on the next update
+            return sent;
+        }
+        g_pwm_buffer_dirty_chunks[index] &= ~(((1UL << (chunk - first)) - 1) << first);
+        sent += 1 + end - start;
+    }
+    return sent;
+}
+
+static inline void IS31FL3741_set_pwm(uint8_t index, uint16_t reg, uint8_t value) {
+    if (g_pwm_buffer[index][reg] != value) {
+        g_pwm_buffer[index][reg] = value;
+        g_pwm_buffer_dirty_chunks[index] |= 1UL << (reg / ISSI_PWM_CHUNK_SIZE);
+        g_pwm_buffer_update_required = true;
+    }
+}
+
 void IS31FL3741_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -161,6 +233,12 @@ void IS31FL3741_init(uint8_t addr) {
 
     // IS31FL3741_update_led_scaling_registers(addr, 0xFF, 0xFF, 0xFF);
 
+    // the device's PWM registers are not known to match the buffer, send all of it on the next update
+    for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+        g_pwm_buffer_dirty_chunks[i] = (1UL << ISSI_PWM_CHUNK_COUNT) - 1;
+    }
+    g_pwm_buffer_update_required = true;
+
     // Wait 10ms to ensure the device has woken up.
     wait_ms(10);
 }
@@ -169,10 +247,9 @@ void IS31FL3741_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3741_set_pwm(led.driver, led.r, red);
+        IS31FL3741_set_pwm(led.driver, led.g, green);
+        IS31FL3741_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -206,20 +283,20 @@ void IS31FL3741_set_led_control_register(uint8_t index, bool red, bool green, bo
     g_scaling_registers_update_required[led.driver] = true;
 }
 
-void IS31FL3741_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
+uint16_t IS31FL3741_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
+    uint16_t sent = 0;
     if (g_pwm_buffer_update_required) {
-        IS31FL3741_write_pwm_buffer(addr1, g_pwm_buffer[0]);
+        sent = IS31FL3741_write_dirty_pwm_chunks(addr1, 0);
     }
 
-    g_pwm_buffer_update_required = false;
+    g_pwm_buffer_update_required = g_pwm_buffer_dirty_chunks[0] != 0;
+    return sent;
 }
 
 void IS31FL3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue) {
-    g_pwm_buffer[pled->driver][pled->r] = red;
-    g_pwm_buffer[pled->driver][pled->g] = green;
-    g_pwm_buffer[pled->driver][pled->b] = blue;
-
-    g_pwm_buffer_update_required = true;
+    IS31FL3741_set_pwm(pled->driver, pled->r, red);
+    IS31FL3741_set_pwm(pled->driver, pled->g, green);
+    IS31FL3741_set_pwm(pled->driver, pled->b, blue);
 }
 
 void IS31FL3741_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -43,8 +43,9 @@ void IS31FL3741_set_led_control_register(uint8_t index, bool red, bool green, bo
 // This should not be called from an interrupt
 // (eg. from a timer interrupt).
 // Call this while idle (in between matrix scans).
-// If the buffer is dirty, it will update the driver with the buffer.
-void IS31FL3741_update_pwm_buffers(uint8_t addr1, uint8_t addr2);
+// If the buffer is dirty, it will update the driver with the parts of the
+// buffer that changed, and return the number of bytes sent.
+uint16_t IS31FL3741_update_pwm_buffers(uint8_t addr1, uint8_t addr2);
 void IS31FL3741_update_led_control_registers(uint8_t addr1, uint8_t addr2);
 void IS31FL3741_set_scaling_registers(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue);
 
@@ -15,6 +15,9 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "i2c_master.h"
+#ifdef I2C_ASYNC_ENABLE
+#    include "i2c_async.h"
+#endif
 #include "oled_driver.h"
 #include OLED_FONT_H
 #include "timer.h"
@@ -95,6 +98,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define I2C_TRANSMIT(data) i2c_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
 #define I2C_WRITE_REG(mode, data, size) i2c_writeReg((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT)
 
+#ifdef I2C_ASYNC_ENABLE
+#    define I2C_ASYNC_TRANSMIT(data, context) i2c_async_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT, oled_render_complete, context)
+#    define I2C_ASYNC_WRITE_REG(mode, data, size, context) i2c_async_writeReg((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT, oled_render_complete, context)
+#endif
+
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 
 // Display buffer's is the same as the OLED memory layout
@@ -123,6 +131,19 @@ uint32_t oled_scroll_timeout;
 #if OLED_UPDATE_INTERVAL > 0
 uint16_t oled_update_timeout;
 #endif
+#ifdef I2C_ASYNC_ENABLE
+// Queued render transactions that haven't completed yet
+uint8_t oled_render_pending = 0;
+
+// Called from i2c_async_task() for each transaction of a rendered block
+static void oled_render_complete(i2c_status_t status, void *context) {
+    oled_render_pending--;
+    if (status != I2C_STATUS_SUCCESS) {
+        print("oled_render failed\n");
+        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (uintptr_t)context);
+    }
+}
+#endif
 
 // Internal variables to reduce math instructions
 
@@ -288,6 +309,13 @@ void oled_render(void) {
         ++update_start;
     }
 
+#ifdef I2C_ASYNC_ENABLE
+    // The previous block is still being sent from the buffers below
+    if (oled_render_pending) {
+        return;
+    }
+#endif
+
     // Set column & page position
     static uint8_t display_start[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
@@ -296,18 +324,34 @@ void oled_render(void) {
         calc_bounds_90(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
     }
 
+#ifdef I2C_ASYNC_ENABLE
+    // Queue the block and carry on, the callback marks it dirty again if it failed
+    void *context = (void *)(uintptr_t)update_start;
+    if (I2C_ASYNC_TRANSMIT(display_start, context) == I2C_ASYNC_INVALID_HANDLE) {
+        return;
+    }
+    oled_render_pending++;
+#else
     // Send column & page position
     if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
         print("oled_render offset command failed\n");
         return;
     }
+#endif
 
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
         // Send render data chunk as is
+#ifdef I2C_ASYNC_ENABLE
+        if (I2C_ASYNC_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE, context) == I2C_ASYNC_INVALID_HANDLE) {
+            return;
+        }
+        oled_render_pending++;
+#else
         if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
             print("oled_render data failed\n");
             return;
         }
+#endif
     } else {
         // Rotate the render chunks
         const static uint8_t source_map[] = OLED_SOURCE_MAP;
@@ -320,10 +364,17 @@ void oled_render(void) {
         }
 
         // Send render data chunk after rotating
+#ifdef I2C_ASYNC_ENABLE
+        if (I2C_ASYNC_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE, context) == I2C_ASYNC_INVALID_HANDLE) {
+            return;
+        }
+        oled_render_pending++;
+#else
         if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
             print("oled_render90 data failed\n");
             return;
         }
+#endif
     }
 
     // Turn on display if it is off
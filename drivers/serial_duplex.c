@@ -0,0 +1,193 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "serial_duplex.h"
+#include "serial_link/protocol/byte_stuffer.h"
+#include "serial_link/protocol/frame_validator.h"
+#include "serial_link/protocol/physical.h"
+#include "split_crc.h"
+#include "timer.h"
+
+#if (SERIAL_DUPLEX_TX_BUFFER_SIZE & (SERIAL_DUPLEX_TX_BUFFER_SIZE - 1)) || (SERIAL_DUPLEX_RX_BUFFER_SIZE & (SERIAL_DUPLEX_RX_BUFFER_SIZE - 1))
+#    error "SERIAL_DUPLEX_TX_BUFFER_SIZE and SERIAL_DUPLEX_RX_BUFFER_SIZE must be powers of two."
+#endif
+
+#define LINK 0
+
+// A frame is the transaction id, its data and a checksum
+#define FRAME_SIZE(size) ((size) + 2)
+// Byte stuffing adds a byte for every 254, and the delimiters on both ends
+#define STUFFED_SIZE(size) (FRAME_SIZE(size) + FRAME_SIZE(size) / 254 + 3)
+
+static SSTD_t *transactions      = NULL;
+static uint8_t transaction_count = 0;
+static bool    is_master;
+
+static uint8_t           tx_buffer[SERIAL_DUPLEX_TX_BUFFER_SIZE];
+static volatile uint16_t tx_head = 0;
+static volatile uint16_t tx_tail = 0;
+
+static uint8_t           rx_buffer[SERIAL_DUPLEX_RX_BUFFER_SIZE];
+static volatile uint16_t rx_head = 0;
+static volatile uint16_t rx_tail = 0;
+
+// When the slave last answered each transaction, on the master
+static bool     answered[SERIAL_DUPLEX_MAX_TRANSACTIONS];
+static uint16_t answer_time[SERIAL_DUPLEX_MAX_TRANSACTIONS];
+// Whether a request of each transaction is waiting for its answer, and since when
+static bool     in_flight[SERIAL_DUPLEX_MAX_TRANSACTIONS];
+static uint16_t request_time[SERIAL_DUPLEX_MAX_TRANSACTIONS];
+
+void send_data(uint8_t link, const uint8_t *data, uint16_t size) {
+    // There is always room, as it's checked for the whole frame up front
+    while (size--) {
+        tx_buffer[tx_head % SERIAL_DUPLEX_TX_BUFFER_SIZE] = *data++;
+        tx_head++;
+    }
+}
+
+static bool serial_duplex_send(uint8_t index, const uint8_t *data, uint8_t size) {
+    static uint8_t       frame[FRAME_SIZE(255)];
+    static const uint8_t delimiter = 0;
+
+    if (FRAME_SIZE(size) > MAX_FRAME_SIZE || SERIAL_DUPLEX_TX_BUFFER_SIZE - (uint16_t)(tx_head - tx_tail) < STUFFED_SIZE(size)) {
+        return false;
+    }
+
+    frame[0] = index;
+    memcpy(&frame[1], data, size);
+    frame[size + 1] = split_crc8(0xFF, frame, size + 1);
+    // Leading delimiter, so that line noise left over on the other end can't run into the frame
+    send_data(LINK, &delimiter, 1);
+    byte_stuffer_send_frame(LINK, frame, FRAME_SIZE(size));
+    serial_duplex_backend_kick();
+    return true;
+}
+
+uint16_t serial_duplex_tx_next(const uint8_t **data) {
+    uint16_t start  = tx_tail % SERIAL_DUPLEX_TX_BUFFER_SIZE;
+    uint16_t length = tx_head - tx_tail;
+    if (length > SERIAL_DUPLEX_TX_BUFFER_SIZE - start) {
+        length = SERIAL_DUPLEX_TX_BUFFER_SIZE - start;
+    }
+    *data = &tx_buffer[start];
+    return length;
+}
+
+void serial_duplex_tx_done(uint16_t length) { tx_tail += length; }
+
+void serial_duplex_receive(uint8_t data) {
+    // When full, the byte is dropped, and the frame it was part of fails its checksum
+    if ((uint16_t)(rx_head - rx_tail) < SERIAL_DUPLEX_RX_BUFFER_SIZE) {
+        rx_buffer[rx_head % SERIAL_DUPLEX_RX_BUFFER_SIZE] = data;
+        rx_head++;
+    }
+}
+
+// Called by the byte stuffer for every complete frame
+void validator_recv_frame(uint8_t link, uint8_t *data, uint16_t size) {
+    if (size < FRAME_SIZE(0) || split_crc8(0xFF, data, size - 1) != data[size - 1] || data[0] >= transaction_count) {
+        return;
+    }
+
+    uint8_t index = data[0];
+    SSTD_t *trans = &transactions[index];
+    size -= FRAME_SIZE(0);
+    if (is_master) {
+        if (size == trans->target2initiator_buffer_size) {
+            memcpy(trans->target2initiator_buffer, &data[1], size);
+            answered[index]    = true;
+            answer_time[index] = timer_read();
+            in_flight[index]   = false;
+        }
+    } else {
+        if (size == trans->initiator2target_buffer_size) {
+            memcpy(trans->initiator2target_buffer, &data[1], size);
+            if (trans->status) {
+                *trans->status = TRANSACTION_ACCEPTED;
+            }
+            serial_duplex_send(index, trans->target2initiator_buffer, trans->target2initiator_buffer_size);
+        }
+    }
+}
+
+void serial_duplex_task(void) {
+    while (rx_tail != rx_head) {
+        byte_stuffer_recv_byte(LINK, rx_buffer[rx_tail % SERIAL_DUPLEX_RX_BUFFER_SIZE]);
+        rx_tail++;
+    }
+}
+
+static void serial_duplex_init(SSTD_t *sstd_table, int sstd_table_size, bool master) {
+    transactions      = sstd_table;
+    transaction_count = sstd_table_size < SERIAL_DUPLEX_MAX_TRANSACTIONS ? sstd_table_size : SERIAL_DUPLEX_MAX_TRANSACTIONS;
+    is_master         = master;
+    tx_head = tx_tail = 0;
+    rx_head = rx_tail = 0;
+    memset(answered, 0, sizeof(answered));
+    memset(in_flight, 0, sizeof(in_flight));
+    init_byte_stuffer();
+    serial_duplex_backend_init(master);
+}
+
+void soft_serial_initiator_init(SSTD_t *sstd_table, int sstd_table_size) { serial_duplex_init(sstd_table, sstd_table_size, true); }
+
+void soft_serial_target_init(SSTD_t *sstd_table, int sstd_table_size) { serial_duplex_init(sstd_table, sstd_table_size, false); }
+
+/////////
+//  start transaction by initiator
+//
+// int  soft_serial_transaction(int sstd_index)
+//
+// Sends the request, and returns straight away with the latest answer.
+// While a request is waiting for its answer, no other one is sent for the
+// same transaction, unless it has timed out.
+//
+// Returns:
+//    TRANSACTION_END
+//    TRANSACTION_NO_RESPONSE
+//    TRANSACTION_TYPE_ERROR
+#ifndef SERIAL_USE_MULTI_TRANSACTION
+int soft_serial_transaction(void) {
+    uint8_t sstd_index = 0;
+#else
+int soft_serial_transaction(int index) {
+    uint8_t sstd_index = index;
+#endif
+
+    if (sstd_index >= transaction_count) return TRANSACTION_TYPE_ERROR;
+    SSTD_t *trans = &transactions[sstd_index];
+
+    // Take in the answers that have arrived since the last scan
+    serial_duplex_task();
+
+    // Scanning faster than the link can carry would otherwise fill the buffer with stale requests
+    if (!in_flight[sstd_index] || timer_elapsed(request_time[sstd_index]) > SERIAL_DUPLEX_TIMEOUT) {
+        if (serial_duplex_send(sstd_index, trans->initiator2target_buffer, trans->initiator2target_buffer_size)) {
+            in_flight[sstd_index]    = true;
+            request_time[sstd_index] = timer_read();
+        } else if (FRAME_SIZE(trans->initiator2target_buffer_size) > MAX_FRAME_SIZE) {
+            return TRANSACTION_TYPE_ERROR;
+        }
+    }
+
+    if (!answered[sstd_index] || timer_elapsed(answer_time[sstd_index]) > SERIAL_DUPLEX_TIMEOUT) {
+        return TRANSACTION_NO_RESPONSE;
+    }
+    return TRANSACTION_END;
+}
@@ -0,0 +1,73 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "serial.h"
+
+/*
+ * Full-duplex, pipelined split transport.
+ *
+ * Implements the serial.h transactions over a link that carries data both ways
+ * at once. Each transaction is sent as a frame, byte stuffed with the
+ * serial_link byte stuffer and checksummed, and the slave answers it with a
+ * frame holding its side of the transaction. The master never waits for the
+ * wire: a transaction returns straight away, with the latest answer the slave
+ * has sent for it, which is usually the answer to the previous scan's request.
+ *
+ * Both directions go through ring buffers, which the platform's backend drains
+ * and fills, typically with DMA.
+ */
+
+#ifndef SERIAL_DUPLEX_TX_BUFFER_SIZE
+#    define SERIAL_DUPLEX_TX_BUFFER_SIZE 256
+#endif
+
+#ifndef SERIAL_DUPLEX_RX_BUFFER_SIZE
+#    define SERIAL_DUPLEX_RX_BUFFER_SIZE 256
+#endif
+
+// Time without an answer from the slave before its transactions fail, in milliseconds
+#ifndef SERIAL_DUPLEX_TIMEOUT
+#    define SERIAL_DUPLEX_TIMEOUT 100
+#endif
+
+#ifndef SERIAL_DUPLEX_MAX_TRANSACTIONS
+#    define SERIAL_DUPLEX_MAX_TRANSACTIONS 8
+#endif
+
+// Called by the backend for every byte received, possibly from an interrupt
+void serial_duplex_receive(uint8_t data);
+// Decodes what has been received, and answers the master's frames on the slave
+void serial_duplex_task(void);
+
+/*
+ * Backend interface, implemented by the platform's serial driver.
+ *
+ * The backend is kicked whenever a frame has been queued. It then takes
+ * contiguous blocks with serial_duplex_tx_next(), and hands them back with
+ * serial_duplex_tx_done() once they have been sent, until there are none left.
+ * On the slave, it calls serial_duplex_task() once bytes have been received.
+ */
+
+void serial_duplex_backend_init(bool master);
+void serial_duplex_backend_kick(void);
+
+// Returns the size of the next block to send, 0 if there is none
+uint16_t serial_duplex_tx_next(const uint8_t **data);
+void     serial_duplex_tx_done(uint16_t length);
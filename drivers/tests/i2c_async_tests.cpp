@@ -0,0 +1,184 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "i2c_async.h"
+#include "i2c_master.h"
+}
+
+#define OLED_ADDRESS (0x3C << 1)
+#define LED_ADDRESS (0x50 << 1)
+#define MISSING_ADDRESS (0x20 << 1)
+
+struct Completion {
+    std::vector<int>          order;
+    std::vector<i2c_status_t> status;
+};
+
+static Completion completions;
+
+static void record_completion(i2c_status_t status, void *context) {
+    completions.order.push_back((int)(intptr_t)context);
+    completions.status.push_back(status);
+}
+
+class I2cAsyncTest : public ::testing::Test {
+   protected:
+    uint8_t oled[256] = {0};
+    uint8_t leds[256] = {0};
+
+    void SetUp() override {
+        i2c_mock_bus_reset();
+        i2c_mock_bus_add_device(OLED_ADDRESS, oled, sizeof(oled));
+        i2c_mock_bus_add_device(LED_ADDRESS, leds, sizeof(leds));
+        i2c_async_set_priority(OLED_ADDRESS, 0);
+        i2c_async_set_priority(LED_ADDRESS, 0);
+        completions = Completion();
+    }
+};
+
+TEST_F(I2cAsyncTest, BlockingWrapperWritesAndReads) {
+    uint8_t data[] = {1, 2, 3};
+    EXPECT_EQ(i2c_writeReg(LED_ADDRESS, 0x10, data, sizeof(data), 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(leds[0x10], 1);
+    EXPECT_EQ(leds[0x12], 3);
+
+    uint8_t read[3] = {0};
+    EXPECT_EQ(i2c_readReg(LED_ADDRESS, 0x11, read, sizeof(read), 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(read[0], 2);
+    EXPECT_EQ(read[1], 3);
+    EXPECT_EQ(read[2], 0);
+
+    uint8_t command[] = {0x20, 0xAA, 0xBB};
+    EXPECT_EQ(i2c_transmit(OLED_ADDRESS, command, sizeof(command), 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(oled[0x20], 0xAA);
+    EXPECT_EQ(oled[0x21], 0xBB);
+    EXPECT_FALSE(i2c_async_busy());
+}
+
+TEST_F(I2cAsyncTest, BlockingWrapperReportsErrors) {
+    uint8_t data = 0;
+    EXPECT_EQ(i2c_transmit(MISSING_ADDRESS, &data, 1, 100), I2C_STATUS_ERROR);
+
+    i2c_mock_bus_fail_next(I2C_STATUS_TIMEOUT);
+    EXPECT_EQ(i2c_writeReg(LED_ADDRESS, 0, &data, 1, 100), I2C_STATUS_TIMEOUT);
+}
+
+TEST_F(I2cAsyncTest, SubmitDoesNotBlock) {
+    uint8_t data[] = {5, 6};
+    EXPECT_GE(i2c_async_writeReg(LED_ADDRESS, 0, data, sizeof(data), 100, record_completion, (void *)1), 0);
+    EXPECT_TRUE(i2c_async_busy());
+    EXPECT_EQ(leds[0], 0);
+    EXPECT_EQ(i2c_mock_bus_transfer_count(), 0);
+
+    EXPECT_TRUE(i2c_mock_bus_step());
+    EXPECT_FALSE(i2c_async_busy());
+    EXPECT_EQ(leds[0], 5);
+    EXPECT_EQ(leds[1], 6);
+}
+
+TEST_F(I2cAsyncTest, CallbacksRunFromTask) {
+    uint8_t data = 7;
+    i2c_async_transmit(MISSING_ADDRESS, &data, 1, 100, record_completion, (void *)1);
+    i2c_async_writeReg(LED_ADDRESS, 0, &data, 1, 100, record_completion, (void *)2);
+    i2c_mock_bus_run();
+    EXPECT_TRUE(completions.order.empty());
+
+    i2c_async_task();
+    ASSERT_EQ(completions.order.size(), 2u);
+    EXPECT_EQ(completions.order[0], 1);
+    EXPECT_EQ(completions.status[0], I2C_STATUS_ERROR);
+    EXPECT_EQ(completions.order[1], 2);
+    EXPECT_EQ(completions.status[1], I2C_STATUS_SUCCESS);
+
+    i2c_async_task();
+    EXPECT_EQ(completions.order.size(), 2u);
+}
+
+TEST_F(I2cAsyncTest, SamePriorityRunsInSubmissionOrder) {
+    uint8_t data = 0;
+    for (int i = 0; i < 6; i++) {
+        i2c_async_writeReg(i % 2 ? OLED_ADDRESS : LED_ADDRESS, i, &data, 1, 100, record_completion, (void *)(intptr_t)i);
+    }
+    i2c_mock_bus_run();
+    i2c_async_task();
+
+    ASSERT_EQ(i2c_mock_bus_transfer_count(), 6);
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(i2c_mock_bus_transfer(i)->address, i % 2 ? OLED_ADDRESS : LED_ADDRESS);
+    }
+}
+
+TEST_F(I2cAsyncTest, HigherPriorityDeviceGoesFirst) {
+    i2c_async_set_priority(LED_ADDRESS, 1);
+
+    uint8_t data = 0;
+    i2c_async_writeReg(OLED_ADDRESS, 0, &data, 1, 100, record_completion, (void *)1);
+    i2c_async_writeReg(OLED_ADDRESS, 1, &data, 1, 100, record_completion, (void *)2);
+    i2c_async_writeReg(LED_ADDRESS, 0, &data, 1, 100, record_completion, (void *)3);
+    i2c_mock_bus_run();
+
+    ASSERT_EQ(i2c_mock_bus_transfer_count(), 3);
+    EXPECT_EQ(i2c_mock_bus_transfer(0)->address, LED_ADDRESS);
+    EXPECT_EQ(i2c_mock_bus_transfer(1)->address, OLED_ADDRESS);
+    EXPECT_EQ(i2c_mock_bus_transfer(2)->address, OLED_ADDRESS);
+}
+
+TEST_F(I2cAsyncTest, WaitReleasesTransaction) {
+    uint8_t data = 9;
+    for (int round = 0; round < 2 * I2C_ASYNC_QUEUE_SIZE; round++) {
+        i2c_async_handle_t handle = i2c_async_writeReg(LED_ADDRESS, round, &data, 1, 100, NULL, NULL);
+        ASSERT_GE(handle, 0);
+        EXPECT_EQ(i2c_async_wait(handle), I2C_STATUS_SUCCESS);
+    }
+    EXPECT_EQ(leds[2 * I2C_ASYNC_QUEUE_SIZE - 1], 9);
+}
+
+TEST_F(I2cAsyncTest, FullQueueRejectsSubmission) {
+    uint8_t data = 0;
+    for (int i = 0; i < I2C_ASYNC_QUEUE_SIZE; i++) {
+        EXPECT_GE(i2c_async_writeReg(LED_ADDRESS, i, &data, 1, 100, record_completion, NULL), 0);
+    }
+    EXPECT_EQ(i2c_async_writeReg(LED_ADDRESS, 0, &data, 1, 100, record_completion, NULL), I2C_ASYNC_INVALID_HANDLE);
+
+    // A blocking call still gets through, once the queue has room again
+    EXPECT_EQ(i2c_writeReg(OLED_ADDRESS, 0, &data, 1, 100), I2C_STATUS_SUCCESS);
+    i2c_async_flush();
+    EXPECT_EQ(completions.order.size(), (size_t)I2C_ASYNC_QUEUE_SIZE);
+}
+
+TEST_F(I2cAsyncTest, CallbackCanQueueNextTransaction) {
+    static uint8_t chunks[2] = {0x11, 0x22};
+    static int     sent;
+    sent = 0;
+
+    i2c_async_callback_t next = [](i2c_status_t status, void *context) {
+        if (++sent < 2) {
+            i2c_async_writeReg(LED_ADDRESS, sent, &chunks[sent], 1, 100, (i2c_async_callback_t)context, context);
+        }
+    };
+    i2c_async_writeReg(LED_ADDRESS, 0, &chunks[0], 1, 100, next, (void *)next);
+    i2c_async_flush();
+    i2c_async_flush();
+
+    EXPECT_EQ(sent, 2);
+    EXPECT_EQ(leds[0], 0x11);
+    EXPECT_EQ(leds[1], 0x22);
+}
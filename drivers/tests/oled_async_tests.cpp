@@ -0,0 +1,92 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "i2c_async.h"
+#include "i2c_master.h"
+#include "oled_driver.h"
+
+extern OLED_BLOCK_TYPE oled_dirty;
+}
+
+#define DISPLAY_ADDRESS (OLED_DISPLAY_ADDRESS << 1)
+#define DATA_REGISTER 0x40
+
+class OledAsyncTest : public ::testing::Test {
+   protected:
+    uint8_t display[256] = {0};
+
+    void SetUp() override {
+        i2c_mock_bus_reset();
+        i2c_mock_bus_add_device(DISPLAY_ADDRESS, display, sizeof(display));
+        ASSERT_TRUE(oled_init(OLED_ROTATION_0));
+        render_all();
+        i2c_mock_bus_reset();
+        i2c_mock_bus_add_device(DISPLAY_ADDRESS, display, sizeof(display));
+    }
+
+    void render_all() {
+        while (oled_dirty) {
+            oled_render();
+            i2c_async_flush();
+        }
+    }
+};
+
+TEST_F(OledAsyncTest, RenderQueuesTheBlockWithoutWaiting) {
+    oled_write_raw_byte(0x5A, 0);
+    oled_render();
+
+    // Nothing has been sent yet, the bus only moves when it is stepped
+    EXPECT_EQ(i2c_mock_bus_transfer_count(), 0);
+    EXPECT_TRUE(i2c_async_busy());
+    EXPECT_EQ(oled_dirty, 0);
+
+    i2c_async_flush();
+    ASSERT_EQ(i2c_mock_bus_transfer_count(), 2);
+    EXPECT_EQ(i2c_mock_bus_transfer(0)->operation, I2C_ASYNC_TRANSMIT);
+    EXPECT_EQ(i2c_mock_bus_transfer(1)->operation, I2C_ASYNC_WRITE_REG);
+    EXPECT_EQ(i2c_mock_bus_transfer(1)->length, OLED_BLOCK_SIZE);
+    EXPECT_EQ(display[DATA_REGISTER], 0x5A);
+}
+
+TEST_F(OledAsyncTest, RenderWaitsForThePreviousBlock) {
+    oled_write_raw_byte(0x11, 0);
+    oled_write_raw_byte(0x22, OLED_BLOCK_SIZE);
+    oled_render();
+    oled_render();
+    EXPECT_EQ(oled_dirty, (OLED_BLOCK_TYPE)2);
+
+    i2c_async_flush();
+    oled_render();
+    i2c_async_flush();
+    EXPECT_EQ(oled_dirty, 0);
+    EXPECT_EQ(i2c_mock_bus_transfer_count(), 4);
+    EXPECT_EQ(display[DATA_REGISTER], 0x22);
+}
+
+TEST_F(OledAsyncTest, FailedBlockIsRenderedAgain) {
+    oled_write_raw_byte(0x33, 0);
+    oled_render();
+    i2c_mock_bus_fail_next(I2C_STATUS_TIMEOUT);
+    i2c_async_flush();
+    EXPECT_EQ(oled_dirty, (OLED_BLOCK_TYPE)1);
+
+    render_all();
+    EXPECT_EQ(display[DATA_REGISTER], 0x33);
+}
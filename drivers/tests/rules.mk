@@ -0,0 +1,26 @@
+i2c_async_INC := $(DRIVER_PATH) $(TMK_PATH)/common/test
+
+i2c_async_SRC := \
+	$(DRIVER_PATH)/tests/i2c_async_tests.cpp \
+	$(DRIVER_PATH)/i2c_async.c \
+	$(TMK_PATH)/common/test/i2c_master.c
+
+serial_duplex_DEFS := -DSERIAL_USE_MULTI_TRANSACTION -DMAX_FRAME_SIZE=257 -DNUM_LINKS=1
+serial_duplex_INC := $(DRIVER_PATH) $(DRIVER_PATH)/chibios $(QUANTUM_PATH) $(QUANTUM_PATH)/split_common $(TMK_PATH)/common
+
+serial_duplex_SRC := \
+	$(DRIVER_PATH)/tests/serial_duplex_tests.cpp \
+	$(DRIVER_PATH)/serial_duplex.c \
+	$(QUANTUM_PATH)/serial_link/protocol/byte_stuffer.c \
+	$(QUANTUM_PATH)/split_common/split_crc.c \
+	$(TMK_PATH)/common/test/timer.c
+
+oled_async_DEFS := -DI2C_ASYNC_ENABLE -DNO_PRINT -DOLED_TIMEOUT=0
+oled_async_INC := $(DRIVER_PATH) $(DRIVER_PATH)/oled $(TMK_PATH)/common/test $(TMK_PATH)/common
+
+oled_async_SRC := \
+	$(DRIVER_PATH)/tests/oled_async_tests.cpp \
+	$(DRIVER_PATH)/oled/oled_driver.c \
+	$(DRIVER_PATH)/i2c_async.c \
+	$(TMK_PATH)/common/test/i2c_master.c \
+	$(TMK_PATH)/common/test/timer.c
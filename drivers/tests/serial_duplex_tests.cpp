@@ -0,0 +1,275 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "serial_duplex.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+// Each half runs in its own process, and they talk to each other over a pseudo terminal
+static int  link_fd       = -1;
+static bool slave_garbles = false;
+// Stands for a wire slower than the scans, nothing is sent while it's set
+static bool wire_stalled = false;
+
+extern "C" {
+void serial_duplex_backend_init(bool master) {}
+
+void serial_duplex_backend_kick(void) {
+    if (wire_stalled) {
+        return;
+    }
+    const uint8_t *data;
+    uint16_t       length;
+    while ((length = serial_duplex_tx_next(&data)) > 0) {
+        ssize_t written = write(link_fd, data, length);
+        if (written <= 0) {
+            return;
+        }
+        serial_duplex_tx_done(written);
+    }
+}
+}
+
+// Feeds whatever has arrived within the timeout to the driver, returns false once the other end has gone
+static bool pump(int timeout) {
+    struct pollfd fd = {link_fd, POLLIN, 0};
+    if (poll(&fd, 1, timeout) <= 0) {
+        return true;
+    }
+    uint8_t buffer[64];
+    ssize_t length = read(link_fd, buffer, sizeof(buffer));
+    if (length <= 0) {
+        return false;
+    }
+    for (ssize_t i = 0; i < length; i++) {
+        serial_duplex_receive(buffer[i]);
+    }
+    return true;
+}
+
+struct Request {
+    uint8_t value;
+    uint8_t padding[3];
+};
+
+struct Answer {
+    uint8_t value;
+    uint8_t zeroes[5];
+};
+
+enum { EXCHANGE, PUT_LARGE, TRANSACTION_COUNT };
+
+static uint8_t volatile status_exchange = 0;
+static uint8_t volatile status_large    = 0;
+static Request request;
+static Answer  answer;
+static uint8_t large[200];
+
+static SSTD_t transactions[] = {
+    {(uint8_t *)&status_exchange, sizeof(request), (uint8_t *)&request, sizeof(answer), (uint8_t *)&answer},
+    {(uint8_t *)&status_large, sizeof(large), large, 0, NULL},
+};
+
+// Answers the master with the last value it sent plus one, and keeps a checksum of the large transfers
+static void slave_main() {
+    soft_serial_target_init(transactions, TRANSACTION_COUNT);
+    while (pump(1000)) {
+        serial_duplex_task();
+        if (status_exchange == TRANSACTION_ACCEPTED) {
+            status_exchange = TRANSACTION_END;
+            answer.value    = request.value + 1;
+            if (slave_garbles) {
+                uint8_t noise[] = {0x00, 0x05, 0xFF, 0x12, 0x00, 0x00, 0x03, 0x01};
+                write(link_fd, noise, sizeof(noise));
+            }
+        }
+        if (status_large == TRANSACTION_ACCEPTED) {
+            status_large = TRANSACTION_END;
+            uint8_t sum  = 0;
+            for (uint8_t byte : large) {
+                sum += byte;
+            }
+            answer.zeroes[0] = sum;
+        }
+    }
+    _exit(0);
+}
+
+class SerialDuplex : public testing::Test {
+   public:
+    pid_t slave = -1;
+
+    void SetUp() override {
+        memset(&request, 0, sizeof(request));
+        memset(&answer, 0, sizeof(answer));
+        slave_garbles = false;
+        wire_stalled  = false;
+        set_time(0);
+    }
+
+    void start_slave() {
+        int master_end, slave_end;
+        ASSERT_EQ(openpty(&master_end, &slave_end, NULL, NULL, NULL), 0);
+        struct termios raw;
+        tcgetattr(slave_end, &raw);
+        cfmakeraw(&raw);
+        tcsetattr(slave_end, TCSANOW, &raw);
+
+        slave = fork();
+        ASSERT_GE(slave, 0);
+        if (slave == 0) {
+            close(master_end);
+            link_fd = slave_end;
+            slave_main();
+        }
+        close(slave_end);
+        link_fd = master_end;
+        soft_serial_initiator_init(transactions, TRANSACTION_COUNT);
+    }
+
+    void stop_slave() {
+        if (link_fd >= 0) {
+            close(link_fd);
+            link_fd = -1;
+        }
+        if (slave > 0) {
+            kill(slave, SIGTERM);
+            waitpid(slave, NULL, 0);
+            slave = -1;
+        }
+    }
+
+    void TearDown() override { stop_slave(); }
+
+    // Runs scans of a millisecond until the slave's answer matches, returns the number of scans it took
+    int exchange_until(uint8_t expected, int limit = 1000) {
+        for (int scan = 1; scan <= limit; scan++) {
+            pump(1);
+            advance_time(1);
+            if (soft_serial_transaction(EXCHANGE) == TRANSACTION_END && answer.value == expected) {
+                return scan;
+            }
+        }
+        return -1;
+    }
+};
+
+TEST_F(SerialDuplex, ReturnsWithoutWaitingForTheSlave) {
+    start_slave();
+    // Nothing can have been answered yet, and the master doesn't wait for it
+    EXPECT_EQ(soft_serial_transaction(EXCHANGE), TRANSACTION_NO_RESPONSE);
+    EXPECT_GT(exchange_until(1), 1);
+}
+
+TEST_F(SerialDuplex, AnswersFollowTheMastersState) {
+    start_slave();
+    for (uint8_t value = 10; value < 20; value++) {
+        request.value = value;
+        EXPECT_GT(exchange_until(value + 1), 0) << "value " << (int)value;
+    }
+}
+
+TEST_F(SerialDuplex, CarriesTransactionsWithZeroesAndLargeBuffers) {
+    start_slave();
+    uint8_t sum = 0;
+    for (size_t i = 0; i < sizeof(large); i++) {
+        large[i] = i % 3 ? i : 0;
+        sum += large[i];
+    }
+    EXPECT_EQ(soft_serial_transaction(PUT_LARGE), TRANSACTION_NO_RESPONSE);
+
+    request.value = 1;
+    int scans     = 0;
+    while (scans++ < 1000 && !(soft_serial_transaction(EXCHANGE) == TRANSACTION_END && answer.value == 2 && answer.zeroes[0] == sum)) {
+        pump(1);
+    }
+    EXPECT_EQ(answer.zeroes[0], sum);
+}
+
+TEST_F(SerialDuplex, RecoversFromLineNoise) {
+    slave_garbles = true;
+    start_slave();
+    for (uint8_t value = 1; value < 10; value++) {
+        uint8_t noise[] = {0x00, 0x07, 0x01, 0xFF, 0x00, 0x42};
+        write(link_fd, noise, sizeof(noise));
+        request.value = value;
+        EXPECT_GT(exchange_until(value + 1), 0) << "value " << (int)value;
+    }
+}
+
+TEST_F(SerialDuplex, TimesOutOnceTheSlaveIsGone) {
+    start_slave();
+    ASSERT_GT(exchange_until(1), 0);
+
+    kill(slave, SIGTERM);
+    waitpid(slave, NULL, 0);
+    slave = -1;
+    EXPECT_EQ(soft_serial_transaction(EXCHANGE), TRANSACTION_END);
+    advance_time(SERIAL_DUPLEX_TIMEOUT + 1);
+    EXPECT_EQ(soft_serial_transaction(EXCHANGE), TRANSACTION_NO_RESPONSE);
+}
+
+TEST_F(SerialDuplex, KeepsOneRequestInFlightWhenScannedFasterThanTheWire) {
+    start_slave();
+    wire_stalled = true;
+    for (uint8_t value = 1; value <= 100; value++) {
+        request.value = value;
+        soft_serial_transaction(EXCHANGE);
+    }
+    // A single frame: the transaction id, the request and its checksum, stuffed and delimited on both ends
+    const uint8_t *data;
+    EXPECT_LE(serial_duplex_tx_next(&data), sizeof(request) + 5);
+
+    // Once the wire catches up, the latest request is answered after a round trip, not after a backlog
+    wire_stalled = false;
+    serial_duplex_backend_kick();
+    EXPECT_GT(exchange_until(101, 50), 0);
+}
+
+TEST_F(SerialDuplex, ResendsARequestThatTimedOut) {
+    start_slave();
+    wire_stalled = true;
+    request.value = 1;
+    soft_serial_transaction(EXCHANGE);
+    // The request was lost on the way
+    const uint8_t *data;
+    serial_duplex_tx_done(serial_duplex_tx_next(&data));
+    wire_stalled = false;
+
+    request.value = 2;
+    EXPECT_EQ(exchange_until(3, 50), -1);
+    advance_time(SERIAL_DUPLEX_TIMEOUT + 1);
+    EXPECT_GT(exchange_until(3, 50), 0);
+}
+
+TEST_F(SerialDuplex, RejectsUnknownTransactions) {
+    start_slave();
+    EXPECT_EQ(soft_serial_transaction(TRANSACTION_COUNT), TRANSACTION_TYPE_ERROR);
+}
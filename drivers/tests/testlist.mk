@@ -0,0 +1 @@
+TEST_LIST += i2c_async oled_async serial_duplex
@@ -38,3 +38,21 @@
  *         - Wait 50us to reset the LEDs
  */
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+/*
+ * Drivers that stream the frame out with DMA also offer a non-blocking
+ * interface. The frame is encoded into a second buffer while the previous one
+ * is still being sent, and goes out as soon as the bus is free. Only the most
+ * recent frame is kept if several are queued up while the bus is busy.
+ */
+#if defined(WS2812_DRIVER_SPI)
+#    define WS2812_ASYNC
+
+void ws2812_setleds_async(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+/* Returns true while a frame is still being sent out */
+bool ws2812_frame_in_flight(void);
+
+/* Called from interrupt context every time a frame has been sent out */
+void ws2812_frame_complete(void);
+#endif
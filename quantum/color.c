@@ -18,82 +18,60 @@
 #include "led_tables.h"
 #include "progmem.h"
 
-RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
-    RGB      rgb;
-    uint8_t  region, remainder, p, q, t;
-    uint16_t h, s, v;
+// Which of v, p, q and t ends up in r, g and b, for each of the 6 regions of
+// the hue circle (and 6 again for h = 255)
+enum { HSV_V, HSV_P, HSV_Q, HSV_T };
 
-    if (hsv.s == 0) {
-#ifdef USE_CIE1931_CURVE
-        if (use_cie) {
-            rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-        } else {
-            rgb.r = hsv.v;
-            rgb.g = hsv.v;
-            rgb.b = hsv.v;
-        }
-#else
-        rgb.r = hsv.v;
-        rgb.g = hsv.v;
-        rgb.b = hsv.v;
-#endif
+static const uint8_t PROGMEM hsv_region_channels[7][3] = {
+    {HSV_V, HSV_T, HSV_P}, {HSV_Q, HSV_V, HSV_P}, {HSV_P, HSV_V, HSV_T}, {HSV_P, HSV_Q, HSV_V}, {HSV_T, HSV_P, HSV_V}, {HSV_V, HSV_P, HSV_Q}, {HSV_V, HSV_T, HSV_P},
+};
+
+static inline RGB hsv_to_rgb_core(uint8_t h, uint8_t s, uint8_t v) {
+    RGB rgb;
+
+    if (s == 0) {
+        rgb.r = v;
+        rgb.g = v;
+        rgb.b = v;
         return rgb;
     }
 
-    h = hsv.h;
-    s = hsv.s;
+    uint8_t region    = (uint16_t)h * 6 / 255;
+    uint8_t remainder = (h * 2 - region * 85) * 3;
+
+    uint8_t channels[4];
+    channels[HSV_V] = v;
+    channels[HSV_P] = (v * (255 - s)) >> 8;
+    channels[HSV_Q] = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    channels[HSV_T] = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+
+    rgb.r = channels[pgm_read_byte(&hsv_region_channels[region][0])];
+    rgb.g = channels[pgm_read_byte(&hsv_region_channels[region][1])];
+    rgb.b = channels[pgm_read_byte(&hsv_region_channels[region][2])];
+    return rgb;
+}
+
+RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
 #ifdef USE_CIE1931_CURVE
     if (use_cie) {
-        v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-    } else {
-        v = hsv.v;
+        hsv.v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
     }
-#else
-    v = hsv.v;
 #endif
+    return hsv_to_rgb_core(hsv.h, hsv.s, hsv.v);
+}
 
-    region    = h * 6 / 255;
-    remainder = (h * 2 - region * 85) * 3;
-
-    p = (v * (255 - s)) >> 8;
-    q = (v * (255 - ((s * remainder) >> 8))) >> 8;
-    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
-
-    switch (region) {
-        case 6:
-        case 0:
-            rgb.r = v;
-            rgb.g = t;
-            rgb.b = p;
-            break;
-        case 1:
-            rgb.r = q;
-            rgb.g = v;
-            rgb.b = p;
-            break;
-        case 2:
-            rgb.r = p;
-            rgb.g = v;
-            rgb.b = t;
-            break;
-        case 3:
-            rgb.r = p;
-            rgb.g = q;
-            rgb.b = v;
-            break;
-        case 4:
-            rgb.r = t;
-            rgb.g = p;
-            rgb.b = v;
-            break;
-        default:
-            rgb.r = v;
-            rgb.g = p;
-            rgb.b = q;
-            break;
+static void hsv_to_rgb_batch_impl(const HSV *hsv, RGB *rgb, uint8_t count, bool use_cie) {
+#ifdef USE_CIE1931_CURVE
+    if (use_cie) {
+        for (uint8_t i = 0; i < count; i++) {
+            rgb[i] = hsv_to_rgb_core(hsv[i].h, hsv[i].s, pgm_read_byte(&CIE1931_CURVE[hsv[i].v]));
+        }
+        return;
+    }
+#endif
+    for (uint8_t i = 0; i < count; i++) {
+        rgb[i] = hsv_to_rgb_core(hsv[i].h, hsv[i].s, hsv[i].v);
     }
-
-    return rgb;
 }
 
 RGB hsv_to_rgb(HSV hsv) {
@@ -106,6 +84,16 @@ RGB hsv_to_rgb(HSV hsv) {
 
 RGB hsv_to_rgb_nocie(HSV hsv) { return hsv_to_rgb_impl(hsv, false); }
 
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+#ifdef USE_CIE1931_CURVE
+    hsv_to_rgb_batch_impl(hsv, rgb, count, true);
+#else
+    hsv_to_rgb_batch_impl(hsv, rgb, count, false);
+#endif
+}
+
+void hsv_to_rgb_batch_nocie(const HSV *hsv, RGB *rgb, uint8_t count) { hsv_to_rgb_batch_impl(hsv, rgb, count, false); }
+
 #ifdef RGBW
 #    ifndef MIN
 #        define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -80,8 +80,10 @@ typedef struct PACKED {
 #    pragma pack(pop)
 #endif
 
-RGB hsv_to_rgb(HSV hsv);
-RGB hsv_to_rgb_nocie(HSV hsv);
+RGB  hsv_to_rgb(HSV hsv);
+RGB  hsv_to_rgb_nocie(HSV hsv);
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count);
+void hsv_to_rgb_batch_nocie(const HSV *hsv, RGB *rgb, uint8_t count);
 #ifdef RGBW
 void convert_rgb_to_rgbw(LED_TYPE *led);
 #endif
@@ -0,0 +1,148 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+Asymmetric per-key algorithm. Uses an 8-bit timestamp per key.
+Key-down is eager: after pressing a key, it immediately changes state, and no
+further inputs are accepted until DEBOUNCE milliseconds have occurred.
+Key-up is deferred: a release is only pushed once the key has read as released
+for DEBOUNCE milliseconds, so chatter on release doesn't cause extra presses.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#define ROW_SHIFTER ((matrix_row_t)1)
+
+#define debounce_counter_t uint8_t
+
+static debounce_counter_t *debounce_counters;
+// Set for keys whose running counter follows a press, clear for a release
+static matrix_row_t *debounce_pressed;
+static bool          counters_need_update;
+static bool          matrix_need_update;
+
+#define DEBOUNCE_ELAPSED 251
+#define MAX_DEBOUNCE (DEBOUNCE_ELAPSED - 1)
+
+#if DEBOUNCE > MAX_DEBOUNCE
+#    error "DEBOUNCE must be 250 or less."
+#endif
+
+static uint8_t wrapping_timer_read(void) {
+    static uint16_t time        = 0;
+    static uint8_t  last_result = 0;
+    uint16_t        new_time    = timer_read();
+    uint16_t        diff        = new_time - time;
+    time                        = new_time;
+    last_result                 = (last_result + diff) % (MAX_DEBOUNCE + 1);
+    return last_result;
+}
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t current_time);
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t previous[], matrix_row_t cooked[], uint8_t num_rows, uint8_t current_time);
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    debounce_counters = (debounce_counter_t *)malloc(num_rows * MATRIX_COLS * sizeof(debounce_counter_t));
+    debounce_pressed  = (matrix_row_t *)calloc(num_rows, sizeof(matrix_row_t));
+    int i             = 0;
+    for (uint8_t r = 0; r < num_rows; r++) {
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            debounce_counters[i++] = DEBOUNCE_ELAPSED;
+        }
+    }
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint8_t current_time = wrapping_timer_read();
+    // Both checks look at cooked as it was before this scan, so that a release doesn't hide a press in the same scan
+    matrix_row_t previous[MATRIX_ROWS];
+    memcpy(previous, cooked, num_rows * sizeof(matrix_row_t));
+    if (counters_need_update) {
+        update_debounce_counters_and_transfer_if_expired(raw, cooked, num_rows, current_time);
+    }
+
+    if (changed || matrix_need_update) {
+        start_debounce_counters(raw, previous, cooked, num_rows, current_time);
+    }
+}
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t current_time) {
+    counters_need_update                 = false;
+    debounce_counter_t *debounce_pointer = debounce_counters;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            matrix_row_t col_mask = (ROW_SHIFTER << col);
+            if (*debounce_pointer != DEBOUNCE_ELAPSED) {
+                if (TIMER_DIFF(current_time, *debounce_pointer, MAX_DEBOUNCE) >= DEBOUNCE) {
+                    *debounce_pointer = DEBOUNCE_ELAPSED;
+                    if (debounce_pressed[row] & col_mask) {
+                        // key-down: the press was pushed already, the key may have been released since
+                        matrix_need_update = true;
+                    } else {
+                        // key-up: the key has read as released for long enough
+                        cooked[row] &= ~col_mask;
+                    }
+                } else {
+                    counters_need_update = true;
+                }
+            }
+            debounce_pointer++;
+        }
+    }
+}
+
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t previous[], matrix_row_t cooked[], uint8_t num_rows, uint8_t current_time) {
+    matrix_need_update                   = false;
+    debounce_counter_t *debounce_pointer = debounce_counters;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t delta = raw[row] ^ previous[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            matrix_row_t col_mask = (ROW_SHIFTER << col);
+            if (delta & col_mask) {
+                if (*debounce_pointer == DEBOUNCE_ELAPSED) {
+                    *debounce_pointer    = current_time;
+                    counters_need_update = true;
+                    if (raw[row] & col_mask) {
+                        // key-down: eager
+                        debounce_pressed[row] |= col_mask;
+                        cooked[row] |= col_mask;
+                    } else {
+                        // key-up: defer
+                        debounce_pressed[row] &= ~col_mask;
+                    }
+                }
+            } else if (*debounce_pointer != DEBOUNCE_ELAPSED && !(debounce_pressed[row] & col_mask)) {
+                // key-up: the key read as pressed again, so the release starts over
+                *debounce_pointer = DEBOUNCE_ELAPSED;
+            }
+            if (*debounce_pointer == DEBOUNCE_ELAPSED && ((raw[row] ^ cooked[row]) & col_mask)) {
+                // key-up: released during this scan while it reads as pressed, which is pushed on the next one
+                matrix_need_update = true;
+            }
+            debounce_pointer++;
+        }
+    }
+}
+
+bool debounce_active(void) { return true; }
@@ -0,0 +1,142 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+Bit-parallel version of sym_eager_pk.
+After pressing a key, it immediately changes state, and no further inputs are
+accepted for that key until DEBOUNCE milliseconds have occurred.
+
+The per-key counters are stored as bit planes: plane n of a row holds bit n of
+the counter of every key in that row. The counters of a whole row are then
+updated with a few bitwise operations, without looping over the columns.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include <stdlib.h>
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#if DEBOUNCE < 2
+#    define DEBOUNCE_PLANES 1
+#elif DEBOUNCE < 4
+#    define DEBOUNCE_PLANES 2
+#elif DEBOUNCE < 8
+#    define DEBOUNCE_PLANES 3
+#elif DEBOUNCE < 16
+#    define DEBOUNCE_PLANES 4
+#elif DEBOUNCE < 32
+#    define DEBOUNCE_PLANES 5
+#elif DEBOUNCE < 64
+#    define DEBOUNCE_PLANES 6
+#elif DEBOUNCE < 128
+#    define DEBOUNCE_PLANES 7
+#elif DEBOUNCE < 256
+#    define DEBOUNCE_PLANES 8
+#else
+#    error "DEBOUNCE must be 255 or less."
+#endif
+
+// Largest time that can be taken off a counter at once
+#define MAX_ELAPSED ((1 << DEBOUNCE_PLANES) - 1)
+
+// Planes of row r start at debounce_planes[r * DEBOUNCE_PLANES], least significant bit first
+static matrix_row_t *debounce_planes;
+static bool          counters_need_update;
+static bool          matrix_need_update;
+static uint16_t      last_time;
+
+static void update_debounce_counters(uint8_t num_rows, uint8_t elapsed);
+static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    debounce_planes = (matrix_row_t *)calloc(num_rows * DEBOUNCE_PLANES, sizeof(matrix_row_t));
+    last_time       = timer_read();
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint16_t now     = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, last_time);
+    last_time        = now;
+
+    if (counters_need_update && elapsed > 0) {
+        update_debounce_counters(num_rows, elapsed > MAX_ELAPSED ? MAX_ELAPSED : elapsed);
+    }
+
+    if (changed || matrix_need_update) {
+        transfer_matrix_values(raw, cooked, num_rows);
+    }
+}
+
+// Subtracts the elapsed time from every counter, stopping at zero.
+static void update_debounce_counters(uint8_t num_rows, uint8_t elapsed) {
+    counters_need_update = false;
+    matrix_row_t *planes = debounce_planes;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        // Ripple borrow subtraction, with the same subtrahend for every key
+        matrix_row_t borrow = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_PLANES; bit++) {
+            matrix_row_t subtrahend = (elapsed >> bit) & 1 ? ~(matrix_row_t)0 : 0;
+            matrix_row_t plane      = planes[bit];
+            planes[bit]             = plane ^ subtrahend ^ borrow;
+            borrow                  = (~plane & (subtrahend | borrow)) | (subtrahend & borrow);
+        }
+
+        // Counters that went below zero have elapsed
+        matrix_row_t active = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_PLANES; bit++) {
+            planes[bit] &= ~borrow;
+            active |= planes[bit];
+        }
+        if (active) {
+            counters_need_update = true;
+        }
+        planes += DEBOUNCE_PLANES;
+    }
+}
+
+// upload from raw_matrix to final matrix;
+static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    matrix_need_update   = false;
+    matrix_row_t *planes = debounce_planes;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t active = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_PLANES; bit++) {
+            active |= planes[bit];
+        }
+
+        matrix_row_t delta = raw[row] ^ cooked[row];
+        matrix_row_t ready = delta & ~active;
+        if (delta & active) {
+            matrix_need_update = true;
+        }
+
+        if (ready) {
+            cooked[row] ^= ready;  // flip the bits.
+            // Start the counters of the keys that changed at DEBOUNCE
+            for (uint8_t bit = 0; bit < DEBOUNCE_PLANES; bit++) {
+                planes[bit] = (DEBOUNCE >> bit) & 1 ? planes[bit] | ready : planes[bit] & ~ready;
+            }
+            counters_need_update = true;
+        }
+        planes += DEBOUNCE_PLANES;
+    }
+}
+
+bool debounce_active(void) { return true; }
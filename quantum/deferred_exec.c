@@ -0,0 +1,241 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+
+#include "deferred_exec.h"
+#include "timer.h"
+
+#define DEFERRED_EXEC_TOTAL_TASKS (DEFERRED_EXEC_MAX_TASKS + DEFERRED_EXEC_RESERVED_TASKS)
+
+#if DEFERRED_EXEC_TOTAL_TASKS > 254
+#    error "DEFERRED_EXEC_MAX_TASKS and DEFERRED_EXEC_RESERVED_TASKS must add up to 254 or less."
+#endif
+#if (DEFERRED_EXEC_WHEEL_SIZE & (DEFERRED_EXEC_WHEEL_SIZE - 1)) != 0
+#    error "DEFERRED_EXEC_WHEEL_SIZE must be a power of two."
+#endif
+
+#define DEFERRED_EXEC_NONE 0xFF
+// The list of callbacks that are due, after the slots of the wheel
+#define DEFERRED_EXEC_DUE DEFERRED_EXEC_WHEEL_SIZE
+
+typedef enum {
+    TASK_FREE,
+    TASK_SCHEDULED,  // in the list of its slot, or in the list of due callbacks
+    TASK_RUNNING,
+} deferred_exec_state_t;
+
+typedef struct {
+    uint32_t               deadline;
+    deferred_exec_callback callback;
+    void *                 cb_arg;
+    deferred_token         token;
+    uint8_t                next;
+    uint8_t                prev;
+    uint8_t                list;
+    deferred_exec_state_t  state;
+} deferred_exec_task_t;
+
+// The reserved callbacks come after the others
+static deferred_exec_task_t tasks[DEFERRED_EXEC_TOTAL_TASKS];
+static uint8_t              lists[DEFERRED_EXEC_WHEEL_SIZE + 1];
+static uint8_t              due_tail;
+static uint8_t              scheduled_count = 0;
+static uint8_t              generation      = 0;
+// The last millisecond whose slot has been looked at
+static uint32_t last_tick;
+static bool     initialised = false;
+
+static void deferred_exec_init(void) {
+    initialised = true;
+    for (uint8_t i = 0; i <= DEFERRED_EXEC_WHEEL_SIZE; i++) {
+        lists[i] = DEFERRED_EXEC_NONE;
+    }
+    due_tail  = DEFERRED_EXEC_NONE;
+    last_tick = timer_read32();
+}
+
+static deferred_exec_task_t *deferred_exec_find(deferred_token token) {
+    uint8_t index = (token & 0xFF) - 1;
+    if (token == INVALID_DEFERRED_TOKEN || index >= DEFERRED_EXEC_TOTAL_TASKS || tasks[index].token != token || tasks[index].state == TASK_FREE) {
+        return NULL;
+    }
+    return &tasks[index];
+}
+
+static void deferred_exec_unlink(uint8_t index) {
+    deferred_exec_task_t *task = &tasks[index];
+    if (task->prev != DEFERRED_EXEC_NONE) {
+        tasks[task->prev].next = task->next;
+    } else {
+        lists[task->list] = task->next;
+    }
+    if (task->next != DEFERRED_EXEC_NONE) {
+        tasks[task->next].prev = task->prev;
+    } else if (task->list == DEFERRED_EXEC_DUE) {
+        due_tail = task->prev;
+    }
+}
+
+// Puts the task in the slot of its deadline, or of the next millisecond if that has already been looked at
+static void deferred_exec_insert(uint8_t index) {
+    deferred_exec_task_t *task = &tasks[index];
+    uint32_t              tick = (int32_t)(task->deadline - last_tick) > 0 ? task->deadline : last_tick + 1;
+
+    task->state = TASK_SCHEDULED;
+    task->list  = tick & (DEFERRED_EXEC_WHEEL_SIZE - 1);
+    task->prev  = DEFERRED_EXEC_NONE;
+    task->next  = lists[task->list];
+    if (task->next != DEFERRED_EXEC_NONE) {
+        tasks[task->next].prev = index;
+    }
+    lists[task->list] = index;
+}
+
+static void deferred_exec_free(uint8_t index) {
+    tasks[index].state = TASK_FREE;
+    scheduled_count--;
+}
+
+static deferred_token deferred_exec_schedule(uint8_t first, uint8_t last, uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+    if (!initialised) {
+        deferred_exec_init();
+    }
+
+    for (uint8_t i = first; i < last; i++) {
+        deferred_exec_task_t *task = &tasks[i];
+        if (task->state != TASK_FREE) {
+            continue;
+        }
+        // Tokens of earlier callbacks in the same place stay invalid, at least until the generation wraps around
+        generation++;
+        task->token    = ((deferred_token)generation << 8) | (i + 1);
+        task->deadline = timer_read32() + delay_ms;
+        task->callback = callback;
+        task->cb_arg   = cb_arg;
+        scheduled_count++;
+        deferred_exec_insert(i);
+        return task->token;
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) { return deferred_exec_schedule(0, DEFERRED_EXEC_MAX_TASKS, delay_ms, callback, cb_arg); }
+
+deferred_token defer_exec_reserved(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) { return deferred_exec_schedule(DEFERRED_EXEC_MAX_TASKS, DEFERRED_EXEC_TOTAL_TASKS, delay_ms, callback, cb_arg); }
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+    deferred_exec_task_t *task = deferred_exec_find(token);
+    if (task == NULL) {
+        return false;
+    }
+    uint8_t index = task - tasks;
+    if (task->state == TASK_SCHEDULED) {
+        deferred_exec_unlink(index);
+    }
+    task->deadline = timer_read32() + delay_ms;
+    deferred_exec_insert(index);
+    return true;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+    deferred_exec_task_t *task = deferred_exec_find(token);
+    if (task == NULL) {
+        return false;
+    }
+    uint8_t index = task - tasks;
+    if (task->state == TASK_SCHEDULED) {
+        deferred_exec_unlink(index);
+    }
+    deferred_exec_free(index);
+    return true;
+}
+
+// Moves the task to the list of due callbacks, which is kept in the order of the deadlines
+static void deferred_exec_make_due(uint8_t index) {
+    deferred_exec_task_t *task = &tasks[index];
+    uint8_t               prev = due_tail;
+    while (prev != DEFERRED_EXEC_NONE && (int32_t)(tasks[prev].deadline - task->deadline) > 0) {
+        prev = tasks[prev].prev;
+    }
+
+    task->list = DEFERRED_EXEC_DUE;
+    task->prev = prev;
+    task->next = prev != DEFERRED_EXEC_NONE ? tasks[prev].next : lists[DEFERRED_EXEC_DUE];
+    if (task->next != DEFERRED_EXEC_NONE) {
+        tasks[task->next].prev = index;
+    } else {
+        due_tail = index;
+    }
+    if (prev != DEFERRED_EXEC_NONE) {
+        tasks[prev].next = index;
+    } else {
+        lists[DEFERRED_EXEC_DUE] = index;
+    }
+}
+
+// Moves the callbacks in the slot that are due to the list of due callbacks
+static void deferred_exec_collect(uint8_t slot, uint32_t now) {
+    uint8_t index = lists[slot];
+    while (index != DEFERRED_EXEC_NONE) {
+        uint8_t next = tasks[index].next;
+        if ((int32_t)(now - tasks[index].deadline) >= 0) {
+            deferred_exec_unlink(index);
+            deferred_exec_make_due(index);
+        }
+        index = next;
+    }
+}
+
+void deferred_exec_task(void) {
+    if (scheduled_count == 0) {
+        // Nothing to look at, the wheel can skip ahead
+        if (initialised) {
+            last_tick = timer_read32();
+        }
+        return;
+    }
+
+    uint32_t now = timer_read32();
+    if (now - last_tick > DEFERRED_EXEC_WHEEL_SIZE) {
+        // Every slot is looked at once at most
+        last_tick = now - DEFERRED_EXEC_WHEEL_SIZE;
+    }
+    while (last_tick != now) {
+        last_tick++;
+        deferred_exec_collect(last_tick & (DEFERRED_EXEC_WHEEL_SIZE - 1), now);
+    }
+
+    // Callbacks may schedule, extend or cancel any callback, including themselves
+    while (lists[DEFERRED_EXEC_DUE] != DEFERRED_EXEC_NONE) {
+        uint8_t               index = lists[DEFERRED_EXEC_DUE];
+        deferred_exec_task_t *task  = &tasks[index];
+        deferred_exec_unlink(index);
+        task->state = TASK_RUNNING;
+
+        uint32_t delay = task->callback(task->deadline, task->cb_arg);
+        if (task->state != TASK_RUNNING) {
+            // Cancelled or extended by the callback
+            continue;
+        }
+        if (delay > 0) {
+            task->deadline += delay;
+            deferred_exec_insert(index);
+        } else {
+            deferred_exec_free(index);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Deferred execution.
+ *
+ * Callbacks are scheduled to run from keyboard_task() once a delay has
+ * passed, so that features waiting for a timeout don't have to check their
+ * timers on every scan. Scheduled callbacks are kept in a timer wheel with a
+ * slot per millisecond, which only looks at the callbacks in the slots of the
+ * milliseconds that passed since the last call. Scheduling and cancelling
+ * take constant time.
+ *
+ * Callbacks that are due run in the order of the time they were due at. A
+ * callback returns the delay after which it should run again, counted from
+ * that time, or 0 if it's done.
+ */
+
+// Number of callbacks that can be scheduled at the same time
+#ifndef DEFERRED_EXEC_MAX_TASKS
+#    define DEFERRED_EXEC_MAX_TASKS 8
+#endif
+
+// Number of callbacks kept for Tap Dance, Combos and Auto Shift, one each if
+// enabled, so that they never run out because of the keymap's callbacks
+#ifndef DEFERRED_EXEC_RESERVED_TASKS
+#    if defined(TAP_DANCE_ENABLE)
+#        define DEFERRED_EXEC_RESERVED_TAP_DANCE 1
+#    else
+#        define DEFERRED_EXEC_RESERVED_TAP_DANCE 0
+#    endif
+#    if defined(COMBO_ENABLE)
+#        define DEFERRED_EXEC_RESERVED_COMBO 1
+#    else
+#        define DEFERRED_EXEC_RESERVED_COMBO 0
+#    endif
+#    if defined(AUTO_SHIFT_ENABLE)
+#        define DEFERRED_EXEC_RESERVED_AUTO_SHIFT 1
+#    else
+#        define DEFERRED_EXEC_RESERVED_AUTO_SHIFT 0
+#    endif
+#    define DEFERRED_EXEC_RESERVED_TASKS (DEFERRED_EXEC_RESERVED_TAP_DANCE + DEFERRED_EXEC_RESERVED_COMBO + DEFERRED_EXEC_RESERVED_AUTO_SHIFT)
+#endif
+
+// Number of slots in the wheel, a power of two. Longer delays take several turns of the wheel.
+#ifndef DEFERRED_EXEC_WHEEL_SIZE
+#    define DEFERRED_EXEC_WHEEL_SIZE 32
+#endif
+
+// Identifies a scheduled callback, so that it can be extended or cancelled
+typedef uint16_t deferred_token;
+
+#define INVALID_DEFERRED_TOKEN 0
+
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void *cb_arg);
+
+// Returns INVALID_DEFERRED_TOKEN if there are too many callbacks scheduled already
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg);
+// Schedules one of the reserved callbacks. Each feature it is reserved for
+// must have at most one of them scheduled at a time, then it never fails.
+deferred_token defer_exec_reserved(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg);
+// Reschedules the callback to run after delay_ms from now
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms);
+bool cancel_deferred_exec(deferred_token token);
+
+void deferred_exec_task(void);
@@ -18,9 +18,11 @@
 #include "keymap.h"  // to get keymaps[][][]
 #include "tmk_core/common/eeprom.h"
 #include "progmem.h"  // to read default from flash
+#include "eeprom_deferred.h"
 #include "quantum.h"  // for send_string()
 #include "dynamic_keymap.h"
 #include "via.h"  // for default VIA_EEPROM_ADDR_END
+#include <string.h>
 
 #ifndef DYNAMIC_KEYMAP_LAYER_COUNT
 #    define DYNAMIC_KEYMAP_LAYER_COUNT 4
@@ -77,48 +79,109 @@
 #    define DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + 1)
 #endif
 
+#define DYNAMIC_KEYMAP_EEPROM_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2)
+
+// The dynamic keymaps are mirrored in RAM so that keycode lookups during
+// key processing don't have to go through the EEPROM (which may be
+// emulated in flash). Writes go through to the EEPROM immediately.
+// The mirror is only used if it fits within DYNAMIC_KEYMAP_CACHE_MAX_SIZE
+// bytes, otherwise the EEPROM is read directly as before.
+// Set DYNAMIC_KEYMAP_CACHE_MAX_SIZE to 0 to disable it completely.
+#ifndef DYNAMIC_KEYMAP_CACHE_MAX_SIZE
+#    if defined(__AVR__)
+#        define DYNAMIC_KEYMAP_CACHE_MAX_SIZE 0
+#    else
+#        define DYNAMIC_KEYMAP_CACHE_MAX_SIZE 4096
+#    endif
+#endif
+
+#if DYNAMIC_KEYMAP_EEPROM_SIZE <= DYNAMIC_KEYMAP_CACHE_MAX_SIZE
+#    define DYNAMIC_KEYMAP_CACHE
+// Same layout as the EEPROM, i.e. big endian keycodes ordered by layer/row/column
+static uint8_t dynamic_keymap_cache[DYNAMIC_KEYMAP_EEPROM_SIZE];
+// Keycodes are read from the mirror, so writing them to EEPROM can be deferred
+#    define dynamic_keymap_update_block(buf, addr, len) eeprom_deferred_update_block(buf, addr, len)
+#else
+#    define dynamic_keymap_update_block(buf, addr, len) eeprom_update_block(buf, addr, len)
+#endif
+
 uint8_t dynamic_keymap_get_layer_count(void) { return DYNAMIC_KEYMAP_LAYER_COUNT; }
 
+bool dynamic_keymap_is_cached(void) {
+#ifdef DYNAMIC_KEYMAP_CACHE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void dynamic_keymap_init(void) {
+#ifdef DYNAMIC_KEYMAP_CACHE
+    eeprom_read_block(dynamic_keymap_cache, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR, DYNAMIC_KEYMAP_EEPROM_SIZE);
+#endif
+}
+
 void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column) {
     // TODO: optimize this with some left shifts
     return ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + (layer * MATRIX_ROWS * MATRIX_COLS * 2) + (row * MATRIX_COLS * 2) + (column * 2);
 }
 
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+#ifdef DYNAMIC_KEYMAP_CACHE
+    uint8_t *cached = &dynamic_keymap_cache[(layer * MATRIX_ROWS * MATRIX_COLS * 2) + (row * MATRIX_COLS * 2) + (column * 2)];
+    return (cached[0] << 8) | cached[1];
+#else
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
     uint16_t keycode = eeprom_read_byte(address) << 8;
     keycode |= eeprom_read_byte(address + 1);
     return keycode;
+#endif
 }
 
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    eeprom_update_byte(address, (uint8_t)(keycode >> 8));
-    eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+    uint8_t data[2] = {(uint8_t)(keycode >> 8), (uint8_t)(keycode & 0xFF)};
+    dynamic_keymap_update_block(data, address, 2);
+#ifdef DYNAMIC_KEYMAP_CACHE
+    memcpy(&dynamic_keymap_cache[address - (void *)DYNAMIC_KEYMAP_EEPROM_ADDR], data, 2);
+#endif
+#if defined(EFFECTIVE_LAYER_CACHE) && !defined(NO_ACTION_LAYER)
+    effective_layer_cache_invalidate();
+#endif
 }
 
 void dynamic_keymap_reset(void) {
     // Reset the keymaps in EEPROM to what is in flash.
     // All keyboards using dynamic keymaps should define a layout
     // for the same number of layers as DYNAMIC_KEYMAP_LAYER_COUNT.
+    // Each row is written as one block, so the EEPROM driver can skip
+    // whatever hasn't changed.
+    uint8_t data[MATRIX_COLS * 2];
     for (int layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
         for (int row = 0; row < MATRIX_ROWS; row++) {
             for (int column = 0; column < MATRIX_COLS; column++) {
-                dynamic_keymap_set_keycode(layer, row, column, pgm_read_word(&keymaps[layer][row][column]));
+                uint16_t keycode     = pgm_read_word(&keymaps[layer][row][column]);
+                data[column * 2]     = (uint8_t)(keycode >> 8);
+                data[column * 2 + 1] = (uint8_t)(keycode & 0xFF);
             }
+            dynamic_keymap_set_buffer((layer * MATRIX_ROWS * MATRIX_COLS * 2) + (row * MATRIX_COLS * 2), sizeof(data), data);
         }
     }
 }
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
+    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_EEPROM_SIZE;
     void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
     uint8_t *target                     = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < dynamic_keymap_eeprom_size) {
+#ifdef DYNAMIC_KEYMAP_CACHE
+            *target = dynamic_keymap_cache[offset + i];
+#else
             *target = eeprom_read_byte(source);
+#endif
         } else {
             *target = 0x00;
         }
@@ -128,16 +191,20 @@ void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
+    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_EEPROM_SIZE;
+    if (offset >= dynamic_keymap_eeprom_size) {
+        return;
     }
+    if (size > dynamic_keymap_eeprom_size - offset) {
+        size = dynamic_keymap_eeprom_size - offset;
+    }
+    dynamic_keymap_update_block(data, (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset), size);
+#ifdef DYNAMIC_KEYMAP_CACHE
+    memcpy(&dynamic_keymap_cache[offset], data, size);
+#endif
+#if defined(EFFECTIVE_LAYER_CACHE) && !defined(NO_ACTION_LAYER)
+    effective_layer_cache_invalidate();
+#endif
 }
 
 // This overrides the one in quantum/keymap_common.c
@@ -168,23 +235,21 @@ void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *da
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *source = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
+    if (offset >= DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
+        return;
+    }
+    if (size > DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - offset) {
+        size = DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - offset;
     }
+    eeprom_update_block(data, (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset), size);
 }
 
 void dynamic_keymap_macro_reset(void) {
-    void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (p != end) {
-        eeprom_update_byte(p, 0);
-        ++p;
+    uint8_t  zeros[32] = {0};
+    uint16_t offset    = 0;
+    while (offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
+        dynamic_keymap_macro_set_buffer(offset, sizeof(zeros), zeros);
+        offset += sizeof(zeros);
     }
 }
 
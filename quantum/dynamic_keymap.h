@@ -18,6 +18,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Loads the dynamic keymaps from EEPROM into the RAM cache, if enabled.
+// Called by QMK core at startup (by via_init() when VIA is enabled).
+void     dynamic_keymap_init(void);
+bool     dynamic_keymap_is_cached(void);
 uint8_t  dynamic_keymap_get_layer_count(void);
 void *   dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column);
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column);
@@ -0,0 +1,178 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "eeprom_deferred.h"
+#include "matrix.h"
+#include "timer.h"
+
+// Number of pending blocks that can be held before the queue has to be flushed
+#ifndef EEPROM_DEFERRED_QUEUE_SIZE
+#    define EEPROM_DEFERRED_QUEUE_SIZE 8
+#endif
+
+// Largest contiguous range a single pending block can cover, in bytes
+#ifndef EEPROM_DEFERRED_BLOCK_SIZE
+#    define EEPROM_DEFERRED_BLOCK_SIZE 8
+#endif
+
+// Time without new writes and without any key held before committing, in milliseconds
+#ifndef EEPROM_DEFERRED_IDLE_TIME
+#    define EEPROM_DEFERRED_IDLE_TIME 500
+#endif
+
+// Longest a write is allowed to stay pending, even when the keyboard is never idle, in milliseconds
+#ifndef EEPROM_DEFERRED_MAX_DELAY
+#    define EEPROM_DEFERRED_MAX_DELAY 5000
+#endif
+
+#if EEPROM_DEFERRED_BLOCK_SIZE > 255
+#    error "EEPROM_DEFERRED_BLOCK_SIZE must be 255 or less."
+#endif
+
+typedef struct {
+    uint16_t address;
+    uint8_t  length;
+    uint8_t  data[EEPROM_DEFERRED_BLOCK_SIZE];
+} eeprom_deferred_block_t;
+
+static eeprom_deferred_block_t queue[EEPROM_DEFERRED_QUEUE_SIZE];
+static uint8_t                 queue_count = 0;
+static uint16_t                first_write_time;
+static uint16_t                last_write_time;
+static eeprom_deferred_stats_t stats;
+
+// Copies the part of [address, address + length) that overlaps the block into it.
+static void eeprom_deferred_patch(eeprom_deferred_block_t *block, const uint8_t *src, uint16_t address, uint8_t length) {
+    uint16_t start = address > block->address ? address : block->address;
+    uint16_t end   = address + length < block->address + block->length ? address + length : block->address + block->length;
+    if (start < end) {
+        memcpy(&block->data[start - block->address], &src[start - address], end - start);
+    }
+}
+
+// Grows the block to also cover [address, address + length), if the result is
+// contiguous and fits in a block. Returns true if the block now holds the data.
+static bool eeprom_deferred_merge(eeprom_deferred_block_t *block, const uint8_t *src, uint16_t address, uint8_t length) {
+    uint16_t block_end = block->address + block->length;
+    uint16_t end       = address + length;
+    if (address > block_end || end < block->address) {
+        return false;
+    }
+
+    uint16_t start = address < block->address ? address : block->address;
+    uint16_t stop  = end > block_end ? end : block_end;
+    if (stop - start > EEPROM_DEFERRED_BLOCK_SIZE) {
+        return false;
+    }
+
+    memmove(&block->data[block->address - start], block->data, block->length);
+    memcpy(&block->data[address - start], src, length);
+    block->address = start;
+    block->length  = stop - start;
+    return true;
+}
+
+static void eeprom_deferred_queue(const uint8_t *src, uint16_t address, uint8_t length) {
+    // Every pending block always holds the latest value of the bytes it covers,
+    // so the order in which blocks are committed doesn't matter.
+    for (uint8_t i = 0; i < queue_count; i++) {
+        eeprom_deferred_patch(&queue[i], src, address, length);
+    }
+    for (uint8_t i = 0; i < queue_count; i++) {
+        if (eeprom_deferred_merge(&queue[i], src, address, length)) {
+            stats.coalesced++;
+            return;
+        }
+    }
+    if (queue_count == EEPROM_DEFERRED_QUEUE_SIZE) {
+        stats.overflows++;
+        eeprom_deferred_flush();
+    }
+    // The delay counts from the oldest pending write, including after a flush forced by a full queue
+    if (queue_count == 0) {
+        first_write_time = timer_read();
+    }
+
+    eeprom_deferred_block_t *block = &queue[queue_count++];
+    block->address                 = address;
+    block->length                  = length;
+    memcpy(block->data, src, length);
+}
+
+void eeprom_deferred_update_block(const void *buf, void *addr, size_t len) {
+    const uint8_t *src     = (const uint8_t *)buf;
+    uint16_t       address = (uintptr_t)addr;
+
+    stats.writes++;
+    last_write_time = timer_read();
+
+    while (len > 0) {
+        uint8_t length = len > EEPROM_DEFERRED_BLOCK_SIZE ? EEPROM_DEFERRED_BLOCK_SIZE : len;
+        eeprom_deferred_queue(src, address, length);
+        src += length;
+        address += length;
+        len -= length;
+    }
+}
+
+void eeprom_deferred_read_block(void *buf, const void *addr, size_t len) {
+    eeprom_read_block(buf, addr, len);
+
+    // Pending writes take precedence over what's in EEPROM
+    uint16_t address = (uintptr_t)addr;
+    for (uint8_t i = 0; i < queue_count; i++) {
+        uint16_t start = address > queue[i].address ? address : queue[i].address;
+        uint16_t end   = address + len < queue[i].address + queue[i].length ? address + len : queue[i].address + queue[i].length;
+        if (start < end) {
+            memcpy((uint8_t *)buf + (start - address), &queue[i].data[start - queue[i].address], end - start);
+        }
+    }
+}
+
+bool eeprom_deferred_pending(void) { return queue_count > 0; }
+
+void eeprom_deferred_flush(void) {
+    for (uint8_t i = 0; i < queue_count; i++) {
+        eeprom_update_block(queue[i].data, (void *)(uintptr_t)queue[i].address, queue[i].length);
+        stats.commits++;
+    }
+    queue_count = 0;
+}
+
+void eeprom_deferred_discard(void) { queue_count = 0; }
+
+static bool eeprom_deferred_keys_held(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (matrix_get_row(row)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void eeprom_deferred_task(void) {
+    if (queue_count == 0) {
+        return;
+    }
+
+    if (timer_elapsed(first_write_time) >= EEPROM_DEFERRED_MAX_DELAY || (timer_elapsed(last_write_time) >= EEPROM_DEFERRED_IDLE_TIME && !eeprom_deferred_keys_held())) {
+        eeprom_deferred_flush();
+    }
+}
+
+const eeprom_deferred_stats_t *eeprom_deferred_get_stats(void) { return &stats; }
@@ -0,0 +1,62 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "eeprom.h"
+
+/*
+ * Deferred EEPROM writes.
+ *
+ * Settings that are changed from key processing (lighting, VIA) are queued in
+ * RAM instead of being written straight away, and committed from the main loop
+ * once the keyboard is idle. Repeated writes to the same bytes are coalesced
+ * into a single commit.
+ *
+ * Without EEPROM_DEFERRED_ENABLE, these map onto the regular EEPROM calls.
+ */
+
+#ifdef EEPROM_DEFERRED_ENABLE
+
+typedef struct {
+    uint32_t writes;     // calls to eeprom_deferred_update_block()
+    uint32_t coalesced;  // writes that were merged into an already pending one
+    uint32_t commits;    // blocks passed on to eeprom_update_block()
+    uint32_t overflows;  // times the queue was full and had to be flushed early
+} eeprom_deferred_stats_t;
+
+void eeprom_deferred_update_block(const void *buf, void *addr, size_t len);
+void eeprom_deferred_read_block(void *buf, const void *addr, size_t len);
+bool eeprom_deferred_pending(void);
+void eeprom_deferred_flush(void);
+void eeprom_deferred_discard(void);
+void eeprom_deferred_task(void);
+
+const eeprom_deferred_stats_t *eeprom_deferred_get_stats(void);
+
+#else
+
+#    define eeprom_deferred_update_block(buf, addr, len) eeprom_update_block(buf, addr, len)
+#    define eeprom_deferred_read_block(buf, addr, len) eeprom_read_block(buf, addr, len)
+#    define eeprom_deferred_pending() false
+#    define eeprom_deferred_flush()
+#    define eeprom_deferred_discard()
+#    define eeprom_deferred_task()
+
+#endif
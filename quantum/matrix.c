@@ -20,6 +20,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include "debounce.h"
 #include "quantum.h"
+#include "matrix_ports.h"
+#ifdef MATRIX_IDLE_ENABLE
+#    include "matrix_idle.h"
+#endif
 
 #ifdef DIRECT_PINS
 static pin_t direct_pins[MATRIX_ROWS][MATRIX_COLS] = DIRECT_PINS;
@@ -90,11 +94,18 @@ static void unselect_rows(void) {
     }
 }
 
+#        ifdef MATRIX_READ_PORTS
+static matrix_ports_t col_ports;
+#        endif
+
 static void init_pins(void) {
     unselect_rows();
     for (uint8_t x = 0; x < MATRIX_COLS; x++) {
         setPinInputHigh_atomic(col_pins[x]);
     }
+#        ifdef MATRIX_READ_PORTS
+    matrix_ports_init(&col_ports, col_pins, MATRIX_COLS);
+#        endif
 }
 
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
@@ -105,6 +116,10 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     select_row(current_row);
     matrix_io_delay();
 
+#        ifdef MATRIX_READ_PORTS
+    // Read all cols at once, one port at a time (active low)
+    current_row_value = matrix_ports_read_low(&col_ports);
+#        else
     // For each col...
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
         // Select the col pin to read (active low)
@@ -113,6 +128,7 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
         // Populate the matrix row with the state of the col pin
         current_row_value |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
     }
+#        endif
 
     // Unselect row
     unselect_row(current_row);
@@ -186,6 +202,65 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_IDLE_ENABLE
+// While idle, every output is driven active, so that any key press pulls its input low
+#    if defined(DIRECT_PINS)
+#        define IDLE_INPUT_COUNT (MATRIX_ROWS * MATRIX_COLS)
+static const pin_t *idle_inputs = &direct_pins[0][0];
+
+static void idle_select(void) {}
+static void idle_unselect(void) {}
+#    elif (DIODE_DIRECTION == COL2ROW)
+#        define IDLE_INPUT_COUNT MATRIX_COLS
+static const pin_t *idle_inputs = col_pins;
+
+static void idle_select(void) {
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        select_row(x);
+    }
+}
+static void idle_unselect(void) { unselect_rows(); }
+#    elif (DIODE_DIRECTION == ROW2COL)
+#        define IDLE_INPUT_COUNT MATRIX_ROWS
+static const pin_t *idle_inputs = row_pins;
+
+static void idle_select(void) {
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        select_col(x);
+    }
+}
+static void idle_unselect(void) { unselect_cols(); }
+#    endif
+
+void matrix_idle_arm(void) {
+    idle_select();
+    matrix_io_delay();
+    for (uint16_t i = 0; i < IDLE_INPUT_COUNT; i++) {
+        if (idle_inputs[i] != NO_PIN) {
+            matrix_idle_enable_wake(idle_inputs[i]);
+        }
+    }
+}
+
+void matrix_idle_disarm(void) {
+    for (uint16_t i = 0; i < IDLE_INPUT_COUNT; i++) {
+        if (idle_inputs[i] != NO_PIN) {
+            matrix_idle_disable_wake(idle_inputs[i]);
+        }
+    }
+    idle_unselect();
+}
+
+bool matrix_idle_key_down(void) {
+    for (uint16_t i = 0; i < IDLE_INPUT_COUNT; i++) {
+        if (idle_inputs[i] != NO_PIN && !readPin(idle_inputs[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
 void matrix_init(void) {
     // initialize key pins
     init_pins();
@@ -204,6 +279,13 @@ void matrix_init(void) {
 uint8_t matrix_scan(void) {
     bool changed = false;
 
+#ifdef MATRIX_IDLE_ENABLE
+    matrix_idle_wait();
+#endif
+#ifdef KEYEVENT_TIME_US
+    matrix_scan_timestamp();
+#endif
+
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
     // Set row, read cols
     for (uint8_t current_row = 0; current_row < MATRIX_ROWS; current_row++) {
@@ -218,6 +300,14 @@ uint8_t matrix_scan(void) {
 
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
 
+#ifdef MATRIX_IDLE_ENABLE
+    bool keys_down = false;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        keys_down |= matrix[row] != 0;
+    }
+    matrix_idle_update(changed, keys_down);
+#endif
+
     matrix_scan_quantum();
     return (uint8_t)changed;
 }
@@ -3,6 +3,9 @@
 #include "wait.h"
 #include "print.h"
 #include "debug.h"
+#ifdef MATRIX_IDLE_ENABLE
+#    include "matrix_idle.h"
+#endif
 
 #ifndef MATRIX_IO_DELAY
 #    define MATRIX_IO_DELAY 30
@@ -105,10 +108,25 @@ __attribute__((weak)) void matrix_init(void) {
 }
 
 __attribute__((weak)) uint8_t matrix_scan(void) {
+#ifdef MATRIX_IDLE_ENABLE
+    matrix_idle_wait();
+#endif
+#ifdef KEYEVENT_TIME_US
+    matrix_scan_timestamp();
+#endif
+
     bool changed = matrix_scan_custom(raw_matrix);
 
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
 
+#ifdef MATRIX_IDLE_ENABLE
+    bool keys_down = false;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        keys_down |= matrix[row] != 0;
+    }
+    matrix_idle_update(changed, keys_down);
+#endif
+
     matrix_scan_quantum();
     return changed;
 }
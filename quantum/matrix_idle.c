@@ -0,0 +1,161 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "matrix_idle.h"
+#include "timer.h"
+
+#if defined(__AVR__)
+#    include <avr/interrupt.h>
+#    include <avr/sleep.h>
+#elif defined(PROTOCOL_CHIBIOS)
+#    include "ch.h"
+#    include "hal.h"
+#endif
+
+static uint32_t            last_activity;
+static uint32_t            wake_time;
+static bool                wake_pending = false;
+static matrix_idle_stats_t stats;
+
+__attribute__((weak)) bool matrix_idle_allowed_user(void) { return true; }
+
+__attribute__((weak)) bool matrix_idle_allowed_kb(void) { return matrix_idle_allowed_user(); }
+
+#if defined(__AVR__)
+
+// Pin change interrupts only cover some pins on most AVRs, so the inputs are
+// checked again whenever anything wakes the MCU up, at the latest on the next
+// timer tick.
+void matrix_idle_enable_wake(pin_t pin) {}
+
+void matrix_idle_disable_wake(pin_t pin) {}
+
+bool matrix_idle_sleep(uint16_t timeout) {
+    uint16_t start = timer_read();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    while (timer_elapsed(start) < timeout) {
+        if (matrix_idle_key_down()) {
+            return true;
+        }
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    return false;
+}
+
+static void matrix_idle_clear(void) {}
+
+#elif defined(PROTOCOL_CHIBIOS)
+
+// Requires PAL_USE_CALLBACKS in halconf.h
+static BSEMAPHORE_DECL(wake_semaphore, true);
+
+static void matrix_idle_wake_cb(void *arg) {
+    chSysLockFromISR();
+    chBSemSignalI(&wake_semaphore);
+    chSysUnlockFromISR();
+}
+
+// An EXTI line serves the pins of the same number on every port, so only one of them can have it
+static ioline_t     wake_lines[PAL_IOPORTS_WIDTH];
+static ioportmask_t wake_pads   = 0;
+static bool         wake_polled = false;
+
+void matrix_idle_enable_wake(pin_t pin) {
+    ioportmask_t pad = (ioportmask_t)1 << PAL_PAD(pin);
+    if (wake_pads & pad) {
+        wake_polled = true;
+        return;
+    }
+    wake_pads |= pad;
+    wake_lines[PAL_PAD(pin)] = pin;
+    palEnableLineEvent(pin, PAL_EVENT_MODE_FALLING_EDGE);
+    palSetLineCallback(pin, matrix_idle_wake_cb, NULL);
+}
+
+void matrix_idle_disable_wake(pin_t pin) {
+    ioportmask_t pad = (ioportmask_t)1 << PAL_PAD(pin);
+    if ((wake_pads & pad) && wake_lines[PAL_PAD(pin)] == pin) {
+        palDisableLineEvent(pin);
+        wake_pads &= ~pad;
+    }
+    if (!wake_pads) {
+        wake_polled = false;
+    }
+}
+
+bool matrix_idle_sleep(uint16_t timeout) {
+    if (!wake_polled) {
+        return chBSemWaitTimeout(&wake_semaphore, TIME_MS2I(timeout)) == MSG_OK;
+    }
+    // Some inputs have no line of their own
+    for (uint16_t elapsed = 0; elapsed < timeout; elapsed++) {
+        if (matrix_idle_key_down() || chBSemWaitTimeout(&wake_semaphore, TIME_MS2I(1)) == MSG_OK) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drops an edge that came in after the matrix had already been found active
+static void matrix_idle_clear(void) { chBSemReset(&wake_semaphore, true); }
+
+#else
+
+static void matrix_idle_clear(void) {}
+
+#endif
+
+void matrix_idle_wait(void) {
+    if (timer_elapsed32(last_activity) < MATRIX_IDLE_TIMEOUT || !matrix_idle_allowed_kb()) {
+        return;
+    }
+
+    // A wake up that never led to a key press doesn't count towards the latency
+    wake_pending = false;
+    stats.sleeps++;
+
+    matrix_idle_arm();
+    bool woken = matrix_idle_key_down() || matrix_idle_sleep(MATRIX_IDLE_MAX_SLEEP);
+    matrix_idle_disarm();
+    matrix_idle_clear();
+
+    if (woken) {
+        stats.wakes++;
+        wake_pending  = true;
+        wake_time     = timer_read32();
+        last_activity = wake_time;
+    }
+}
+
+void matrix_idle_update(bool changed, bool keys_down) {
+    if (changed || keys_down) {
+        last_activity = timer_read32();
+    }
+
+    if (wake_pending && keys_down) {
+        uint32_t latency        = timer_elapsed32(wake_time);
+        stats.last_wake_latency = latency > UINT16_MAX ? UINT16_MAX : latency;
+        if (stats.last_wake_latency > stats.max_wake_latency) {
+            stats.max_wake_latency = stats.last_wake_latency;
+        }
+        wake_pending = false;
+    }
+}
+
+const matrix_idle_stats_t *matrix_idle_get_stats(void) { return &stats; }
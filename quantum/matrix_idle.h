@@ -0,0 +1,84 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "quantum.h"
+
+/*
+ * Idle scan suspension.
+ *
+ * Once no key has been down or moved for MATRIX_IDLE_TIMEOUT, matrix_scan()
+ * arms the matrix, so that any key press pulls one of its inputs low, and
+ * sleeps until that happens. Full rate scanning resumes as soon as the matrix
+ * wakes up. Sleeps are cut short after MATRIX_IDLE_MAX_SLEEP, so that the rest
+ * of the main loop still gets to run every so often.
+ */
+
+// Time without any key down or moving before the scan is suspended, in milliseconds
+#ifndef MATRIX_IDLE_TIMEOUT
+#    define MATRIX_IDLE_TIMEOUT 1000
+#endif
+
+// Longest single sleep, in milliseconds
+#ifndef MATRIX_IDLE_MAX_SLEEP
+#    define MATRIX_IDLE_MAX_SLEEP 100
+#endif
+
+typedef struct {
+    uint32_t sleeps;             // times the scan was suspended
+    uint32_t wakes;              // sleeps that were ended by a key, rather than by MATRIX_IDLE_MAX_SLEEP
+    uint16_t last_wake_latency;  // time from the last wake up to the first debounced key press, in milliseconds
+    uint16_t max_wake_latency;
+} matrix_idle_stats_t;
+
+// Called by the matrix at the start of matrix_scan(). Sleeps if the matrix has been idle long enough.
+void matrix_idle_wait(void);
+// Called by the matrix at the end of matrix_scan(), with whether the raw matrix changed and any debounced key is down
+void matrix_idle_update(bool changed, bool keys_down);
+
+const matrix_idle_stats_t *matrix_idle_get_stats(void);
+
+// Return false to keep scanning at full rate, for example while an animation is running
+bool matrix_idle_allowed_kb(void);
+bool matrix_idle_allowed_user(void);
+
+/*
+ * Implemented by the matrix: arm drives every key's output active and enables
+ * wake up on the inputs, key_down reports whether any input is active while
+ * armed, and disarm restores the matrix for scanning.
+ */
+
+void matrix_idle_arm(void);
+void matrix_idle_disarm(void);
+bool matrix_idle_key_down(void);
+
+/*
+ * Implemented by the platform: wake up on a falling edge of the pin, and sleep
+ * until one fires or the timeout runs out. Returns true when woken up by a pin.
+ *
+ * On ChibiOS, pins with the same number on different ports share an EXTI line.
+ * Only the first of them wakes up, and while armed with such pins, the sleep
+ * polls the matrix every millisecond instead.
+ */
+
+#ifdef readPin
+void matrix_idle_enable_wake(pin_t pin);
+void matrix_idle_disable_wake(pin_t pin);
+#endif
+bool matrix_idle_sleep(uint16_t timeout);
@@ -0,0 +1,76 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "matrix_ports.h"
+
+#ifdef MATRIX_READ_PORTS
+
+static uint8_t matrix_ports_index(matrix_ports_t *ports, pin_port_t port) {
+    for (uint8_t i = 0; i < ports->port_count; i++) {
+        if (ports->ports[i] == port) {
+            return i;
+        }
+    }
+    ports->ports[ports->port_count] = port;
+    return ports->port_count++;
+}
+
+void matrix_ports_init(matrix_ports_t *ports, const pin_t *pins, uint8_t count) {
+    ports->port_count = 0;
+    ports->run_count  = 0;
+
+    for (uint8_t bit = 0; bit < count; bit++) {
+        if (pins[bit] == NO_PIN) {
+            continue;
+        }
+
+        uint8_t port = matrix_ports_index(ports, getPinPort(pins[bit]));
+        uint8_t pad  = getPinPad(pins[bit]);
+
+        // Extend the previous run if this pin follows on from it, both on the port and in the result
+        if (ports->run_count > 0) {
+            matrix_ports_run_t *run = &ports->runs[ports->run_count - 1];
+            if (run->port == port && run->pad + run->count == pad && run->bit + run->count == bit) {
+                run->mask = (run->mask << 1) | 1;
+                run->count++;
+                continue;
+            }
+        }
+
+        matrix_ports_run_t *run = &ports->runs[ports->run_count++];
+        run->mask               = 1;
+        run->port               = port;
+        run->pad                = pad;
+        run->bit                = bit;
+        run->count              = 1;
+    }
+}
+
+matrix_row_t matrix_ports_read_low(const matrix_ports_t *ports) {
+    port_data_t low[MATRIX_COLS];
+    for (uint8_t i = 0; i < ports->port_count; i++) {
+        low[i] = ~readPort(ports->ports[i]);
+    }
+
+    matrix_row_t result = 0;
+    for (uint8_t i = 0; i < ports->run_count; i++) {
+        const matrix_ports_run_t *run = &ports->runs[i];
+        result |= (matrix_row_t)((low[run->port] >> run->pad) & run->mask) << run->bit;
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "matrix.h"
+#include "quantum.h"
+
+/*
+ * Reads a set of input pins a whole GPIO port at a time.
+ *
+ * The pins are grouped by port once, at init. Pins that sit next to each other
+ * on the same port, in the same order as their bits in the result, are then
+ * extracted together with a single shift and mask. For the usual layout of
+ * columns wired to consecutive pins, a row takes one read per port instead of
+ * one per column.
+ */
+
+#if defined(readPort) && !defined(MATRIX_READ_PINS_INDIVIDUALLY)
+#    define MATRIX_READ_PORTS
+#endif
+
+#ifdef MATRIX_READ_PORTS
+
+typedef struct {
+    port_data_t mask;   // mask for the pins of the run, once shifted down
+    uint8_t     port;   // index into matrix_ports_t.ports
+    uint8_t     pad;    // first pin of the run, within its port
+    uint8_t     bit;    // first bit of the run, in the result
+    uint8_t     count;  // number of pins in the run
+} matrix_ports_run_t;
+
+typedef struct {
+    pin_port_t         ports[MATRIX_COLS];
+    matrix_ports_run_t runs[MATRIX_COLS];
+    uint8_t            port_count;
+    uint8_t            run_count;
+} matrix_ports_t;
+
+// Groups up to MATRIX_COLS pins. NO_PIN entries are skipped, and read as high.
+void matrix_ports_init(matrix_ports_t *ports, const pin_t *pins, uint8_t count);
+// Returns the pins that are low, with bit n set for pins[n]
+matrix_row_t matrix_ports_read_low(const matrix_ports_t *ports);
+
+#endif
@@ -16,9 +16,11 @@
 
 #include "print.h"
 #include "process_combo.h"
+#include "deferred_exec.h"
 
 #ifndef COMBO_VARIABLE_LEN
 __attribute__((weak)) combo_t key_combos[COMBO_COUNT] = {};
+#    define COMBO_LEN COMBO_COUNT
 #else
 extern combo_t  key_combos[];
 extern int      COMBO_LEN;
@@ -26,18 +28,50 @@ extern int      COMBO_LEN;
 
 __attribute__((weak)) void process_combo_event(uint16_t combo_index, bool pressed) {}
 
-static uint16_t timer               = 0;
+#ifdef COMBO_TERM_PER_COMBO
+__attribute__((weak)) uint16_t get_combo_term(uint16_t index, combo_t *combo) { return COMBO_TERM; }
+#    define COMBO_TERM_OF(index) get_combo_term(index, &key_combos[index])
+#else
+#    define COMBO_TERM_OF(index) COMBO_TERM
+#endif
+
+#define COMBO_NONE UINT16_MAX
+
+// Keys of combos that fired, until they are released. A combo that doesn't fit isn't fired.
+#ifndef COMBO_HELD_KEYS
+#    define COMBO_HELD_KEYS (MAX_COMBO_LENGTH * 2)
+#endif
+
+typedef struct {
+    keyrecord_t record;
+    uint16_t    keycode;
+    uint16_t    time;
+} combo_buffered_key_t;
+
+typedef struct {
+    keypos_t key;
+    uint16_t combo;
+} combo_held_key_t;
+
 static uint16_t current_combo_index = 0;
-static bool     drop_buffer         = false;
-static bool     is_active           = false;
 static bool     b_combo_enable      = true;  // defaults to enabled
 
-static uint8_t buffer_size = 0;
-#ifdef COMBO_ALLOW_ACTION_KEYS
-static keyrecord_t key_buffer[MAX_COMBO_LENGTH];
-#else
-static uint16_t key_buffer[MAX_COMBO_LENGTH];
-#endif
+/* Combo keys are buffered until it is clear which combo, if any, they make up.
+ * The first match_size keys are the ones the current match is made of, the
+ * others are yet to be looked at again after an earlier combo was resolved.
+ */
+static combo_buffered_key_t buffer[MAX_COMBO_LENGTH];
+static uint8_t              buffer_size = 0;
+static uint8_t              match_size  = 0;
+// Longest combo that the start of the match completed, and how many keys it took
+static uint16_t best_combo  = COMBO_NONE;
+static uint8_t  best_length = 0;
+// Time since the first buffered key at which the next candidate combo times out
+static uint16_t       next_timeout = 0;
+static deferred_token combo_token  = INVALID_DEFERRED_TOKEN;
+
+static combo_held_key_t held_keys[COMBO_HELD_KEYS];
+static uint8_t          held_count = 0;
 
 static inline void send_combo(uint16_t action, bool pressed) {
     if (action) {
@@ -51,81 +85,294 @@ static inline void send_combo(uint16_t action, bool pressed) {
     }
 }
 
-static inline void dump_key_buffer(bool emit) {
-    if (buffer_size == 0) {
-        return;
-    }
+#ifdef COMBO_INDEX_SIZE
+/* Reverse index from keycode to the combos it is part of, sorted by keycode
+ * and then by combo. It is built from the combo definitions on the first key
+ * event, so that only the combos that contain a key are looked at, instead
+ * of walking the keys of every combo in flash.
+ */
+typedef struct {
+    uint16_t keycode;
+    uint16_t combo;
+    uint8_t  count;
+} combo_index_entry_t;
+
+static combo_index_entry_t combo_index[COMBO_INDEX_SIZE];
+static uint16_t            combo_index_size  = 0;
+static bool                combo_index_built = false;
+// Set when the combos don't fit in the index, in which case they are scanned instead
+static bool combo_index_overflow = false;
+
+static inline bool combo_index_less(const combo_index_entry_t *a, const combo_index_entry_t *b) { return a->keycode < b->keycode || (a->keycode == b->keycode && a->combo < b->combo); }
+
+static void combo_index_build(void) {
+    combo_index_built = true;
+    combo_index_size  = 0;
+    for (uint16_t i = 0; i < COMBO_LEN; i++) {
+        uint16_t first = combo_index_size;
+        uint8_t  count = 0;
+        for (const uint16_t *keys = key_combos[i].keys;; ++count) {
+            uint16_t key = pgm_read_word(&keys[count]);
+            if (COMBO_END == key) break;
+
+            // A key that appears twice in a combo is only indexed once
+            bool indexed = false;
+            for (uint16_t j = first; j < combo_index_size; j++) {
+                indexed |= combo_index[j].keycode == key;
+            }
+            if (indexed) continue;
 
-    if (emit) {
-        for (uint8_t i = 0; i < buffer_size; i++) {
-#ifdef COMBO_ALLOW_ACTION_KEYS
-            const action_t action = store_or_get_action(key_buffer[i].event.pressed, key_buffer[i].event.key);
-            process_action(&(key_buffer[i]), action);
-#else
-            register_code16(key_buffer[i]);
-            send_keyboard_report();
-#endif
+            if (combo_index_size == COMBO_INDEX_SIZE) {
+                dprintf("combo: index is too small, increase COMBO_INDEX_SIZE\n");
+                combo_index_overflow = true;
+                return;
+            }
+            combo_index[combo_index_size].keycode = key;
+            combo_index[combo_index_size].combo   = i;
+            combo_index_size++;
+        }
+        for (uint16_t j = first; j < combo_index_size; j++) {
+            combo_index[j].count = count;
         }
     }
 
-    buffer_size = 0;
+    // Shell sort, which is small and doesn't need any extra memory
+    for (uint16_t gap = combo_index_size / 2; gap > 0; gap /= 2) {
+        for (uint16_t i = gap; i < combo_index_size; i++) {
+            combo_index_entry_t entry = combo_index[i];
+            uint16_t            j     = i;
+            for (; j >= gap && combo_index_less(&entry, &combo_index[j - gap]); j -= gap) {
+                combo_index[j] = combo_index[j - gap];
+            }
+            combo_index[j] = entry;
+        }
+    }
 }
+#endif
 
-#define ALL_COMBO_KEYS_ARE_DOWN (((1 << count) - 1) == combo->state)
-#define KEY_STATE_DOWN(key)         \
-    do {                            \
-        combo->state |= (1 << key); \
-    } while (0)
-#define KEY_STATE_UP(key)            \
-    do {                             \
-        combo->state &= ~(1 << key); \
-    } while (0)
+// Iterates over the combos that contain a keycode, in the order they are defined
+typedef struct {
+    uint16_t keycode;
+    uint16_t cursor;
+    uint16_t combo;
+    uint8_t  count;  // number of keys in the combo
+} combo_search_t;
+
+static void combo_search_start(combo_search_t *search, uint16_t keycode) {
+    search->keycode = keycode;
+    search->cursor  = 0;
+#ifdef COMBO_INDEX_SIZE
+    if (!combo_index_built) {
+        combo_index_build();
+    }
+    if (!combo_index_overflow) {
+        // Find the first entry for the keycode
+        uint16_t high = combo_index_size;
+        while (search->cursor < high) {
+            uint16_t middle = search->cursor + (high - search->cursor) / 2;
+            if (combo_index[middle].keycode < keycode) {
+                search->cursor = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+    }
+#endif
+}
 
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) {
-    uint8_t  count = 0;
-    uint16_t index = -1;
-    /* Find index of keycode and number of combo keys */
-    for (const uint16_t *keys = combo->keys;; ++count) {
-        uint16_t key = pgm_read_word(&keys[count]);
-        if (keycode == key) index = count;
-        if (COMBO_END == key) break;
+static bool combo_search_next(combo_search_t *search) {
+#ifdef COMBO_INDEX_SIZE
+    if (!combo_index_overflow) {
+        if (search->cursor >= combo_index_size || combo_index[search->cursor].keycode != search->keycode) {
+            return false;
+        }
+        search->combo = combo_index[search->cursor].combo;
+        search->count = combo_index[search->cursor].count;
+        search->cursor++;
+        return true;
+    }
+#endif
+    while (search->cursor < COMBO_LEN) {
+        uint16_t index = search->cursor++;
+        uint8_t  count = 0;
+        bool     found = false;
+        for (const uint16_t *keys = key_combos[index].keys;; ++count) {
+            uint16_t key = pgm_read_word(&keys[count]);
+            if (COMBO_END == key) break;
+            if (search->keycode == key) found = true;
+        }
+        if (found) {
+            search->combo = index;
+            search->count = count;
+            return true;
+        }
     }
+    return false;
+}
 
-    /* Continue processing if not a combo key */
-    if (-1 == (int8_t)index) return false;
+static bool combo_has_key(uint16_t index, uint16_t keycode) {
+    for (const uint16_t *keys = key_combos[index].keys;; ++keys) {
+        uint16_t key = pgm_read_word(keys);
+        if (COMBO_END == key) return false;
+        if (keycode == key) return true;
+    }
+}
 
-    bool is_combo_active = is_active;
+static bool is_combo_key(uint16_t keycode) {
+    combo_search_t search;
+    combo_search_start(&search, keycode);
+    return combo_search_next(&search);
+}
 
-    if (record->event.pressed) {
-        KEY_STATE_DOWN(index);
+/* Looks at the combos that contain all keys of the current match and haven't
+ * timed out yet. Remembers the longest one the match completes, and returns
+ * whether a longer one could still be completed by the keys that follow.
+ */
+static bool combo_evaluate(void) {
+    uint16_t elapsed = timer_elapsed(buffer[0].time);
+    bool     pending = false;
+    next_timeout     = UINT16_MAX;
+
+    combo_search_t search;
+    combo_search_start(&search, buffer[0].keycode);
+    while (combo_search_next(&search)) {
+        if (search.count < match_size) continue;
+
+        uint16_t term = COMBO_TERM_OF(search.combo);
+        if (elapsed >= term) continue;
+
+        bool matches = true;
+        for (uint8_t i = 1; i < match_size && matches; i++) {
+            matches = combo_has_key(search.combo, buffer[i].keycode);
+        }
+        if (!matches) continue;
 
-        if (is_combo_active) {
-            if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was pressed */
-                send_combo(combo->keycode, true);
-                drop_buffer = true;
+        if (search.count == match_size) {
+            // Ties go to the combo that is defined first
+            if (match_size > best_length) {
+                best_combo  = search.combo;
+                best_length = match_size;
             }
-        }
-    } else {
-        if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was released */
-            send_combo(combo->keycode, false);
         } else {
-            /* continue processing without immediately returning */
-            is_combo_active = false;
+            pending = true;
+            if (term < next_timeout) {
+                next_timeout = term;
+            }
         }
+    }
+    return pending;
+}
 
-        KEY_STATE_UP(index);
+static void combo_send_key(combo_buffered_key_t *key) {
+#ifdef COMBO_ALLOW_ACTION_KEYS
+    const action_t action = store_or_get_action(key->record.event.pressed, key->record.event.key);
+    process_action(&key->record, action);
+#else
+    register_code16(key->keycode);
+#endif
+}
+
+static void combo_fire(uint16_t index, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++) {
+        held_keys[held_count].key   = buffer[i].record.event.key;
+        held_keys[held_count].combo = index;
+        held_count++;
     }
+    // Non-zero while the combo is held
+    key_combos[index].state = 1;
+    current_combo_index     = index;
+    send_combo(key_combos[index].keycode, true);
+}
 
-    return is_combo_active;
+/* Fires the best combo the match completed, or sends its first key on its own
+ * if there is none, or if too many combos are held to keep track of its keys.
+ * The keys that weren't used are looked at again.
+ */
+static void combo_resolve(void) {
+    uint8_t used = 1;
+    if (best_combo != COMBO_NONE && held_count + best_length <= COMBO_HELD_KEYS) {
+        combo_fire(best_combo, best_length);
+        used = best_length;
+    } else {
+        combo_send_key(&buffer[0]);
+    }
+
+    buffer_size -= used;
+    for (uint8_t i = 0; i < buffer_size; i++) {
+        buffer[i] = buffer[i + used];
+    }
+    match_size  = buffer_size > 0 ? 1 : 0;
+    best_combo  = COMBO_NONE;
+    best_length = 0;
 }
 
-#define NO_COMBO_KEYS_ARE_DOWN (0 == combo->state)
+static uint32_t combo_timeout(uint32_t trigger_time, void *cb_arg);
 
-bool process_combo(uint16_t keycode, keyrecord_t *record) {
-    bool is_combo_key          = false;
-    drop_buffer                = false;
-    bool no_combo_keys_pressed = true;
+// Makes combo_timeout() run when the first of the combos that are still pending times out
+static void combo_schedule(void) {
+    if (buffer_size == 0) {
+        cancel_deferred_exec(combo_token);
+        combo_token = INVALID_DEFERRED_TOKEN;
+        return;
+    }
+    uint16_t delay = next_timeout - timer_elapsed(buffer[0].time);
+    if (!extend_deferred_exec(combo_token, delay)) {
+        combo_token = defer_exec_reserved(delay, combo_timeout, NULL);
+    }
+}
+
+// Resolves the buffered keys as far as possible. Unless flushing, waits for a longer combo to be completed.
+static void combo_update(bool flush) {
+    while (match_size > 0) {
+        if (combo_evaluate()) {
+            if (match_size < buffer_size) {
+                match_size++;
+                continue;
+            }
+            if (!flush) {
+                break;
+            }
+        }
+        combo_resolve();
+    }
+    combo_schedule();
+}
+
+static uint32_t combo_timeout(uint32_t trigger_time, void *cb_arg) {
+    // Rescheduled or cancelled by combo_update()
+    combo_update(false);
+    return 0;
+}
+
+// Releases the combo the key fired, if any. Returns true if the key was part of a combo.
+static bool combo_release(keypos_t key) {
+    for (uint8_t i = 0; i < held_count; i++) {
+        if (!KEYEQ(held_keys[i].key, key)) continue;
+
+        uint16_t index = held_keys[i].combo;
+        held_count--;
+        for (; i < held_count; i++) {
+            held_keys[i] = held_keys[i + 1];
+        }
+        // The combo is released along with the first of its keys
+        if (key_combos[index].state) {
+            key_combos[index].state = 0;
+            current_combo_index     = index;
+            send_combo(key_combos[index].keycode, false);
+        }
+        return true;
+    }
+    return false;
+}
 
+static bool combo_is_buffered(keypos_t key) {
+    for (uint8_t i = 0; i < buffer_size; i++) {
+        if (KEYEQ(buffer[i].record.event.key, key)) return true;
+    }
+    return false;
+}
+
+bool process_combo(uint16_t keycode, keyrecord_t *record) {
     if (keycode == CMB_ON && record->event.pressed) {
         combo_enable();
         return true;
@@ -141,65 +388,49 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
         return true;
     }
 
+    if (!record->event.pressed) {
+        if (combo_is_buffered(record->event.key)) {
+            // Released before it was clear what the key is part of, which decides it
+            combo_update(true);
+        }
+        return !combo_release(record->event.key);
+    }
+
     if (!is_combo_enabled()) {
         return true;
     }
-#ifndef COMBO_VARIABLE_LEN
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-#else
-    for (current_combo_index = 0; current_combo_index < COMBO_LEN; ++current_combo_index) {
-#endif
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-        no_combo_keys_pressed = no_combo_keys_pressed && NO_COMBO_KEYS_ARE_DOWN;
-    }
-
-    if (drop_buffer) {
-        /* buffer is only dropped when we complete a combo, so we refresh the timer
-         * here */
-        timer = timer_read();
-        dump_key_buffer(false);
-    } else if (!is_combo_key) {
-        /* if no combos claim the key we need to emit the keybuffer */
-        dump_key_buffer(true);
-
-        // reset state if there are no combo keys pressed at all
-        if (no_combo_keys_pressed) {
-            timer     = 0;
-            is_active = true;
-        }
-    } else if (record->event.pressed && is_active) {
-        /* otherwise the key is consumed and placed in the buffer */
-        timer = timer_read();
 
-        if (buffer_size < MAX_COMBO_LENGTH) {
-#ifdef COMBO_ALLOW_ACTION_KEYS
-            key_buffer[buffer_size++] = *record;
-#else
-            key_buffer[buffer_size++] = keycode;
-#endif
-        }
+    if (!is_combo_key(keycode)) {
+        // Whatever was buffered so far is sent before the key
+        combo_update(true);
+        return true;
     }
 
-    return !is_combo_key;
-}
-
-void matrix_scan_combo(void) {
-    if (b_combo_enable && is_active && timer && timer_elapsed(timer) > COMBO_TERM) {
-        /* This disables the combo, meaning key events for this
-         * combo will be handled by the next processors in the chain
-         */
-        is_active = false;
-        dump_key_buffer(true);
+    if (buffer_size == MAX_COMBO_LENGTH) {
+        combo_update(true);
+    }
+    buffer[buffer_size].record  = *record;
+    buffer[buffer_size].keycode = keycode;
+    buffer[buffer_size].time    = timer_read();
+    buffer_size++;
+    if (match_size == 0) {
+        match_size = 1;
     }
+    combo_update(false);
+    return false;
 }
 
 void combo_enable(void) { b_combo_enable = true; }
 
 void combo_disable(void) {
-    b_combo_enable = is_active = false;
-    timer                      = 0;
-    dump_key_buffer(true);
+    b_combo_enable = false;
+    for (uint8_t i = 0; i < buffer_size; i++) {
+        combo_send_key(&buffer[i]);
+    }
+    buffer_size = match_size = 0;
+    best_combo               = COMBO_NONE;
+    best_length              = 0;
+    combo_schedule();
 }
 
 void combo_toggle(void) {
@@ -31,6 +31,7 @@
 typedef struct {
     const uint16_t *keys;
     uint16_t        keycode;
+    // Non-zero while the combo is held down
 #ifdef EXTRA_EXTRA_LONG_COMBOS
     uint32_t state;
 #elif EXTRA_LONG_COMBOS
@@ -54,8 +55,10 @@ typedef struct {
 #endif
 
 bool process_combo(uint16_t keycode, keyrecord_t *record);
-void matrix_scan_combo(void);
 void process_combo_event(uint16_t combo_index, bool pressed);
+#ifdef COMBO_TERM_PER_COMBO
+uint16_t get_combo_term(uint16_t index, combo_t *combo);
+#endif
 
 void combo_enable(void);
 void combo_disable(void);
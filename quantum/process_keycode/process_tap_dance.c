@@ -14,13 +14,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "quantum.h"
+#include "deferred_exec.h"
 
 #ifndef NO_ACTION_ONESHOT
 uint8_t get_oneshot_mods(void);
 #endif
 
-static uint16_t last_td;
-static int8_t   highest_td = -1;
+static uint16_t       last_td;
+static int8_t         highest_td      = -1;
+static deferred_token tap_dance_token = INVALID_DEFERRED_TOKEN;
 
 void qk_tap_dance_pair_on_each_tap(qk_tap_dance_state_t *state, void *user_data) {
     qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
@@ -121,6 +123,28 @@ void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
     }
 }
 
+static uint16_t get_tap_dance_term(qk_tap_dance_action_t *action) {
+    if (action->custom_tapping_term > 0) {
+        return action->custom_tapping_term;
+    }
+#ifdef TAPPING_TERM_PER_KEY
+    return get_tapping_term(action->state.keycode, NULL);
+#else
+    return TAPPING_TERM;
+#endif
+}
+
+static uint32_t tap_dance_timeout(uint32_t trigger_time, void *cb_arg) {
+    qk_tap_dance_action_t *action = (qk_tap_dance_action_t *)cb_arg;
+
+    tap_dance_token = INVALID_DEFERRED_TOKEN;
+    if (action->state.count) {
+        process_tap_dance_action_on_dance_finished(action);
+        reset_tap_dance(&action->state);
+    }
+    return 0;
+}
+
 bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
     uint16_t               idx = keycode - QK_TAP_DANCE;
     qk_tap_dance_action_t *action;
@@ -144,6 +168,10 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
                 action->state.weak_mods |= get_weak_mods();
                 process_tap_dance_action_on_each_tap(action);
 
+                // Any other dance has been finished by preprocess_tap_dance(), only the last one can time out
+                cancel_deferred_exec(tap_dance_token);
+                tap_dance_token = defer_exec_reserved(get_tap_dance_term(action) + 1, tap_dance_timeout, action);
+
                 last_td = keycode;
             } else {
                 if (action->state.count && action->state.finished) {
@@ -157,28 +185,6 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
     return true;
 }
 
-void matrix_scan_tap_dance() {
-    if (highest_td == -1) return;
-    uint16_t tap_user_defined;
-
-    for (uint8_t i = 0; i <= highest_td; i++) {
-        qk_tap_dance_action_t *action = &tap_dance_actions[i];
-        if (action->custom_tapping_term > 0) {
-            tap_user_defined = action->custom_tapping_term;
-        } else {
-#ifdef TAPPING_TERM_PER_KEY
-            tap_user_defined = get_tapping_term(action->state.keycode, NULL);
-#else
-            tap_user_defined = TAPPING_TERM;
-#endif
-        }
-        if (action->state.count && timer_elapsed(action->state.timer) > tap_user_defined) {
-            process_tap_dance_action_on_dance_finished(action);
-            reset_tap_dance(&action->state);
-        }
-    }
-}
-
 void reset_tap_dance(qk_tap_dance_state_t *state) {
     qk_tap_dance_action_t *action;
 
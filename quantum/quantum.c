@@ -45,6 +45,10 @@
 #    include "haptic.h"
 #endif
 
+#ifdef EEPROM_DEFERRED_ENABLE
+#    include "eeprom_deferred.h"
+#endif
+
 #ifdef AUDIO_ENABLE
 #    ifndef GOODBYE_SONG
 #        define GOODBYE_SONG SONG(GOODBYE_SOUND)
@@ -143,6 +147,9 @@ void reset_keyboard(void) {
 #endif
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
+#endif
+#ifdef EEPROM_DEFERRED_ENABLE
+    eeprom_deferred_flush();
 #endif
     bootloader_jump();
 }
@@ -647,14 +654,6 @@ void matrix_scan_quantum() {
     matrix_scan_sequencer();
 #endif
 
-#ifdef TAP_DANCE_ENABLE
-    matrix_scan_tap_dance();
-#endif
-
-#ifdef COMBO_ENABLE
-    matrix_scan_combo();
-#endif
-
 #ifdef LED_MATRIX_ENABLE
     led_matrix_task();
 #endif
@@ -675,10 +674,6 @@ void matrix_scan_quantum() {
     dip_switch_read(false);
 #endif
 
-#ifdef AUTO_SHIFT_ENABLE
-    autoshift_matrix_scan();
-#endif
-
     matrix_scan_kb();
 }
 
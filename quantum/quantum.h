@@ -213,6 +213,14 @@ typedef uint8_t pin_t;
 
 #    define togglePin(pin) (PORTx_ADDRESS(pin) ^= _BV((pin)&0xF))
 
+// Whole port access, for reading several pins at once
+typedef uint8_t pin_port_t;
+typedef uint8_t port_data_t;
+
+#    define getPinPort(pin) ((pin_port_t)((pin) >> PORT_SHIFTER))
+#    define getPinPad(pin) ((pin)&0xF)
+#    define readPort(port) _SFR_IO8(ADDRESS_BASE + (port))
+
 #elif defined(PROTOCOL_CHIBIOS)
 typedef ioline_t pin_t;
 
@@ -228,6 +236,14 @@ typedef ioline_t pin_t;
 #    define readPin(pin) palReadLine(pin)
 
 #    define togglePin(pin) palToggleLine(pin)
+
+// Whole port access, for reading several pins at once
+typedef ioportid_t   pin_port_t;
+typedef ioportmask_t port_data_t;
+
+#    define getPinPort(pin) PAL_PORT(pin)
+#    define getPinPad(pin) PAL_PAD(pin)
+#    define readPort(port) palReadPort(port)
 #endif
 
 // Atomic macro to help make GPIO and other controls atomic.
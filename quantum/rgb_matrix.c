@@ -20,6 +20,7 @@
 #include "progmem.h"
 #include "config.h"
 #include "eeprom.h"
+#include "eeprom_deferred.h"
 #include <string.h>
 #include <math.h>
 
@@ -31,11 +32,66 @@ const point_t k_rgb_matrix_center = {112, 32};
 const point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
-__attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv); }
+static RGB rgb_matrix_hsv_to_rgb_default(HSV hsv) { return hsv_to_rgb(hsv); }
+
+__attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return rgb_matrix_hsv_to_rgb_default(hsv); }
+
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+#ifdef RGB_MATRIX_HSV_TO_RGB_BATCH
+    // Skips rgb_matrix_hsv_to_rgb(), so only for keyboards that don't override it
+    hsv_to_rgb_batch(hsv, rgb, count);
+#else
+    for (uint8_t i = 0; i < count; i++) {
+        rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+    }
+#endif
+}
+
+// The distance and angle of each LED from the center only depend on the LED
+// layout, so by default they are worked out once at init instead of on every
+// frame. Opt-in on AVR, where the two bytes per LED of RAM are scarcer.
+#if !defined(RGB_MATRIX_GEOMETRY_CACHE) && !defined(__AVR__)
+#    define RGB_MATRIX_GEOMETRY_CACHE
+#endif
+
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+static uint8_t rgb_matrix_led_dist[DRIVER_LED_TOTAL];
+static uint8_t rgb_matrix_led_angle[DRIVER_LED_TOTAL];
+#endif
+
+static inline uint8_t rgb_matrix_dist(uint8_t i, int16_t dx, int16_t dy) {
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+    return rgb_matrix_led_dist[i];
+#else
+    return sqrt16(dx * dx + dy * dy);
+#endif
+}
+
+static inline uint8_t rgb_matrix_angle(uint8_t i, int16_t dx, int16_t dy) {
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+    return rgb_matrix_led_angle[i];
+#else
+    return atan2_8(dy, dx);
+#endif
+}
+
+void rgb_matrix_update_geometry(void) {
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx              = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy              = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        rgb_matrix_led_dist[i]  = sqrt16(dx * dx + dy * dy);
+        rgb_matrix_led_angle[i] = atan2_8(dy, dx);
+    }
+#endif
+}
 
 // Generic effect runners
+#include "rgb_matrix_runners/effect_runner_batch.h"
 #include "rgb_matrix_runners/effect_runner_dx_dy_dist.h"
 #include "rgb_matrix_runners/effect_runner_dx_dy.h"
+#include "rgb_matrix_runners/effect_runner_polar.h"
+#include "rgb_matrix_runners/effect_runner_angle.h"
 #include "rgb_matrix_runners/effect_runner_i.h"
 #include "rgb_matrix_runners/effect_runner_sin_cos_i.h"
 #include "rgb_matrix_runners/effect_runner_reactive.h"
@@ -143,9 +199,9 @@ static uint32_t rgb_timer_buffer;
 static last_hit_t last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
-void eeconfig_read_rgb_matrix(void) { eeprom_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+void eeconfig_read_rgb_matrix(void) { eeprom_deferred_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
-void eeconfig_update_rgb_matrix(void) { eeprom_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+void eeconfig_update_rgb_matrix(void) { eeprom_deferred_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
 void eeconfig_update_rgb_matrix_default(void) {
     dprintf("eeconfig_update_rgb_matrix_default\n");
@@ -450,6 +506,7 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min,
 
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
+    rgb_matrix_update_geometry();
 
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
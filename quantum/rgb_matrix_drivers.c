@@ -146,8 +146,17 @@ LED_TYPE rgb_matrix_ws2812_array[DRIVER_LED_TOTAL];
 static void init(void) {}
 
 static void flush(void) {
+#    ifdef WS2812_ASYNC
+    // Frames are rendered continuously, so rather than queueing up a frame
+    // behind one that is still being sent, leave it to the next flush.
+    if (ws2812_frame_in_flight()) {
+        return;
+    }
+    ws2812_setleds_async(rgb_matrix_ws2812_array, DRIVER_LED_TOTAL);
+#    else
     // Assumes use of RGB_DI_PIN
     ws2812_setleds(rgb_matrix_ws2812_array, DRIVER_LED_TOTAL);
+#    endif
 }
 
 // Set an led in the buffer to a color
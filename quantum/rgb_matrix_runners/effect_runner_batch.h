@@ -0,0 +1,30 @@
+#pragma once
+
+// LEDs are collected into batches, so that their colors can be converted to
+// RGB in one go rather than one at a time.
+#ifndef RGB_MATRIX_BATCH_SIZE
+#    define RGB_MATRIX_BATCH_SIZE 16
+#endif
+
+typedef struct {
+    uint8_t count;
+    uint8_t index[RGB_MATRIX_BATCH_SIZE];
+    HSV     hsv[RGB_MATRIX_BATCH_SIZE];
+} rgb_matrix_batch_t;
+
+static void rgb_matrix_batch_flush(rgb_matrix_batch_t* batch) {
+    RGB rgb[RGB_MATRIX_BATCH_SIZE];
+    rgb_matrix_hsv_to_rgb_batch(batch->hsv, rgb, batch->count);
+    for (uint8_t i = 0; i < batch->count; i++) {
+        rgb_matrix_set_color(batch->index[i], rgb[i].r, rgb[i].g, rgb[i].b);
+    }
+    batch->count = 0;
+}
+
+static inline void rgb_matrix_batch_add(rgb_matrix_batch_t* batch, uint8_t index, HSV hsv) {
+    batch->index[batch->count] = index;
+    batch->hsv[batch->count]   = hsv;
+    if (++batch->count == RGB_MATRIX_BATCH_SIZE) {
+        rgb_matrix_batch_flush(batch);
+    }
+}
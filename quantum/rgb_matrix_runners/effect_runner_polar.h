@@ -0,0 +1,20 @@
+#pragma once
+
+typedef HSV (*polar_f)(HSV hsv, uint8_t angle, uint8_t dist, uint8_t time);
+
+bool effect_runner_polar(effect_params_t* params, polar_f effect_func) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    rgb_matrix_batch_t batch = {.count = 0};
+    uint8_t            time  = scale16by8(g_rgb_timer, rgb_matrix_config.speed / 2);
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        int16_t dx    = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy    = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        uint8_t angle = rgb_matrix_angle(i, dx, dy);
+        uint8_t dist  = rgb_matrix_dist(i, dx, dy);
+        rgb_matrix_batch_add(&batch, i, effect_func(rgb_matrix_config.hsv, angle, dist, time));
+    }
+    rgb_matrix_batch_flush(&batch);
+    return led_max < DRIVER_LED_TOTAL;
+}
@@ -22,6 +22,7 @@
 #endif
 #ifdef EEPROM_ENABLE
 #    include "eeprom.h"
+#    include "eeprom_deferred.h"
 #endif
 #ifdef STM32_EEPROM_ENABLE
 #    include <hal.h>
@@ -158,7 +159,9 @@ void rgblight_check_config(void) {
 
 uint32_t eeconfig_read_rgblight(void) {
 #ifdef EEPROM_ENABLE
-    return eeprom_read_dword(EECONFIG_RGBLIGHT);
+    uint32_t val;
+    eeprom_deferred_read_block(&val, EECONFIG_RGBLIGHT, sizeof(val));
+    return val;
 #else
     return 0;
 #endif
@@ -167,7 +170,7 @@ uint32_t eeconfig_read_rgblight(void) {
 void eeconfig_update_rgblight(uint32_t val) {
 #ifdef EEPROM_ENABLE
     rgblight_check_config();
-    eeprom_update_dword(EECONFIG_RGBLIGHT, val);
+    eeprom_deferred_update_block(&val, EECONFIG_RGBLIGHT, sizeof(val));
 #endif
 }
 
@@ -26,8 +26,12 @@ SOFTWARE.
 
 #include <stdint.h>
 
-#define MAX_FRAME_SIZE 1024
-#define NUM_LINKS 2
+#ifndef MAX_FRAME_SIZE
+#    define MAX_FRAME_SIZE 1024
+#endif
+#ifndef NUM_LINKS
+#    define NUM_LINKS 2
+#endif
 
 void init_byte_stuffer(void);
 void byte_stuffer_recv_byte(uint8_t link, uint8_t data);
@@ -20,9 +20,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include "debounce.h"
 #include "quantum.h"
+#include "matrix_ports.h"
 #include "split_util.h"
 #include "config.h"
 #include "transport.h"
+#include "split_telemetry.h"
 
 #define ERROR_DISCONNECT_COUNT 5
 
@@ -103,11 +105,18 @@ static void unselect_rows(void) {
     }
 }
 
+#        ifdef MATRIX_READ_PORTS
+static matrix_ports_t col_ports;
+#        endif
+
 static void init_pins(void) {
     unselect_rows();
     for (uint8_t x = 0; x < MATRIX_COLS; x++) {
         setPinInputHigh_atomic(col_pins[x]);
     }
+#        ifdef MATRIX_READ_PORTS
+    matrix_ports_init(&col_ports, col_pins, MATRIX_COLS);
+#        endif
 }
 
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
@@ -118,6 +127,10 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     select_row(current_row);
     matrix_io_delay();
 
+#        ifdef MATRIX_READ_PORTS
+    // Read all cols at once, one port at a time (active low)
+    current_row_value = matrix_ports_read_low(&col_ports);
+#        else
     // For each col...
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
         // Select the col pin to read (active low)
@@ -126,6 +139,7 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
         // Populate the matrix row with the state of the col pin
         current_row_value |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
     }
+#        endif
 
     // Unselect row
     unselect_row(current_row);
@@ -249,8 +263,23 @@ void matrix_post_scan(void) {
     if (is_keyboard_master()) {
         static uint8_t error_count;
 
-        if (!transport_master(matrix + thatHand)) {
-            error_count++;
+#ifdef SPLIT_TELEMETRY_ENABLE
+        uint32_t start   = timer_read_us();
+        bool     success = transport_master(matrix + thatHand);
+        split_telemetry_scan(success, timer_elapsed_us(start));
+        split_telemetry_task();
+#else
+        bool success = transport_master(matrix + thatHand);
+#endif
+
+        if (!success) {
+            // The count stops once disconnected, so that a long disconnect is only counted once
+            if (error_count <= ERROR_DISCONNECT_COUNT) {
+                error_count++;
+                if (error_count > ERROR_DISCONNECT_COUNT) {
+                    split_telemetry_disconnect();
+                }
+            }
 
             if (error_count > ERROR_DISCONNECT_COUNT) {
                 // reset other half if disconnected
@@ -273,6 +302,10 @@ void matrix_post_scan(void) {
 uint8_t matrix_scan(void) {
     bool changed = false;
 
+#ifdef KEYEVENT_TIME_US
+    matrix_scan_timestamp();
+#endif
+
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
     // Set row, read cols
     for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
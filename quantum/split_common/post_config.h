@@ -1,3 +1,8 @@
+// The built in shared state is synced through the shared-state registry
+#if (defined(SPLIT_LAYER_STATE_ENABLE) || defined(SPLIT_MODS_ENABLE) || defined(SPLIT_LED_STATE_ENABLE)) && !defined(SPLIT_SHARED_STATE_ENABLE)
+#    error "SPLIT_LAYER_STATE_ENABLE, SPLIT_MODS_ENABLE and SPLIT_LED_STATE_ENABLE need SPLIT_SHARED_STATE_ENABLE = yes in rules.mk"
+#endif
+
 #if defined(USE_I2C)
 // When using I2C, using rgblight implicitly involves split support.
 #    if defined(RGBLIGHT_ENABLE) && !defined(RGBLIGHT_SPLIT)
@@ -8,6 +13,11 @@
 #        define F_SCL 100000UL  // SCL frequency
 #    endif
 
+// The shared-state packets don't fit in the default slave registers
+#    if defined(SPLIT_SHARED_STATE_ENABLE) && !defined(I2C_SLAVE_REG_COUNT)
+#        define I2C_SLAVE_REG_COUNT 96
+#    endif
+
 #else  // use serial
 // When using serial, the user must define RGBLIGHT_SPLIT explicitly
 //  in config.h as needed.
@@ -16,4 +26,26 @@
 // When using serial and RGBLIGHT_SPLIT need separate transaction
 #        define SERIAL_USE_MULTI_TRANSACTION
 #    endif
+// The changed rows of a delta frame are fetched in a separate transaction
+#    if defined(SPLIT_TRANSPORT_DELTA) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
+// So is the payload of a shared-state packet
+#    if defined(SPLIT_SHARED_STATE_ENABLE) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
+// Transactions are counted by their index
+#    if defined(SPLIT_TELEMETRY_ENABLE) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
+
+#    if defined(SERIAL_DRIVER_USART_DUPLEX)
+// Transactions are answered a scan late, which delta frames can't cope with
+#        ifdef SPLIT_TRANSPORT_DELTA
+#            error "SPLIT_TRANSPORT_DELTA is not supported by the usart_duplex serial driver"
+#        endif
+// A frame holds the transaction id, at most 255 bytes of data and a checksum
+#        define MAX_FRAME_SIZE 257
+#        define NUM_LINKS 1
+#    endif
 #endif
@@ -0,0 +1,186 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "split_delta.h"
+#include "split_crc.h"
+
+#define FRAME_SEQUENCE 0
+#define FRAME_CRC 1
+#define FRAME_BITMAP 2
+
+static void pack_row(matrix_row_t row, uint8_t *data) {
+    for (uint8_t i = 0; i < SPLIT_DELTA_ROW_SIZE; i++) {
+        data[i] = (uint8_t)(row >> (i * 8));
+    }
+}
+
+static matrix_row_t unpack_row(const uint8_t *data) {
+    matrix_row_t row = 0;
+    for (uint8_t i = 0; i < SPLIT_DELTA_ROW_SIZE; i++) {
+        row |= (matrix_row_t)data[i] << (i * 8);
+    }
+    return row;
+}
+
+static inline bool bitmap_get(const uint8_t *bitmap, uint8_t row) { return bitmap[row / 8] & (1 << (row % 8)); }
+
+// CRC of the frame without its CRC byte, followed by the matrix it results in
+static uint8_t frame_crc(const uint8_t frame[], uint8_t length, const matrix_row_t matrix[]) {
+    uint8_t crc = split_crc8(0xFF, &frame[FRAME_SEQUENCE], 1);
+    crc         = split_crc8(crc, &frame[FRAME_BITMAP], length - FRAME_BITMAP);
+    for (uint8_t row = 0; row < SPLIT_DELTA_ROWS; row++) {
+        uint8_t packed[SPLIT_DELTA_ROW_SIZE];
+        pack_row(matrix[row], packed);
+        crc = split_crc8(crc, packed, SPLIT_DELTA_ROW_SIZE);
+    }
+    return crc;
+}
+
+static split_delta_stats_t stats;
+
+/* Slave side */
+
+static matrix_row_t reference[SPLIT_DELTA_ROWS];
+static matrix_row_t pending[SPLIT_DELTA_ROWS];
+static bool         reference_valid;
+static bool         pending_changes;
+// Starts at 1, so that an acknowledgement register that reads 0 after a reset doesn't commit the first frame
+static uint8_t sequence;
+
+void split_delta_encoder_init(void) {
+    reference_valid = false;
+    pending_changes = false;
+    sequence        = 1;
+}
+
+bool split_delta_encode(const matrix_row_t matrix[], uint8_t frame[]) {
+    uint8_t before[SPLIT_DELTA_FRAME_MAX_SIZE];
+    uint8_t length = SPLIT_DELTA_HEADER_SIZE;
+
+    memcpy(before, frame, SPLIT_DELTA_FRAME_MAX_SIZE);
+    memset(frame, 0, SPLIT_DELTA_HEADER_SIZE);
+    frame[FRAME_SEQUENCE] = sequence;
+    for (uint8_t row = 0; row < SPLIT_DELTA_ROWS; row++) {
+        pending[row] = matrix[row];
+        if (!reference_valid || matrix[row] != reference[row]) {
+            frame[FRAME_BITMAP + row / 8] |= 1 << (row % 8);
+            pack_row(matrix[row], &frame[length]);
+            length += SPLIT_DELTA_ROW_SIZE;
+        }
+    }
+    frame[FRAME_CRC] = frame_crc(frame, length, matrix);
+    pending_changes  = length > SPLIT_DELTA_HEADER_SIZE;
+
+    return memcmp(before, frame, length) != 0;
+}
+
+uint8_t split_delta_sequence(void) { return sequence; }
+
+bool split_delta_has_changes(void) { return pending_changes; }
+
+void split_delta_commit(void) {
+    if (!pending_changes) {
+        return;
+    }
+    memcpy(reference, pending, sizeof(reference));
+    reference_valid = true;
+    pending_changes = false;
+    sequence++;
+}
+
+void split_delta_request_full(void) { reference_valid = false; }
+
+/* Master side */
+
+// The state frames with the expected sequence number are relative to, and the one before it
+static matrix_row_t current[SPLIT_DELTA_ROWS];
+static matrix_row_t previous[SPLIT_DELTA_ROWS];
+static uint8_t      expected;
+static uint8_t      ack;
+static bool         synced;
+
+void split_delta_decoder_init(void) {
+    synced = false;
+    ack    = 0;
+}
+
+uint8_t split_delta_body_size(const uint8_t header[]) {
+    uint8_t rows = 0;
+    for (uint8_t row = 0; row < SPLIT_DELTA_ROWS; row++) {
+        rows += bitmap_get(&header[FRAME_BITMAP], row);
+    }
+    return rows * SPLIT_DELTA_ROW_SIZE;
+}
+
+bool split_delta_decode(const uint8_t frame[], uint8_t length, matrix_row_t matrix[]) {
+    if (length < SPLIT_DELTA_HEADER_SIZE || length != SPLIT_DELTA_HEADER_SIZE + split_delta_body_size(frame)) {
+        goto error;
+    }
+
+    bool    full     = length == SPLIT_DELTA_FRAME_MAX_SIZE;
+    uint8_t sequence = frame[FRAME_SEQUENCE];
+
+    // A frame that was sent again, maybe with different contents, before the slave moved on
+    bool resent = synced && sequence == (uint8_t)(expected - 1);
+    if (!full && !(synced && (sequence == expected || resent))) {
+        goto error;
+    }
+
+    matrix_row_t result[SPLIT_DELTA_ROWS];
+    memcpy(result, resent ? previous : current, sizeof(result));
+    const uint8_t *data = &frame[SPLIT_DELTA_HEADER_SIZE];
+    for (uint8_t row = 0; row < SPLIT_DELTA_ROWS; row++) {
+        if (bitmap_get(&frame[FRAME_BITMAP], row)) {
+            result[row] = unpack_row(data);
+            data += SPLIT_DELTA_ROW_SIZE;
+        }
+    }
+    if (frame_crc(frame, length, result) != frame[FRAME_CRC]) {
+        goto error;
+    }
+
+    if (length > SPLIT_DELTA_HEADER_SIZE && !resent) {
+        // The slave moves on once it knows this frame was received, until then
+        // it can send it again relative to the same state
+        memcpy(previous, current, sizeof(previous));
+        expected = sequence + 1;
+    }
+    if (length > SPLIT_DELTA_HEADER_SIZE) {
+        ack = sequence;
+    }
+    memcpy(current, result, sizeof(current));
+    memcpy(matrix, result, sizeof(result));
+    synced = true;
+
+    stats.frames++;
+    if (full) {
+        stats.full++;
+    }
+    return true;
+
+error:
+    synced = false;
+    stats.errors++;
+    return false;
+}
+
+bool split_delta_resync_pending(void) { return !synced; }
+
+uint8_t split_delta_ack(void) { return ack; }
+
+const split_delta_stats_t *split_delta_get_stats(void) { return &stats; }
@@ -0,0 +1,80 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+/*
+ * Delta-encoded matrix frames for the split transport.
+ *
+ * The slave only sends the rows that changed since the last frame the master
+ * received, so that an idle half costs a few bytes per scan:
+ *
+ *   [sequence] [CRC8] [bitmap of the rows that follow] [changed rows...]
+ *
+ * Rows are packed into as many bytes as MATRIX_COLS needs. The CRC covers the
+ * frame and the whole matrix that results from it, so that the master notices
+ * any frame that doesn't apply to what it has, and asks for a full frame.
+ *
+ * Every frame with the same sequence number is relative to the same reference
+ * state. The slave moves on to the next sequence number once it knows that the
+ * master received a frame with changes, see split_delta_commit().
+ */
+
+#define SPLIT_DELTA_ROWS (MATRIX_ROWS / 2)
+#define SPLIT_DELTA_ROW_SIZE ((MATRIX_COLS + 7) / 8)
+#define SPLIT_DELTA_BITMAP_SIZE ((SPLIT_DELTA_ROWS + 7) / 8)
+#define SPLIT_DELTA_HEADER_SIZE (2 + SPLIT_DELTA_BITMAP_SIZE)
+#define SPLIT_DELTA_BODY_MAX_SIZE (SPLIT_DELTA_ROWS * SPLIT_DELTA_ROW_SIZE)
+#define SPLIT_DELTA_FRAME_MAX_SIZE (SPLIT_DELTA_HEADER_SIZE + SPLIT_DELTA_BODY_MAX_SIZE)
+
+typedef struct {
+    uint32_t frames;  // frames accepted
+    uint32_t full;    // of which full frames
+    uint32_t errors;  // frames rejected, each of them makes the master ask for a full frame
+} split_delta_stats_t;
+
+/* Slave side */
+
+void split_delta_encoder_init(void);
+// Encodes the matrix into frame, relative to the reference state. Returns true
+// if the frame is different from the one encoded before.
+bool    split_delta_encode(const matrix_row_t matrix[], uint8_t frame[]);
+uint8_t split_delta_sequence(void);
+// Whether the last frame encoded has any rows in it
+bool split_delta_has_changes(void);
+// The master has received the last frame encoded, it becomes the reference state
+void split_delta_commit(void);
+// The master asked for a full frame
+void split_delta_request_full(void);
+
+/* Master side */
+
+void split_delta_decoder_init(void);
+// Number of bytes that follow the header
+uint8_t split_delta_body_size(const uint8_t header[]);
+// Updates matrix from a complete frame. Returns false, and leaves matrix as it
+// was, if the frame can't be applied.
+bool split_delta_decode(const uint8_t frame[], uint8_t length, matrix_row_t matrix[]);
+// Whether the master is waiting for a full frame
+bool split_delta_resync_pending(void);
+// Sequence number of the last frame with changes the master accepted
+uint8_t split_delta_ack(void);
+
+const split_delta_stats_t *split_delta_get_stats(void);
@@ -0,0 +1,344 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "split_shared.h"
+#include "split_crc.h"
+
+#ifdef SPLIT_LAYER_STATE_ENABLE
+#    include "action_layer.h"
+#endif
+#ifdef SPLIT_MODS_ENABLE
+#    include "action_util.h"
+#endif
+#ifdef SPLIT_LED_STATE_ENABLE
+#    include "host.h"
+#endif
+
+#if SPLIT_SHARED_PAYLOAD_SIZE > 255
+#    error "SPLIT_SHARED_PAYLOAD_SIZE must be 255 or less."
+#endif
+
+#define HEADER_SEQUENCE 0
+#define HEADER_ACK 1
+#define HEADER_LENGTH 2
+#define HEADER_SESSION 3
+#define HEADER_PEER_SESSION 4
+#define HEADER_PAYLOAD_CHECKSUM 5
+#define HEADER_CHECKSUM 6
+
+// Each chunk is the id of the blob, the offset of the chunk in it and its length, followed by the data
+#define CHUNK_HEADER_SIZE 3
+
+typedef struct {
+    uint8_t *                data;
+    uint8_t                  size;
+    split_shared_direction_t direction;
+    uint8_t                  priority;
+    split_shared_callback_t  received;
+    bool                     dirty;
+    bool                     changed;    // marked dirty again while a chunk of it was on its way
+    uint8_t                  offset;     // how much of it the other half has acknowledged
+    uint8_t                  in_flight;  // end of the chunk in the unacknowledged packet, 0 if there's none
+} split_shared_entry_t;
+
+static split_shared_entry_t     entries[SPLIT_SHARED_MAX_ENTRIES];
+static uint8_t                  entry_count = 0;
+static split_shared_direction_t sending;
+
+// The last packet prepared, sent again until the other half acknowledges it
+static uint8_t packet[SPLIT_SHARED_PACKET_SIZE];
+static bool    acknowledged      = true;
+static uint8_t received_sequence = 0;
+
+// Sequence numbers only mean something within a session, which starts over whenever either half does.
+// 0 until the other half has been heard from, then one it hasn't seen this half use before.
+static uint8_t session      = 0;
+static uint8_t peer_session = 0;
+
+// The header has a checksum of its own, so that it's still taken in when the payload wasn't exchanged
+static uint8_t header_checksum(const uint8_t packet[]) { return split_crc8(0xFF, packet, HEADER_CHECKSUM); }
+
+static uint8_t payload_checksum(const uint8_t packet[]) { return split_crc8(0xFF, &packet[SPLIT_SHARED_HEADER_SIZE], packet[HEADER_LENGTH]); }
+
+split_shared_id_t split_shared_register(void *data, uint8_t size, split_shared_direction_t direction, uint8_t priority, split_shared_callback_t received) {
+    if (entry_count == SPLIT_SHARED_MAX_ENTRIES || size == 0) {
+        return SPLIT_SHARED_INVALID_ID;
+    }
+
+    split_shared_entry_t *entry = &entries[entry_count];
+    memset(entry, 0, sizeof(*entry));
+    entry->data      = (uint8_t *)data;
+    entry->size      = size;
+    entry->direction = direction;
+    entry->priority  = priority;
+    entry->received  = received;
+    return entry_count++;
+}
+
+void split_shared_mark_dirty(split_shared_id_t id) {
+    if (id < 0 || id >= entry_count) {
+        return;
+    }
+
+    split_shared_entry_t *entry = &entries[id];
+    if (entry->in_flight) {
+        entry->changed = true;
+    } else {
+        // Start over, in case only part of it had been sent
+        entry->offset = 0;
+    }
+    entry->dirty = true;
+}
+
+#ifdef SPLIT_LAYER_STATE_ENABLE
+static layer_state_t     shared_layer_state[2];
+static split_shared_id_t layer_state_id;
+
+static void layer_state_received(const void *data, uint8_t size) {
+    layer_state         = shared_layer_state[0];
+    default_layer_state = shared_layer_state[1];
+}
+#endif
+
+#ifdef SPLIT_MODS_ENABLE
+static uint8_t           shared_mods[3];
+static split_shared_id_t mods_id;
+
+static void mods_received(const void *data, uint8_t size) {
+    set_mods(shared_mods[0]);
+    set_weak_mods(shared_mods[1]);
+#    ifndef NO_ACTION_ONESHOT
+    set_oneshot_mods(shared_mods[2]);
+#    endif
+}
+#endif
+
+#ifdef SPLIT_LED_STATE_ENABLE
+static uint8_t           shared_led_state;
+static split_shared_id_t led_state_id;
+
+uint8_t split_shared_led_state(void) { return shared_led_state; }
+#endif
+
+// Marks the built in blobs as dirty when the master's state has changed
+static void split_shared_update(void) {
+    if (sending != SPLIT_SHARED_TO_SLAVE) {
+        return;
+    }
+#ifdef SPLIT_LAYER_STATE_ENABLE
+    if (shared_layer_state[0] != layer_state || shared_layer_state[1] != default_layer_state) {
+        shared_layer_state[0] = layer_state;
+        shared_layer_state[1] = default_layer_state;
+        split_shared_mark_dirty(layer_state_id);
+    }
+#endif
+#ifdef SPLIT_MODS_ENABLE
+#    ifndef NO_ACTION_ONESHOT
+    uint8_t oneshot_mods = get_oneshot_mods();
+#    else
+    uint8_t oneshot_mods = 0;
+#    endif
+    if (shared_mods[0] != get_mods() || shared_mods[1] != get_weak_mods() || shared_mods[2] != oneshot_mods) {
+        shared_mods[0] = get_mods();
+        shared_mods[1] = get_weak_mods();
+        shared_mods[2] = oneshot_mods;
+        split_shared_mark_dirty(mods_id);
+    }
+#endif
+#ifdef SPLIT_LED_STATE_ENABLE
+    if (shared_led_state != host_keyboard_leds()) {
+        shared_led_state = host_keyboard_leds();
+        split_shared_mark_dirty(led_state_id);
+    }
+#endif
+}
+
+void split_shared_init(bool master) {
+    sending           = master ? SPLIT_SHARED_TO_SLAVE : SPLIT_SHARED_TO_MASTER;
+    entry_count       = 0;
+    acknowledged      = true;
+    received_sequence = 0;
+    session           = 0;
+    peer_session      = 0;
+    memset(packet, 0, sizeof(packet));
+
+#ifdef SPLIT_LAYER_STATE_ENABLE
+    layer_state_id = split_shared_register(shared_layer_state, sizeof(shared_layer_state), SPLIT_SHARED_TO_SLAVE, 2, layer_state_received);
+#endif
+#ifdef SPLIT_MODS_ENABLE
+    mods_id = split_shared_register(shared_mods, sizeof(shared_mods), SPLIT_SHARED_TO_SLAVE, 2, mods_received);
+#endif
+#ifdef SPLIT_LED_STATE_ENABLE
+    led_state_id = split_shared_register(&shared_led_state, sizeof(shared_led_state), SPLIT_SHARED_TO_SLAVE, 1, NULL);
+#endif
+}
+
+bool split_shared_pending(void) {
+    if (!acknowledged) {
+        return true;
+    }
+    for (uint8_t i = 0; i < entry_count; i++) {
+        if (entries[i].direction == sending && entries[i].dirty) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The dirty blob to send next: highest priority first, then in the order they were registered
+static split_shared_entry_t *split_shared_next(void) {
+    split_shared_entry_t *next = NULL;
+    for (uint8_t i = 0; i < entry_count; i++) {
+        split_shared_entry_t *entry = &entries[i];
+        if (entry->direction == sending && entry->dirty && !entry->in_flight && (next == NULL || entry->priority > next->priority)) {
+            next = entry;
+        }
+    }
+    return next;
+}
+
+static void split_shared_build(void) {
+    uint8_t *payload = &packet[SPLIT_SHARED_HEADER_SIZE];
+    uint8_t  length  = 0;
+
+    split_shared_entry_t *entry;
+    while (SPLIT_SHARED_PAYLOAD_SIZE - length > CHUNK_HEADER_SIZE && (entry = split_shared_next()) != NULL) {
+        uint8_t chunk = entry->size - entry->offset;
+        if (chunk > SPLIT_SHARED_PAYLOAD_SIZE - length - CHUNK_HEADER_SIZE) {
+            chunk = SPLIT_SHARED_PAYLOAD_SIZE - length - CHUNK_HEADER_SIZE;
+        }
+        payload[length++] = entry - entries;
+        payload[length++] = entry->offset;
+        payload[length++] = chunk;
+        memcpy(&payload[length], &entry->data[entry->offset], chunk);
+        length += chunk;
+        entry->in_flight = entry->offset + chunk;
+    }
+
+    if (length > 0) {
+        // 0 is never used, so that nothing is taken for an acknowledgement before the first packet
+        packet[HEADER_SEQUENCE] = packet[HEADER_SEQUENCE] == 255 ? 1 : packet[HEADER_SEQUENCE] + 1;
+        acknowledged            = false;
+    }
+    packet[HEADER_LENGTH]           = length;
+    packet[HEADER_PAYLOAD_CHECKSUM] = payload_checksum(packet);
+}
+
+uint8_t split_shared_packet_size(const uint8_t packet[]) {
+    uint8_t length = packet[HEADER_LENGTH];
+    return SPLIT_SHARED_HEADER_SIZE + (length > SPLIT_SHARED_PAYLOAD_SIZE ? SPLIT_SHARED_PAYLOAD_SIZE : length);
+}
+
+void split_shared_prepare(uint8_t out[]) {
+    split_shared_update();
+    if (acknowledged && session != 0) {
+        split_shared_build();
+    }
+    packet[HEADER_ACK]          = received_sequence;
+    packet[HEADER_SESSION]      = session;
+    packet[HEADER_PEER_SESSION] = peer_session;
+    packet[HEADER_CHECKSUM]     = header_checksum(packet);
+    memcpy(out, packet, split_shared_packet_size(packet));
+}
+
+static void split_shared_acknowledged(void) {
+    acknowledged = true;
+    for (uint8_t i = 0; i < entry_count; i++) {
+        split_shared_entry_t *entry = &entries[i];
+        if (!entry->in_flight) {
+            continue;
+        }
+        entry->offset    = entry->in_flight;
+        entry->in_flight = 0;
+        if (entry->changed) {
+            entry->changed = false;
+            entry->offset  = 0;
+        } else if (entry->offset == entry->size) {
+            entry->dirty  = false;
+            entry->offset = 0;
+        }
+    }
+}
+
+// The other half has (re)started: nothing in flight will be acknowledged, and it has none of our blobs
+static void split_shared_restart(void) {
+    acknowledged      = true;
+    received_sequence = 0;
+    for (uint8_t i = 0; i < entry_count; i++) {
+        split_shared_entry_t *entry = &entries[i];
+        entry->dirty                = entry->direction == sending;
+        entry->changed              = false;
+        entry->offset               = 0;
+        entry->in_flight            = 0;
+    }
+}
+
+void split_shared_receive(const uint8_t in[]) {
+    uint8_t length = in[HEADER_LENGTH];
+    if (length > SPLIT_SHARED_PAYLOAD_SIZE || header_checksum(in) != in[HEADER_CHECKSUM]) {
+        return;
+    }
+
+    if (session == 0) {
+        session = in[HEADER_PEER_SESSION] == 255 ? 1 : in[HEADER_PEER_SESSION] + 1;
+    }
+    if (in[HEADER_SESSION] != peer_session) {
+        peer_session = in[HEADER_SESSION];
+        split_shared_restart();
+    }
+    // Anything else was sent before the other half knew about this session
+    if (in[HEADER_PEER_SESSION] != session) {
+        return;
+    }
+
+    if (!acknowledged && in[HEADER_ACK] == packet[HEADER_SEQUENCE]) {
+        split_shared_acknowledged();
+    }
+
+    // A payload that wasn't exchanged, or was corrupted, is sent again until it's acknowledged
+    if (length == 0 || in[HEADER_SEQUENCE] == received_sequence || payload_checksum(in) != in[HEADER_PAYLOAD_CHECKSUM]) {
+        return;
+    }
+    received_sequence = in[HEADER_SEQUENCE];
+
+    const uint8_t *payload = &in[SPLIT_SHARED_HEADER_SIZE];
+    for (uint8_t i = 0; i + CHUNK_HEADER_SIZE <= length;) {
+        uint8_t id     = payload[i];
+        uint8_t offset = payload[i + 1];
+        uint8_t chunk  = payload[i + 2];
+        i += CHUNK_HEADER_SIZE;
+        if (id >= entry_count || entries[id].direction == sending || offset + chunk > entries[id].size || i + chunk > length) {
+            // Both halves have to register the same blobs, in the same order
+            return;
+        }
+
+        split_shared_entry_t *entry = &entries[id];
+        memcpy(&entry->data[offset], &payload[i], chunk);
+        i += chunk;
+        if (offset + chunk == entry->size && entry->received) {
+            entry->received(entry->data, entry->size);
+        }
+    }
+}
+
+bool split_shared_payload_needed(const uint8_t peer_header[]) {
+    bool current = peer_header[HEADER_PEER_SESSION] == session;
+    bool own     = !acknowledged && !(current && peer_header[HEADER_ACK] == packet[HEADER_SEQUENCE]);
+    bool peer    = current && peer_header[HEADER_LENGTH] > 0 && (peer_header[HEADER_SESSION] != peer_session || peer_header[HEADER_SEQUENCE] != received_sequence);
+    return own || peer;
+}
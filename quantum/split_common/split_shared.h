@@ -0,0 +1,90 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * State shared between the halves of a split keyboard.
+ *
+ * Modules register blobs of data on both halves, in the same order, with the
+ * direction they are synced in. The transport initialises the registry along
+ * with itself, so blobs are registered from keyboard_post_init_*() onwards.
+ * The sending half marks a blob as dirty when it changes, and it is sent to
+ * the other half on the following scans, into the blob registered there.
+ *
+ * Each scan, a packet header is sent alongside the matrix in each direction,
+ * followed by a payload of at most SPLIT_SHARED_PAYLOAD_SIZE bytes only when
+ * there is something to send. Dirty blobs are packed into it highest priority first, and blobs that
+ * don't fit are sent in chunks over several scans. A packet is sent again
+ * until the other half has acknowledged it. Each half also sends its session,
+ * and echoes the other half's: when either half restarts, the sequence numbers
+ * start over and every blob is sent again.
+ */
+
+#ifndef SPLIT_SHARED_MAX_ENTRIES
+#    define SPLIT_SHARED_MAX_ENTRIES 8
+#endif
+
+#ifndef SPLIT_SHARED_PAYLOAD_SIZE
+#    define SPLIT_SHARED_PAYLOAD_SIZE 16
+#endif
+
+#define SPLIT_SHARED_HEADER_SIZE 7
+#define SPLIT_SHARED_PACKET_SIZE (SPLIT_SHARED_HEADER_SIZE + SPLIT_SHARED_PAYLOAD_SIZE)
+
+typedef enum {
+    SPLIT_SHARED_TO_SLAVE,
+    SPLIT_SHARED_TO_MASTER,
+} split_shared_direction_t;
+
+// Called on the receiving half, once the whole blob has been received
+typedef void (*split_shared_callback_t)(const void *data, uint8_t size);
+
+typedef int8_t split_shared_id_t;
+
+#define SPLIT_SHARED_INVALID_ID (-1)
+
+void split_shared_init(bool master);
+
+split_shared_id_t split_shared_register(void *data, uint8_t size, split_shared_direction_t direction, uint8_t priority, split_shared_callback_t received);
+void              split_shared_mark_dirty(split_shared_id_t id);
+// Whether any blob is still waiting to be sent, or acknowledged
+bool split_shared_pending(void);
+
+/*
+ * Transport interface.
+ *
+ * Every scan, the transport receives the packet from the other half and
+ * prepares the next one. The header is small enough to go along with the
+ * matrix, the payload only has to be exchanged when split_shared_payload_needed().
+ * The packet is still received when it wasn't, its header and payload are
+ * checked separately.
+ */
+
+void split_shared_receive(const uint8_t packet[]);
+void split_shared_prepare(uint8_t packet[]);
+// Size of the header and the payload that follows it
+uint8_t split_shared_packet_size(const uint8_t packet[]);
+// Whether either half has a payload the other one hasn't received yet, given the other half's header
+bool split_shared_payload_needed(const uint8_t peer_header[]);
+
+#ifdef SPLIT_LED_STATE_ENABLE
+// The host's LED state, as received by the slave
+uint8_t split_shared_led_state(void);
+#endif
@@ -0,0 +1,140 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "split_telemetry.h"
+#include "print.h"
+#include "timer.h"
+
+// Period of the console report, in milliseconds, 0 to only print on request
+#ifndef SPLIT_TELEMETRY_PRINT_INTERVAL
+#    define SPLIT_TELEMETRY_PRINT_INTERVAL 0
+#endif
+
+static uint32_t counters[SPLIT_TELEMETRY_COUNT];
+static uint32_t rtt_total;
+static uint32_t rtt_samples;
+static uint8_t  failed_in_a_row;
+
+static void split_telemetry_count(split_telemetry_field_t field, uint32_t amount) {
+    // Saturate rather than wrap around, so that a long running keyboard doesn't report nonsense
+    counters[field] = counters[field] > UINT32_MAX - amount ? UINT32_MAX : counters[field] + amount;
+}
+
+void split_telemetry_transaction(split_telemetry_result_t result, uint16_t bytes_sent, uint16_t bytes_received) {
+    split_telemetry_count(SPLIT_TELEMETRY_TRANSACTIONS, 1);
+    split_telemetry_count(SPLIT_TELEMETRY_BYTES_SENT, bytes_sent);
+    if (result == SPLIT_TELEMETRY_OK) {
+        split_telemetry_count(SPLIT_TELEMETRY_BYTES_RECEIVED, bytes_received);
+    } else {
+        split_telemetry_count(result == SPLIT_TELEMETRY_TIMEOUT ? SPLIT_TELEMETRY_TIMEOUTS : SPLIT_TELEMETRY_ERRORS, 1);
+    }
+}
+
+void split_telemetry_error(void) { split_telemetry_count(SPLIT_TELEMETRY_ERRORS, 1); }
+
+void split_telemetry_scan(bool success, uint32_t rtt_us) {
+    split_telemetry_count(SPLIT_TELEMETRY_SCANS, 1);
+    if (!success) {
+        split_telemetry_count(SPLIT_TELEMETRY_FAILED_SCANS, 1);
+        if (failed_in_a_row < UINT8_MAX) {
+            failed_in_a_row++;
+        }
+    } else if (failed_in_a_row) {
+        split_telemetry_count(SPLIT_TELEMETRY_RETRIES, failed_in_a_row);
+        failed_in_a_row = 0;
+    }
+
+    if (rtt_us > counters[SPLIT_TELEMETRY_RTT_MAX]) {
+        counters[SPLIT_TELEMETRY_RTT_MAX] = rtt_us;
+    }
+    if (rtt_us > UINT32_MAX / 2) {
+        rtt_us = UINT32_MAX / 2;
+    }
+    // Halve the running total before it overflows, which favours recent scans
+    if (rtt_total > UINT32_MAX / 2 - rtt_us) {
+        rtt_total   = (rtt_total + 1) / 2;
+        rtt_samples = (rtt_samples + 1) / 2;
+    }
+    rtt_total += rtt_us;
+    rtt_samples++;
+
+    uint8_t  bucket = 0;
+    uint32_t limit  = SPLIT_TELEMETRY_RTT_BUCKET_US;
+    while (bucket < SPLIT_TELEMETRY_RTT_BUCKETS - 1 && rtt_us >= limit) {
+        bucket++;
+        limit *= 2;
+    }
+    split_telemetry_count(SPLIT_TELEMETRY_RTT_HISTOGRAM + bucket, 1);
+}
+
+void split_telemetry_disconnect(void) {
+    split_telemetry_count(SPLIT_TELEMETRY_DISCONNECTS, 1);
+    // Scans failed while disconnected aren't retries
+    failed_in_a_row = 0;
+}
+
+uint32_t split_telemetry_get(split_telemetry_field_t field) {
+    if (field == SPLIT_TELEMETRY_RTT_AVERAGE) {
+        return rtt_samples ? rtt_total / rtt_samples : 0;
+    }
+    return field < SPLIT_TELEMETRY_COUNT ? counters[field] : 0;
+}
+
+void split_telemetry_reset(void) {
+    memset(counters, 0, sizeof(counters));
+    rtt_total       = 0;
+    rtt_samples     = 0;
+    failed_in_a_row = 0;
+}
+
+void split_telemetry_print(void) {
+    xprintf("split: scans %lu failed %lu retries %lu disconnects %lu\n", (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_SCANS), (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_FAILED_SCANS), (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_RETRIES), (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_DISCONNECTS));
+    xprintf("split: transactions %lu timeouts %lu errors %lu sent %lu received %lu\n", (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_TRANSACTIONS), (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_TIMEOUTS), (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_ERRORS), (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_BYTES_SENT), (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_BYTES_RECEIVED));
+    xprintf("split: rtt max %luus average %luus\n", (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_RTT_MAX), (unsigned long)split_telemetry_get(SPLIT_TELEMETRY_RTT_AVERAGE));
+    uint32_t limit = SPLIT_TELEMETRY_RTT_BUCKET_US;
+    for (uint8_t bucket = 0; bucket < SPLIT_TELEMETRY_RTT_BUCKETS; bucket++, limit *= 2) {
+        if (bucket < SPLIT_TELEMETRY_RTT_BUCKETS - 1) {
+            xprintf("split: rtt < %luus: %lu\n", (unsigned long)limit, (unsigned long)counters[SPLIT_TELEMETRY_RTT_HISTOGRAM + bucket]);
+        } else {
+            xprintf("split: rtt >= %luus: %lu\n", (unsigned long)(limit / 2), (unsigned long)counters[SPLIT_TELEMETRY_RTT_HISTOGRAM + bucket]);
+        }
+    }
+}
+
+void split_telemetry_task(void) {
+#if SPLIT_TELEMETRY_PRINT_INTERVAL > 0
+    static uint32_t last_print = 0;
+    if (timer_elapsed32(last_print) >= SPLIT_TELEMETRY_PRINT_INTERVAL) {
+        last_print = timer_read32();
+        split_telemetry_print();
+    }
+#endif
+}
+
+uint8_t split_telemetry_pack(uint8_t page, uint8_t *data, uint8_t length) {
+    uint8_t per_page = length / 4;
+    uint8_t count    = 0;
+    for (uint16_t field = (uint16_t)page * per_page; field < SPLIT_TELEMETRY_COUNT && count < per_page; field++, count++) {
+        uint32_t value = split_telemetry_get((split_telemetry_field_t)field);
+        data[count * 4]     = (value >> 24) & 0xFF;
+        data[count * 4 + 1] = (value >> 16) & 0xFF;
+        data[count * 4 + 2] = (value >> 8) & 0xFF;
+        data[count * 4 + 3] = value & 0xFF;
+    }
+    return count;
+}
@@ -0,0 +1,87 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Split transport telemetry.
+ *
+ * Counts the outcome and size of every transaction between the halves, and
+ * how long transport_master() takes each scan, on the master. The counters
+ * can be printed on the console, read over raw HID (VIA), and reset, to tune
+ * the serial speed and cabling under real use.
+ */
+
+// Round trip times are counted in buckets that double in size, starting from this many microseconds
+#ifndef SPLIT_TELEMETRY_RTT_BUCKET_US
+#    define SPLIT_TELEMETRY_RTT_BUCKET_US 125
+#endif
+
+#define SPLIT_TELEMETRY_RTT_BUCKETS 8
+
+typedef enum {
+    SPLIT_TELEMETRY_OK,
+    SPLIT_TELEMETRY_TIMEOUT,  // no answer from the other half
+    SPLIT_TELEMETRY_ERROR,    // parity, checksum or bus error
+} split_telemetry_result_t;
+
+// Counters, in the order they are read over raw HID
+typedef enum {
+    SPLIT_TELEMETRY_SCANS,           // calls to transport_master()
+    SPLIT_TELEMETRY_FAILED_SCANS,    // of which returned false
+    SPLIT_TELEMETRY_RETRIES,         // failed scans that were recovered from on a later scan
+    SPLIT_TELEMETRY_DISCONNECTS,     // times the other half was considered disconnected
+    SPLIT_TELEMETRY_TRANSACTIONS,    // transfers on the wire
+    SPLIT_TELEMETRY_TIMEOUTS,        // of which timed out
+    SPLIT_TELEMETRY_ERRORS,          // of which failed otherwise, or failed their checksum
+    SPLIT_TELEMETRY_BYTES_SENT,      // to the slave
+    SPLIT_TELEMETRY_BYTES_RECEIVED,  // from the slave
+    SPLIT_TELEMETRY_RTT_MAX,         // longest scan, in microseconds
+    SPLIT_TELEMETRY_RTT_AVERAGE,     // in microseconds
+    SPLIT_TELEMETRY_RTT_HISTOGRAM,   // SPLIT_TELEMETRY_RTT_BUCKETS counters, the last one for everything longer
+    SPLIT_TELEMETRY_COUNT = SPLIT_TELEMETRY_RTT_HISTOGRAM + SPLIT_TELEMETRY_RTT_BUCKETS,
+} split_telemetry_field_t;
+
+#ifdef SPLIT_TELEMETRY_ENABLE
+
+// Called by the transport for every transfer
+void split_telemetry_transaction(split_telemetry_result_t result, uint16_t bytes_sent, uint16_t bytes_received);
+// Called by the transport when a frame that was received intact fails its checksum
+void split_telemetry_error(void);
+// Called once a scan, with whether transport_master() succeeded and how long it took
+void split_telemetry_scan(bool success, uint32_t rtt_us);
+void split_telemetry_disconnect(void);
+
+uint32_t split_telemetry_get(split_telemetry_field_t field);
+void     split_telemetry_reset(void);
+void     split_telemetry_print(void);
+void     split_telemetry_task(void);
+
+// Fills a raw HID report with page `page` of the counters, as 32 bit big endian values. Returns the number of counters written.
+uint8_t split_telemetry_pack(uint8_t page, uint8_t *data, uint8_t length);
+
+#else
+
+#    define split_telemetry_transaction(result, bytes_sent, bytes_received)
+#    define split_telemetry_error()
+#    define split_telemetry_scan(success, rtt_us)
+#    define split_telemetry_disconnect()
+#    define split_telemetry_task()
+
+#endif
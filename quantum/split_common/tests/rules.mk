@@ -0,0 +1,23 @@
+# 12 columns, so that rows are packed into two bytes
+split_delta_DEFS := -DMATRIX_ROWS=10 -DMATRIX_COLS=12
+split_delta_INC := $(QUANTUM_PATH)/split_common
+
+split_delta_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/split_delta_tests.cpp \
+	$(QUANTUM_PATH)/split_common/split_delta.c \
+	$(QUANTUM_PATH)/split_common/split_crc.c
+
+split_shared_INC := $(QUANTUM_PATH)/split_common
+
+# split_shared.c is included by the test itself, once for each half
+split_shared_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/split_shared_tests.cpp \
+	$(QUANTUM_PATH)/split_common/split_crc.c
+
+split_telemetry_DEFS := -DSPLIT_TELEMETRY_ENABLE -DNO_PRINT
+split_telemetry_INC := $(QUANTUM_PATH)/split_common $(TMK_PATH)/common
+
+split_telemetry_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/split_telemetry_tests.cpp \
+	$(QUANTUM_PATH)/split_common/split_telemetry.c \
+	$(TMK_PATH)/common/test/timer.c
@@ -0,0 +1,219 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "split_delta.h"
+}
+
+// One half talking to the other over a loopback, the same way the I2C transport does
+class SplitDelta : public testing::Test {
+   public:
+    matrix_row_t slave[SPLIT_DELTA_ROWS]  = {};
+    matrix_row_t master[SPLIT_DELTA_ROWS] = {};
+    // Registers on the slave
+    uint8_t frame[SPLIT_DELTA_FRAME_MAX_SIZE] = {};
+    uint8_t ack                               = 0;
+    uint8_t resync                            = 0;
+    uint8_t resync_sent                       = 0;
+    // Bytes transferred in either direction
+    unsigned bytes      = 0;
+    bool     corrupt    = false;
+    bool     ack_is_lost = false;
+
+    SplitDelta() {
+        split_delta_encoder_init();
+        split_delta_decoder_init();
+    }
+
+    void slave_scan() {
+        if (resync) {
+            split_delta_request_full();
+        } else if (split_delta_has_changes() && ack == split_delta_sequence()) {
+            split_delta_commit();
+        }
+        if (split_delta_encode(slave, frame)) {
+            ack = split_delta_sequence() - 1;
+        }
+    }
+
+    bool master_poll() {
+        uint8_t received[SPLIT_DELTA_FRAME_MAX_SIZE];
+        memcpy(received, frame, SPLIT_DELTA_HEADER_SIZE);
+        uint8_t body = split_delta_body_size(received);
+        memcpy(&received[SPLIT_DELTA_HEADER_SIZE], &frame[SPLIT_DELTA_HEADER_SIZE], body);
+        bytes += SPLIT_DELTA_HEADER_SIZE + body;
+        if (corrupt) {
+            received[SPLIT_DELTA_HEADER_SIZE + body - 1] ^= 0x10;
+            corrupt = false;
+        }
+
+        bool    accepted   = split_delta_decode(received, SPLIT_DELTA_HEADER_SIZE + body, master);
+        uint8_t control[2] = {split_delta_ack(), split_delta_resync_pending()};
+        if ((accepted && body > 0) || control[1] != resync_sent) {
+            bytes += sizeof(control);
+            resync_sent = control[1];
+            if (!ack_is_lost) {
+                ack = control[0];
+            }
+            resync = control[1];
+        }
+        return accepted;
+    }
+
+    bool scan() {
+        slave_scan();
+        return master_poll();
+    }
+
+    void expect_in_sync() {
+        for (uint8_t row = 0; row < SPLIT_DELTA_ROWS; row++) {
+            EXPECT_EQ(master[row], slave[row]) << "row " << (int)row;
+        }
+    }
+};
+
+TEST_F(SplitDelta, FirstFrameIsFull) {
+    slave[2] = 0x0801;
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(bytes, SPLIT_DELTA_FRAME_MAX_SIZE + 2);
+    expect_in_sync();
+}
+
+TEST_F(SplitDelta, IdleScansOnlySendTheHeader) {
+    scan();
+    bytes = 0;
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(bytes, 100 * SPLIT_DELTA_HEADER_SIZE);
+    expect_in_sync();
+}
+
+TEST_F(SplitDelta, OnlyChangedRowsAreSent) {
+    scan();
+    scan();
+    bytes    = 0;
+    slave[3] = 0x0400;
+    EXPECT_TRUE(scan());
+    // Header, one row of two bytes, and the acknowledgement
+    EXPECT_EQ(bytes, SPLIT_DELTA_HEADER_SIZE + 2 + 2);
+    expect_in_sync();
+
+    bytes = 0;
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(bytes, SPLIT_DELTA_HEADER_SIZE);
+    expect_in_sync();
+}
+
+TEST_F(SplitDelta, ColumnsBeyondEightArePacked) {
+    scan();
+    slave[0] = 0x0FFF;
+    slave[4] = 0x0800;
+    EXPECT_TRUE(scan());
+    expect_in_sync();
+}
+
+TEST_F(SplitDelta, CorruptedFrameIsFollowedByAFullFrame) {
+    scan();
+    const split_delta_stats_t *stats  = split_delta_get_stats();
+    uint32_t                   errors = stats->errors;
+    uint32_t                   full   = stats->full;
+
+    slave[1] = 0x0002;
+    corrupt  = true;
+    EXPECT_FALSE(scan());
+    EXPECT_EQ(master[1], 0);
+    EXPECT_TRUE(split_delta_resync_pending());
+    EXPECT_EQ(stats->errors, errors + 1);
+
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(stats->full, full + 1);
+    EXPECT_FALSE(split_delta_resync_pending());
+    expect_in_sync();
+}
+
+TEST_F(SplitDelta, FrameSentAgainBeforeTheAcknowledgement) {
+    scan();
+    ack_is_lost = true;
+    slave[0]    = 0x0001;
+    EXPECT_TRUE(scan());
+    expect_in_sync();
+
+    // Released again before the slave heard about the press, relative to the same state
+    slave[0] = 0;
+    slave[2] = 0x0100;
+    EXPECT_TRUE(scan());
+    expect_in_sync();
+
+    ack_is_lost = false;
+    EXPECT_TRUE(scan());
+    slave[2] = 0;
+    EXPECT_TRUE(scan());
+    expect_in_sync();
+    EXPECT_FALSE(split_delta_resync_pending());
+}
+
+TEST_F(SplitDelta, MissedFrameIsDetected) {
+    scan();
+    slave[1] = 0x0010;
+    slave_scan();
+    // The master never reads this one, but the slave moves on anyway
+    ack = split_delta_sequence();
+    slave[1] = 0x0030;
+    slave_scan();
+    slave[1] = 0x0010;
+    slave_scan();
+    EXPECT_FALSE(master_poll());
+
+    EXPECT_TRUE(scan());
+    expect_in_sync();
+}
+
+// Keys are pressed and released at a typing pace, with the master polling every scan
+TEST_F(SplitDelta, BytesPerScanWhileTyping) {
+    const unsigned scans          = 60000;  // one minute at 1kHz
+    const unsigned keystroke_time = 150;    // one key pressed every 150ms, about 80 WPM
+    const unsigned hold_time      = 90;
+
+    scan();
+    bytes             = 0;
+    uint32_t rng      = 12345;
+    uint8_t  row      = 0;
+    uint8_t  col      = 0;
+    for (unsigned i = 0; i < scans; i++) {
+        if (i % keystroke_time == 0) {
+            rng = rng * 1103515245 + 12345;
+            row = (rng >> 16) % SPLIT_DELTA_ROWS;
+            col = (rng >> 24) % MATRIX_COLS;
+            slave[row] |= (matrix_row_t)1 << col;
+        } else if (i % keystroke_time == hold_time) {
+            slave[row] &= ~((matrix_row_t)1 << col);
+        }
+        ASSERT_TRUE(scan());
+        expect_in_sync();
+    }
+
+    double per_scan = (double)bytes / scans;
+    double full     = sizeof(matrix_row_t) * SPLIT_DELTA_ROWS;
+    printf("split delta transport: %.2f bytes per scan, %.0f bytes per scan for the full matrix\n", per_scan, full);
+    EXPECT_LT(per_scan, SPLIT_DELTA_HEADER_SIZE + 0.1);
+    EXPECT_LT(per_scan, full / 2);
+}
@@ -0,0 +1,301 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <string.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "split_shared.h"
+#include "split_crc.h"
+}
+
+// Each half has its own registry, the same way the two MCUs do
+namespace master_side {
+#include "split_shared.c"
+}
+namespace slave_side {
+#include "split_shared.c"
+}
+
+static std::vector<int> received;
+
+static void received_a(const void *data, uint8_t size) { received.push_back(0); }
+static void received_b(const void *data, uint8_t size) { received.push_back(1); }
+
+// The halves talking to each other over a loopback, the same way the serial transport does
+class SplitShared : public testing::Test {
+   public:
+    // What each half has prepared, and what the other half has received of it
+    uint8_t m2s[SPLIT_SHARED_PACKET_SIZE]       = {};
+    uint8_t s2m[SPLIT_SHARED_PACKET_SIZE]       = {};
+    uint8_t slave_rx[SPLIT_SHARED_PACKET_SIZE]  = {};
+    uint8_t master_rx[SPLIT_SHARED_PACKET_SIZE] = {};
+    // Bytes transferred in either direction
+    unsigned bytes       = 0;
+    bool     corrupt_m2s = false;
+    bool     corrupt_s2m = false;
+
+    SplitShared() {
+        received.clear();
+        master_side::split_shared_init(true);
+        slave_side::split_shared_init(false);
+        master_side::split_shared_prepare(m2s);
+        slave_side::split_shared_prepare(s2m);
+    }
+
+    void scan() {
+        // The headers go along with the matrix
+        memcpy(slave_rx, m2s, SPLIT_SHARED_HEADER_SIZE);
+        memcpy(master_rx, s2m, SPLIT_SHARED_HEADER_SIZE);
+        bytes += 2 * SPLIT_SHARED_HEADER_SIZE;
+        if (master_side::split_shared_payload_needed(master_rx)) {
+            memcpy(&slave_rx[SPLIT_SHARED_HEADER_SIZE], &m2s[SPLIT_SHARED_HEADER_SIZE], SPLIT_SHARED_PAYLOAD_SIZE);
+            memcpy(&master_rx[SPLIT_SHARED_HEADER_SIZE], &s2m[SPLIT_SHARED_HEADER_SIZE], SPLIT_SHARED_PAYLOAD_SIZE);
+            bytes += 2 * SPLIT_SHARED_PAYLOAD_SIZE;
+        } else {
+            // Whatever was on the stack, as the transport doesn't read it
+            memset(&slave_rx[SPLIT_SHARED_HEADER_SIZE], 0xEE, SPLIT_SHARED_PAYLOAD_SIZE);
+            memset(&master_rx[SPLIT_SHARED_HEADER_SIZE], 0xEE, SPLIT_SHARED_PAYLOAD_SIZE);
+        }
+        if (corrupt_m2s) {
+            slave_rx[SPLIT_SHARED_PACKET_SIZE - 1] ^= 0x10;
+            slave_rx[SPLIT_SHARED_HEADER_SIZE] ^= 0x01;
+            corrupt_m2s = false;
+        }
+        if (corrupt_s2m) {
+            master_rx[SPLIT_SHARED_HEADER_SIZE - 1] ^= 0x10;
+            corrupt_s2m = false;
+        }
+
+        master_side::split_shared_receive(master_rx);
+        master_side::split_shared_prepare(m2s);
+
+        slave_side::split_shared_receive(slave_rx);
+        slave_side::split_shared_prepare(s2m);
+    }
+
+    void scan_until_synced(unsigned limit = 100) {
+        for (unsigned i = 0; i < limit && (master_side::split_shared_pending() || slave_side::split_shared_pending()); i++) {
+            scan();
+        }
+        EXPECT_FALSE(master_side::split_shared_pending());
+        EXPECT_FALSE(slave_side::split_shared_pending());
+    }
+};
+
+TEST_F(SplitShared, SyncsToTheSlave) {
+    uint32_t master_value = 0, slave_value = 0;
+    split_shared_id_t id = master_side::split_shared_register(&master_value, sizeof(master_value), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    EXPECT_EQ(slave_side::split_shared_register(&slave_value, sizeof(slave_value), SPLIT_SHARED_TO_SLAVE, 0, received_a), id);
+
+    master_value = 0x12345678;
+    master_side::split_shared_mark_dirty(id);
+    scan_until_synced();
+    EXPECT_EQ(slave_value, 0x12345678u);
+    EXPECT_EQ(received, std::vector<int>({0}));
+}
+
+TEST_F(SplitShared, SyncsToTheMaster) {
+    uint16_t master_value = 0, slave_value = 0;
+    split_shared_id_t id = master_side::split_shared_register(&master_value, sizeof(master_value), SPLIT_SHARED_TO_MASTER, 0, received_a);
+    slave_side::split_shared_register(&slave_value, sizeof(slave_value), SPLIT_SHARED_TO_MASTER, 0, NULL);
+
+    slave_value = 0xBEEF;
+    slave_side::split_shared_mark_dirty(id);
+    scan_until_synced();
+    EXPECT_EQ(master_value, 0xBEEF);
+    EXPECT_EQ(received, std::vector<int>({0}));
+}
+
+TEST_F(SplitShared, SyncsBothWaysAtOnce) {
+    uint8_t to_slave[2] = {}, to_master[2] = {};
+    uint8_t slave_copy[2] = {}, master_copy[2] = {};
+    split_shared_id_t down = master_side::split_shared_register(to_slave, sizeof(to_slave), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    split_shared_id_t up   = master_side::split_shared_register(master_copy, sizeof(master_copy), SPLIT_SHARED_TO_MASTER, 0, received_b);
+    slave_side::split_shared_register(slave_copy, sizeof(slave_copy), SPLIT_SHARED_TO_SLAVE, 0, received_a);
+    slave_side::split_shared_register(to_master, sizeof(to_master), SPLIT_SHARED_TO_MASTER, 0, NULL);
+
+    to_slave[1]  = 1;
+    to_master[0] = 2;
+    master_side::split_shared_mark_dirty(down);
+    slave_side::split_shared_mark_dirty(up);
+    scan_until_synced();
+    EXPECT_EQ(slave_copy[1], 1);
+    EXPECT_EQ(master_copy[0], 2);
+    EXPECT_EQ(received.size(), 2u);
+}
+
+TEST_F(SplitShared, SendsHigherPriorityFirst) {
+    // Each of them fills a whole packet
+    uint8_t low[SPLIT_SHARED_PAYLOAD_SIZE - 3] = {}, high[SPLIT_SHARED_PAYLOAD_SIZE - 3] = {};
+    uint8_t low_copy[sizeof(low)], high_copy[sizeof(high)];
+    split_shared_id_t low_id  = master_side::split_shared_register(low, sizeof(low), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    split_shared_id_t high_id = master_side::split_shared_register(high, sizeof(high), SPLIT_SHARED_TO_SLAVE, 5, NULL);
+    slave_side::split_shared_register(low_copy, sizeof(low_copy), SPLIT_SHARED_TO_SLAVE, 0, received_a);
+    slave_side::split_shared_register(high_copy, sizeof(high_copy), SPLIT_SHARED_TO_SLAVE, 5, received_b);
+
+    master_side::split_shared_mark_dirty(low_id);
+    master_side::split_shared_mark_dirty(high_id);
+    scan_until_synced();
+    EXPECT_EQ(received, std::vector<int>({1, 0}));
+}
+
+TEST_F(SplitShared, ChunksLargeBlobs) {
+    uint8_t blob[100], copy[100] = {};
+    for (uint8_t i = 0; i < sizeof(blob); i++) {
+        blob[i] = i * 7;
+    }
+    split_shared_id_t id = master_side::split_shared_register(blob, sizeof(blob), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    slave_side::split_shared_register(copy, sizeof(copy), SPLIT_SHARED_TO_SLAVE, 0, received_a);
+
+    master_side::split_shared_mark_dirty(id);
+    scan_until_synced(200);
+    EXPECT_EQ(memcmp(blob, copy, sizeof(blob)), 0);
+    // Only complete blobs are reported
+    EXPECT_EQ(received, std::vector<int>({0}));
+}
+
+TEST_F(SplitShared, RestartsBlobsChangedWhileBeingSent) {
+    uint8_t blob[100] = {}, copy[100] = {};
+    split_shared_id_t id = master_side::split_shared_register(blob, sizeof(blob), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    slave_side::split_shared_register(copy, sizeof(copy), SPLIT_SHARED_TO_SLAVE, 0, received_a);
+
+    master_side::split_shared_mark_dirty(id);
+    scan();
+    scan();
+    memset(blob, 0xAA, sizeof(blob));
+    master_side::split_shared_mark_dirty(id);
+    scan_until_synced(200);
+    EXPECT_EQ(memcmp(blob, copy, sizeof(blob)), 0);
+}
+
+TEST_F(SplitShared, IdleScansOnlySendHeaders) {
+    uint8_t value = 0, copy = 0;
+    split_shared_id_t id = master_side::split_shared_register(&value, sizeof(value), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    slave_side::split_shared_register(&copy, sizeof(copy), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    value = 1;
+    master_side::split_shared_mark_dirty(id);
+    scan_until_synced();
+
+    bytes = 0;
+    for (int i = 0; i < 100; i++) {
+        scan();
+    }
+    EXPECT_EQ(bytes, 100u * 2 * SPLIT_SHARED_HEADER_SIZE);
+}
+
+TEST_F(SplitShared, ResendsCorruptedPackets) {
+    uint32_t value = 0, copy = 0;
+    split_shared_id_t id = master_side::split_shared_register(&value, sizeof(value), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    slave_side::split_shared_register(&copy, sizeof(copy), SPLIT_SHARED_TO_SLAVE, 0, received_a);
+
+    value = 42;
+    master_side::split_shared_mark_dirty(id);
+    corrupt_m2s = true;
+    scan();
+    EXPECT_EQ(copy, 0u);
+    scan_until_synced();
+    EXPECT_EQ(copy, 42u);
+    EXPECT_EQ(received, std::vector<int>({0}));
+}
+
+TEST_F(SplitShared, IgnoresResentPacketsWhenTheAckIsLost) {
+    uint32_t value = 0, copy = 0;
+    split_shared_id_t id = master_side::split_shared_register(&value, sizeof(value), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    slave_side::split_shared_register(&copy, sizeof(copy), SPLIT_SHARED_TO_SLAVE, 0, received_a);
+
+    value = 42;
+    master_side::split_shared_mark_dirty(id);
+    // The packet is delivered during the first scan, its acknowledgement on the second one
+    scan();
+    corrupt_s2m = true;
+    scan();
+    EXPECT_TRUE(master_side::split_shared_pending());
+    scan_until_synced();
+    EXPECT_EQ(copy, 42u);
+    EXPECT_EQ(received, std::vector<int>({0}));
+}
+
+TEST_F(SplitShared, RejectsInvalidRegistrations) {
+    uint8_t value;
+    EXPECT_EQ(master_side::split_shared_register(&value, 0, SPLIT_SHARED_TO_SLAVE, 0, NULL), SPLIT_SHARED_INVALID_ID);
+    for (int i = 0; i < SPLIT_SHARED_MAX_ENTRIES; i++) {
+        EXPECT_EQ(master_side::split_shared_register(&value, sizeof(value), SPLIT_SHARED_TO_SLAVE, 0, NULL), i);
+    }
+    EXPECT_EQ(master_side::split_shared_register(&value, sizeof(value), SPLIT_SHARED_TO_SLAVE, 0, NULL), SPLIT_SHARED_INVALID_ID);
+    // Marking an invalid id does nothing
+    master_side::split_shared_mark_dirty(SPLIT_SHARED_INVALID_ID);
+    EXPECT_FALSE(master_side::split_shared_pending());
+}
+
+TEST_F(SplitShared, ResendsEverythingToARestartedSlave) {
+    uint32_t value = 0, copy = 0;
+    split_shared_id_t id = master_side::split_shared_register(&value, sizeof(value), SPLIT_SHARED_TO_SLAVE, 0, NULL);
+    slave_side::split_shared_register(&copy, sizeof(copy), SPLIT_SHARED_TO_SLAVE, 0, received_a);
+    value = 42;
+    master_side::split_shared_mark_dirty(id);
+    scan_until_synced();
+
+    // The slave resets, and loses what it had received
+    copy = 0;
+    received.clear();
+    slave_side::split_shared_init(false);
+    slave_side::split_shared_register(&copy, sizeof(copy), SPLIT_SHARED_TO_SLAVE, 0, received_a);
+    for (int i = 0; i < 10; i++) {
+        scan();
+    }
+    scan_until_synced();
+    EXPECT_EQ(copy, 42u);
+    EXPECT_EQ(received, std::vector<int>({0}));
+}
+
+TEST_F(SplitShared, ResendsEverythingToARestartedMaster) {
+    uint16_t master_copy = 0, slave_value = 0;
+    split_shared_id_t id = master_side::split_shared_register(&master_copy, sizeof(master_copy), SPLIT_SHARED_TO_MASTER, 0, NULL);
+    slave_side::split_shared_register(&slave_value, sizeof(slave_value), SPLIT_SHARED_TO_MASTER, 0, NULL);
+    slave_value = 0xBEEF;
+    slave_side::split_shared_mark_dirty(id);
+    scan_until_synced();
+
+    master_copy = 0;
+    master_side::split_shared_init(true);
+    master_side::split_shared_register(&master_copy, sizeof(master_copy), SPLIT_SHARED_TO_MASTER, 0, NULL);
+    for (int i = 0; i < 10; i++) {
+        scan();
+    }
+    scan_until_synced();
+    EXPECT_EQ(master_copy, 0xBEEF);
+}
+
+TEST_F(SplitShared, SequenceNumbersStartOverAfterARestart) {
+    uint16_t master_copy = 0, slave_value = 0;
+    split_shared_id_t id = master_side::split_shared_register(&master_copy, sizeof(master_copy), SPLIT_SHARED_TO_MASTER, 0, NULL);
+    slave_side::split_shared_register(&slave_value, sizeof(slave_value), SPLIT_SHARED_TO_MASTER, 0, NULL);
+    slave_value = 1;
+    slave_side::split_shared_mark_dirty(id);
+    scan_until_synced();
+
+    // The restarted slave's first packet has the sequence number the master has just received and acknowledged
+    slave_side::split_shared_init(false);
+    slave_side::split_shared_register(&slave_value, sizeof(slave_value), SPLIT_SHARED_TO_MASTER, 0, NULL);
+    slave_value = 2;
+    slave_side::split_shared_mark_dirty(id);
+    scan_until_synced();
+    EXPECT_EQ(master_copy, 2);
+}
@@ -0,0 +1,116 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "split_telemetry.h"
+}
+
+class SplitTelemetry : public testing::Test {
+   public:
+    SplitTelemetry() { split_telemetry_reset(); }
+};
+
+TEST_F(SplitTelemetry, CountsTransactions) {
+    split_telemetry_transaction(SPLIT_TELEMETRY_OK, 2, 10);
+    split_telemetry_transaction(SPLIT_TELEMETRY_OK, 2, 10);
+    split_telemetry_transaction(SPLIT_TELEMETRY_TIMEOUT, 2, 10);
+    split_telemetry_transaction(SPLIT_TELEMETRY_ERROR, 2, 10);
+    split_telemetry_error();
+
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_TRANSACTIONS), 4u);
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_TIMEOUTS), 1u);
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_ERRORS), 2u);
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_BYTES_SENT), 8u);
+    // Nothing is received from failed transactions
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_BYTES_RECEIVED), 20u);
+}
+
+TEST_F(SplitTelemetry, CountsRetriesAndDisconnects) {
+    split_telemetry_scan(true, 100);
+    split_telemetry_scan(false, 100);
+    split_telemetry_scan(false, 100);
+    split_telemetry_scan(true, 100);
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_SCANS), 4u);
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_FAILED_SCANS), 2u);
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_RETRIES), 2u);
+
+    for (int i = 0; i < 6; i++) {
+        split_telemetry_scan(false, 100);
+    }
+    split_telemetry_disconnect();
+    split_telemetry_scan(false, 100);
+    split_telemetry_scan(true, 100);
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_DISCONNECTS), 1u);
+    // Only the scan that failed after the disconnect counts as a retry
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_RETRIES), 3u);
+}
+
+TEST_F(SplitTelemetry, BucketsRoundTripTimes) {
+    uint32_t times[] = {0, 124, 125, 249, 250, 999, 1000, 7999, 8000, 1000000};
+    for (uint32_t time : times) {
+        split_telemetry_scan(true, time);
+    }
+    uint32_t expected[SPLIT_TELEMETRY_RTT_BUCKETS] = {2, 2, 1, 1, 1, 0, 1, 2};
+    for (int bucket = 0; bucket < SPLIT_TELEMETRY_RTT_BUCKETS; bucket++) {
+        EXPECT_EQ(split_telemetry_get((split_telemetry_field_t)(SPLIT_TELEMETRY_RTT_HISTOGRAM + bucket)), expected[bucket]) << "bucket " << bucket;
+    }
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_RTT_MAX), 1000000u);
+}
+
+TEST_F(SplitTelemetry, AveragesRoundTripTimes) {
+    split_telemetry_scan(true, 100);
+    split_telemetry_scan(true, 300);
+    EXPECT_EQ(split_telemetry_get(SPLIT_TELEMETRY_RTT_AVERAGE), 200u);
+
+    // Doesn't overflow on a keyboard that has been running for a long time
+    for (int i = 0; i < 10000; i++) {
+        split_telemetry_scan(true, 1000000);
+    }
+    EXPECT_NEAR(split_telemetry_get(SPLIT_TELEMETRY_RTT_AVERAGE), 1000000u, 10000u);
+}
+
+TEST_F(SplitTelemetry, Resets) {
+    split_telemetry_scan(false, 500);
+    split_telemetry_transaction(SPLIT_TELEMETRY_TIMEOUT, 1, 1);
+    split_telemetry_reset();
+    for (int field = 0; field < SPLIT_TELEMETRY_COUNT; field++) {
+        EXPECT_EQ(split_telemetry_get((split_telemetry_field_t)field), 0u) << "field " << field;
+    }
+}
+
+TEST_F(SplitTelemetry, PacksPagesForRawHid) {
+    for (int i = 0; i < 0x01020304; i += 0x00100000) {
+        split_telemetry_transaction(SPLIT_TELEMETRY_OK, 0, 0);
+    }
+    split_telemetry_scan(true, 10000);
+
+    // 29 bytes are left in a VIA report, which fit 7 counters
+    uint8_t data[29] = {};
+    EXPECT_EQ(split_telemetry_pack(0, data, sizeof(data)), 7);
+    EXPECT_EQ(data[SPLIT_TELEMETRY_SCANS * 4 + 3], 1);
+    EXPECT_EQ(data[SPLIT_TELEMETRY_TRANSACTIONS * 4 + 3], 17);
+
+    EXPECT_EQ(split_telemetry_pack(1, data, sizeof(data)), 7);
+    uint8_t max = (SPLIT_TELEMETRY_RTT_MAX - 7) * 4;
+    EXPECT_EQ((data[max] << 24) | (data[max + 1] << 16) | (data[max + 2] << 8) | data[max + 3], 10000);
+
+    // The last page is only partially filled
+    EXPECT_EQ(split_telemetry_pack(2, data, sizeof(data)), SPLIT_TELEMETRY_COUNT - 14);
+    EXPECT_EQ(data[(SPLIT_TELEMETRY_RTT_HISTOGRAM + SPLIT_TELEMETRY_RTT_BUCKETS - 1 - 14) * 4 + 3], 1);
+    EXPECT_EQ(split_telemetry_pack(3, data, sizeof(data)), 0);
+}
@@ -0,0 +1 @@
+TEST_LIST += split_delta split_shared split_telemetry
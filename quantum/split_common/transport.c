@@ -25,14 +25,30 @@ static pin_t encoders_pad[] = ENCODERS_PAD_A;
 #    include "oledctrl.h"
 #endif
 
+#ifdef SPLIT_TRANSPORT_DELTA
+#    include "split_delta.h"
+#endif
+
+#ifdef SPLIT_SHARED_STATE_ENABLE
+#    include "split_shared.h"
+#endif
+
+#include "split_telemetry.h"
+
 #if defined(USE_I2C)
 
 #    include "i2c_master.h"
 #    include "i2c_slave.h"
 
 typedef struct _I2C_slave_buffer_t {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    uint8_t delta_frame[SPLIT_DELTA_FRAME_MAX_SIZE];
+    uint8_t delta_ack;
+    uint8_t delta_resync;
+#    else
     matrix_row_t smatrix[ROWS_PER_HAND];
-    uint8_t      backlight_level;
+#    endif
+    uint8_t backlight_level;
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     rgblight_syncinfo_t rgblight_sync;
 #    endif
@@ -45,8 +61,16 @@ typedef struct _I2C_slave_buffer_t {
 #    if defined(OLED_CONTROL_ENABLE) && defined(OLEDCTRL_SPLIT)
     oledctrl_syncinfo_t oledctrl_sync;
 #    endif
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    uint8_t shared_m2s[SPLIT_SHARED_PACKET_SIZE];
+    uint8_t shared_s2m[SPLIT_SHARED_PACKET_SIZE];
+#    endif
 } I2C_slave_buffer_t;
 
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+_Static_assert(sizeof(I2C_slave_buffer_t) <= I2C_SLAVE_REG_COUNT, "I2C_SLAVE_REG_COUNT is too small for the shared-state packets");
+#    endif
+
 static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_reg;
 
 #    define I2C_BACKLIGHT_START offsetof(I2C_slave_buffer_t, backlight_level)
@@ -55,6 +79,10 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #    define I2C_ENCODER_START offsetof(I2C_slave_buffer_t, encoder_state)
 #    define I2C_WPM_START offsetof(I2C_slave_buffer_t, current_wpm)
 #    define I2C_OLED_START offsetof(I2C_slave_buffer_t, oledctrl_sync)
+#    define I2C_DELTA_FRAME_START offsetof(I2C_slave_buffer_t, delta_frame)
+#    define I2C_DELTA_CONTROL_START offsetof(I2C_slave_buffer_t, delta_ack)
+#    define I2C_SHARED_M2S_START offsetof(I2C_slave_buffer_t, shared_m2s)
+#    define I2C_SHARED_S2M_START offsetof(I2C_slave_buffer_t, shared_s2m)
 
 #    define TIMEOUT 100
 
@@ -62,15 +90,107 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #        define SLAVE_I2C_ADDRESS 0x32
 #    endif
 
+// A macro rather than a function, so that it compiles away with the telemetry
+#    define transport_i2c_result(status) ((status) == I2C_STATUS_SUCCESS ? SPLIT_TELEMETRY_OK : (status) == I2C_STATUS_TIMEOUT ? SPLIT_TELEMETRY_TIMEOUT : SPLIT_TELEMETRY_ERROR)
+
+// Every transfer goes through these, so that it's counted by the telemetry
+
+static i2c_status_t transport_read(uint8_t reg, void *data, uint16_t length) {
+    i2c_status_t status = i2c_readReg(SLAVE_I2C_ADDRESS, reg, data, length, TIMEOUT);
+    split_telemetry_transaction(transport_i2c_result(status), 0, length);
+    return status;
+}
+
+static i2c_status_t transport_write(uint8_t reg, const void *data, uint16_t length) {
+    i2c_status_t status = i2c_writeReg(SLAVE_I2C_ADDRESS, reg, (const uint8_t *)data, length, TIMEOUT);
+    split_telemetry_transaction(transport_i2c_result(status), length, 0);
+    return status;
+}
+
+#    ifdef SPLIT_TRANSPORT_DELTA
+// Reads the header of the frame, then only the rows it says have changed
+static bool transport_delta_master(matrix_row_t matrix[]) {
+    static uint8_t resync_sent = false;
+    uint8_t        frame[SPLIT_DELTA_FRAME_MAX_SIZE];
+
+    if (transport_read(I2C_DELTA_FRAME_START, frame, SPLIT_DELTA_HEADER_SIZE) < 0) {
+        return false;
+    }
+    uint8_t body = split_delta_body_size(frame);
+    if (body > 0 && transport_read(I2C_DELTA_FRAME_START + SPLIT_DELTA_HEADER_SIZE, &frame[SPLIT_DELTA_HEADER_SIZE], body) < 0) {
+        return false;
+    }
+    bool accepted = split_delta_decode(frame, SPLIT_DELTA_HEADER_SIZE + body, matrix);
+    if (!accepted) {
+        split_telemetry_error();
+    }
+
+    // Acknowledge frames with changes, so that the slave moves on, and ask for a full frame when one didn't apply
+    uint8_t control[2] = {split_delta_ack(), split_delta_resync_pending()};
+    if ((accepted && body > 0) || control[1] != resync_sent) {
+        if (transport_write(I2C_DELTA_CONTROL_START, control, sizeof(control)) >= 0) {
+            resync_sent = control[1];
+        }
+    }
+    return accepted;
+}
+
+static void transport_delta_slave(matrix_row_t matrix[]) {
+    if (i2c_buffer->delta_resync) {
+        split_delta_request_full();
+    } else if (split_delta_has_changes() && i2c_buffer->delta_ack == split_delta_sequence()) {
+        split_delta_commit();
+    }
+    if (split_delta_encode(matrix, i2c_buffer->delta_frame)) {
+        // Only an acknowledgement of this frame counts
+        i2c_buffer->delta_ack = split_delta_sequence() - 1;
+    }
+}
+#    endif
+
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+// Reads the slave's packet, only fetching the payload when it's a new one, and writes ours when it has changed
+static void transport_shared_master(void) {
+    static uint8_t written[SPLIT_SHARED_PACKET_SIZE];
+    uint8_t        packet[SPLIT_SHARED_PACKET_SIZE];
+
+    if (transport_read(I2C_SHARED_S2M_START, packet, SPLIT_SHARED_HEADER_SIZE) >= 0) {
+        uint8_t payload = split_shared_packet_size(packet) - SPLIT_SHARED_HEADER_SIZE;
+        if (!split_shared_payload_needed(packet) || payload == 0 || transport_read(I2C_SHARED_S2M_START + SPLIT_SHARED_HEADER_SIZE, &packet[SPLIT_SHARED_HEADER_SIZE], payload) >= 0) {
+            split_shared_receive(packet);
+        }
+    }
+
+    split_shared_prepare(packet);
+    uint8_t size = split_shared_packet_size(packet);
+    if (memcmp(packet, written, size) != 0) {
+        if (transport_write(I2C_SHARED_M2S_START, packet, size) >= 0) {
+            memcpy(written, packet, size);
+        }
+    }
+}
+
+static void transport_shared_slave(void) {
+    split_shared_receive(i2c_buffer->shared_m2s);
+    split_shared_prepare(i2c_buffer->shared_s2m);
+}
+#    endif
+
 // Get rows from other half over i2c
 bool transport_master(matrix_row_t matrix[]) {
-    i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_START, (void *)matrix, sizeof(i2c_buffer->smatrix), TIMEOUT);
+#    ifdef SPLIT_TRANSPORT_DELTA
+    if (!transport_delta_master(matrix)) {
+        return false;
+    }
+#    else
+    transport_read(I2C_KEYMAP_START, (void *)matrix, sizeof(i2c_buffer->smatrix));
+#    endif
 
     // write backlight info
 #    ifdef BACKLIGHT_ENABLE
     uint8_t level = is_backlight_enabled() ? get_backlight_level() : 0;
     if (level != i2c_buffer->backlight_level) {
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_BACKLIGHT_START, (void *)&level, sizeof(level), TIMEOUT) >= 0) {
+        if (transport_write(I2C_BACKLIGHT_START, (void *)&level, sizeof(level)) >= 0) {
             i2c_buffer->backlight_level = level;
         }
     }
@@ -80,21 +200,21 @@ bool transport_master(matrix_row_t matrix[]) {
     if (rgblight_get_change_flags()) {
         rgblight_syncinfo_t rgblight_sync;
         rgblight_get_syncinfo(&rgblight_sync);
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_RGB_START, (void *)&rgblight_sync, sizeof(rgblight_sync), TIMEOUT) >= 0) {
+        if (transport_write(I2C_RGB_START, (void *)&rgblight_sync, sizeof(rgblight_sync)) >= 0) {
             rgblight_clear_change_flags();
         }
     }
 #    endif
 
 #    ifdef ENCODER_ENABLE
-    i2c_readReg(SLAVE_I2C_ADDRESS, I2C_ENCODER_START, (void *)i2c_buffer->encoder_state, sizeof(i2c_buffer->encoder_state), TIMEOUT);
+    transport_read(I2C_ENCODER_START, (void *)i2c_buffer->encoder_state, sizeof(i2c_buffer->encoder_state));
     encoder_update_raw(i2c_buffer->encoder_state);
 #    endif
 
 #    ifdef WPM_ENABLE
     uint8_t current_wpm = get_current_wpm();
     if (current_wpm != i2c_buffer->current_wpm) {
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_WPM_START, (void *)&current_wpm, sizeof(current_wpm), TIMEOUT) >= 0) {
+        if (transport_write(I2C_WPM_START, (void *)&current_wpm, sizeof(current_wpm)) >= 0) {
             i2c_buffer->current_wpm = current_wpm;
         }
     }
@@ -104,17 +224,25 @@ bool transport_master(matrix_row_t matrix[]) {
     if (oledctrl_is_msg_pending()) {
         oledctrl_syncinfo_t oledctrl_sync;
         oledctrl_get_syncinfo(&oledctrl_sync);
-        if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_OLED_START, (void *)&oledctrl_sync, sizeof(oledctrl_sync), TIMEOUT) >= 0) {
+        if (transport_write(I2C_OLED_START, (void *)&oledctrl_sync, sizeof(oledctrl_sync)) >= 0) {
             oledctrl_clear_msg_pending();
         }
     }
 #    endif
+
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    transport_shared_master();
+#    endif
     return true;
 }
 
 void transport_slave(matrix_row_t matrix[]) {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    transport_delta_slave(matrix);
+#    else
     // Copy matrix to I2C buffer
     memcpy((void *)i2c_buffer->smatrix, (void *)matrix, sizeof(i2c_buffer->smatrix));
+#    endif
 
 // Read Backlight Info
 #    ifdef BACKLIGHT_ENABLE
@@ -143,33 +271,69 @@ void transport_slave(matrix_row_t matrix[]) {
         i2c_buffer->oledctrl_sync[0] = 0;
     }
 #    endif
+
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    transport_shared_slave();
+#    endif
 }
 
-void transport_master_init(void) { i2c_init(); }
+void transport_master_init(void) {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    split_delta_decoder_init();
+#    endif
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    split_shared_init(true);
+#    endif
+    i2c_init();
+}
 
-void transport_slave_init(void) { i2c_slave_init(SLAVE_I2C_ADDRESS); }
+void transport_slave_init(void) {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    split_delta_encoder_init();
+#    endif
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    split_shared_init(false);
+#    endif
+    i2c_slave_init(SLAVE_I2C_ADDRESS);
+}
 
 #else  // USE_SERIAL
 
 #    include "serial.h"
 
 typedef struct _Serial_s2m_buffer_t {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    // the rows that changed follow in a separate transaction
+    uint8_t delta_header[SPLIT_DELTA_HEADER_SIZE];
+#    else
     // TODO: if MATRIX_COLS > 8 change to uint8_t packed_matrix[] for pack/unpack
     matrix_row_t smatrix[ROWS_PER_HAND];
+#    endif
 
 #    ifdef ENCODER_ENABLE
     uint8_t      encoder_state[NUMBER_OF_ENCODERS];
 #    endif
 
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    // the payload follows in a separate transaction, when needed
+    uint8_t shared_header[SPLIT_SHARED_HEADER_SIZE];
+#    endif
+
 } Serial_s2m_buffer_t;
 
 typedef struct _Serial_m2s_buffer_t {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    uint8_t delta_resync;
+#    endif
 #    ifdef BACKLIGHT_ENABLE
     uint8_t backlight_level;
 #    endif
 #    ifdef WPM_ENABLE
     uint8_t current_wpm;
 #    endif
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    uint8_t shared_header[SPLIT_SHARED_HEADER_SIZE];
+#    endif
 } Serial_m2s_buffer_t;
 
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
@@ -202,8 +366,25 @@ volatile Serial_s2m_buffer_t serial_s2m_buffer = {};
 volatile Serial_m2s_buffer_t serial_m2s_buffer = {};
 uint8_t volatile status0                       = 0;
 
+#    ifdef SPLIT_TRANSPORT_DELTA
+volatile uint8_t serial_delta_rows[SPLIT_DELTA_BODY_MAX_SIZE] = {};
+uint8_t volatile status_delta_rows                            = 0;
+#    endif
+
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+volatile uint8_t serial_shared_m2s[SPLIT_SHARED_PAYLOAD_SIZE] = {};
+volatile uint8_t serial_shared_s2m[SPLIT_SHARED_PAYLOAD_SIZE] = {};
+uint8_t volatile status_shared                                = 0;
+#    endif
+
 enum serial_transaction_id {
     GET_SLAVE_MATRIX = 0,
+#    ifdef SPLIT_TRANSPORT_DELTA
+    GET_SLAVE_DELTA_ROWS,
+#    endif
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    EXCHANGE_SHARED,
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     PUT_RGBLIGHT,
 #    endif
@@ -221,6 +402,18 @@ SSTD_t transactions[] = {
             sizeof(serial_s2m_buffer),
             (uint8_t *)&serial_s2m_buffer,
         },
+#    ifdef SPLIT_TRANSPORT_DELTA
+    [GET_SLAVE_DELTA_ROWS] =
+        {
+            (uint8_t *)&status_delta_rows, 0, NULL, 0, (uint8_t *)serial_delta_rows  // size is set for each frame, on both sides
+        },
+#    endif
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    [EXCHANGE_SHARED] =
+        {
+            (uint8_t *)&status_shared, sizeof(serial_shared_m2s), (uint8_t *)serial_shared_m2s, sizeof(serial_shared_s2m), (uint8_t *)serial_shared_s2m,
+        },
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     [PUT_RGBLIGHT] =
         {
@@ -235,9 +428,120 @@ SSTD_t transactions[] = {
 #    endif
 };
 
-void transport_master_init(void) { soft_serial_initiator_init(transactions, TID_LIMIT(transactions)); }
+#    ifdef SERIAL_USE_MULTI_TRANSACTION
+// Every transaction goes through this, so that it's counted by the telemetry
+static int transport_transaction(int index) {
+    int status = soft_serial_transaction(index);
+    split_telemetry_transaction(status == TRANSACTION_END ? SPLIT_TELEMETRY_OK : status == TRANSACTION_NO_RESPONSE ? SPLIT_TELEMETRY_TIMEOUT : SPLIT_TELEMETRY_ERROR, transactions[index].initiator2target_buffer_size, transactions[index].target2initiator_buffer_size);
+    return status;
+}
+#    endif
+
+void transport_master_init(void) {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    split_delta_decoder_init();
+#    endif
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    split_shared_init(true);
+#    endif
+    soft_serial_initiator_init(transactions, TID_LIMIT(transactions));
+}
+
+void transport_slave_init(void) {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    split_delta_encoder_init();
+#    endif
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    split_shared_init(false);
+#    endif
+    soft_serial_target_init(transactions, TID_LIMIT(transactions));
+}
+
+#    ifdef SPLIT_TRANSPORT_DELTA
+
+// Fetches the rows the header says have changed, if any
+static bool transport_delta_master(matrix_row_t matrix[]) {
+    uint8_t frame[SPLIT_DELTA_FRAME_MAX_SIZE];
+
+    memcpy(frame, (uint8_t *)serial_s2m_buffer.delta_header, SPLIT_DELTA_HEADER_SIZE);
+    uint8_t body = split_delta_body_size(frame);
+    if (body > 0) {
+        transactions[GET_SLAVE_DELTA_ROWS].target2initiator_buffer_size = body;
+        if (transport_transaction(GET_SLAVE_DELTA_ROWS) != TRANSACTION_END) {
+            return false;
+        }
+        memcpy(&frame[SPLIT_DELTA_HEADER_SIZE], (uint8_t *)serial_delta_rows, body);
+    }
+    bool accepted = split_delta_decode(frame, SPLIT_DELTA_HEADER_SIZE + body, matrix);
+    if (!accepted) {
+        split_telemetry_error();
+    }
+
+    serial_m2s_buffer.delta_resync = split_delta_resync_pending();
+    return accepted;
+}
 
-void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMIT(transactions)); }
+// header_read is set when the master has read serial_s2m_buffer since the last scan
+static void transport_delta_slave(matrix_row_t matrix[], bool header_read) {
+    static uint8_t frame[SPLIT_DELTA_FRAME_MAX_SIZE];
+    static bool    frame_header_read = false;
+
+    frame_header_read |= header_read;
+    if (status_delta_rows == TRANSACTION_ACCEPTED) {
+        status_delta_rows = TRANSACTION_END;
+        split_delta_commit();
+    }
+    if (serial_m2s_buffer.delta_resync) {
+        split_delta_request_full();
+    } else if (frame_header_read && split_delta_has_changes()) {
+        // The master has read the header, the rows have to stay as they are until it has read them too
+        return;
+    }
+
+    split_delta_encode(matrix, frame);
+    uint8_t body = split_delta_body_size(frame);
+    memcpy((uint8_t *)serial_s2m_buffer.delta_header, frame, SPLIT_DELTA_HEADER_SIZE);
+    memcpy((uint8_t *)serial_delta_rows, &frame[SPLIT_DELTA_HEADER_SIZE], body);
+    transactions[GET_SLAVE_DELTA_ROWS].target2initiator_buffer_size = body;
+    frame_header_read                                               = false;
+}
+
+#    endif
+
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+
+// The headers go along with the matrix, the payloads are only exchanged when either of them is new
+static void transport_shared_master(void) {
+    uint8_t packet[SPLIT_SHARED_PACKET_SIZE];
+
+    memcpy(packet, (uint8_t *)serial_s2m_buffer.shared_header, SPLIT_SHARED_HEADER_SIZE);
+    if (split_shared_payload_needed(packet)) {
+        if (transport_transaction(EXCHANGE_SHARED) != TRANSACTION_END) {
+            return;
+        }
+        memcpy(&packet[SPLIT_SHARED_HEADER_SIZE], (uint8_t *)serial_shared_s2m, SPLIT_SHARED_PAYLOAD_SIZE);
+    }
+    split_shared_receive(packet);
+
+    // Sent with the next scan
+    split_shared_prepare(packet);
+    memcpy((uint8_t *)serial_m2s_buffer.shared_header, packet, SPLIT_SHARED_HEADER_SIZE);
+    memcpy((uint8_t *)serial_shared_m2s, &packet[SPLIT_SHARED_HEADER_SIZE], SPLIT_SHARED_PAYLOAD_SIZE);
+}
+
+static void transport_shared_slave(void) {
+    uint8_t packet[SPLIT_SHARED_PACKET_SIZE];
+
+    memcpy(packet, (uint8_t *)serial_m2s_buffer.shared_header, SPLIT_SHARED_HEADER_SIZE);
+    memcpy(&packet[SPLIT_SHARED_HEADER_SIZE], (uint8_t *)serial_shared_m2s, SPLIT_SHARED_PAYLOAD_SIZE);
+    split_shared_receive(packet);
+
+    split_shared_prepare(packet);
+    memcpy((uint8_t *)serial_shared_s2m, &packet[SPLIT_SHARED_HEADER_SIZE], SPLIT_SHARED_PAYLOAD_SIZE);
+    memcpy((uint8_t *)serial_s2m_buffer.shared_header, packet, SPLIT_SHARED_HEADER_SIZE);
+}
+
+#    endif
 
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
 
@@ -246,7 +550,7 @@ void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMI
 void transport_rgblight_master(void) {
     if (rgblight_get_change_flags()) {
         rgblight_get_syncinfo((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync);
-        if (soft_serial_transaction(PUT_RGBLIGHT) == TRANSACTION_END) {
+        if (transport_transaction(PUT_RGBLIGHT) == TRANSACTION_END) {
             rgblight_clear_change_flags();
         }
     }
@@ -271,15 +575,21 @@ bool transport_master(matrix_row_t matrix[]) {
     }
 #    else
     transport_rgblight_master();
-    if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
+    if (transport_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
         return false;
     }
 #    endif
 
+#    ifdef SPLIT_TRANSPORT_DELTA
+    if (!transport_delta_master(matrix)) {
+        return false;
+    }
+#    else
     // TODO:  if MATRIX_COLS > 8 change to unpack()
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         matrix[i] = serial_s2m_buffer.smatrix[i];
     }
+#    endif
 
 #    ifdef BACKLIGHT_ENABLE
     // Write backlight level for slave to read
@@ -298,20 +608,33 @@ bool transport_master(matrix_row_t matrix[]) {
 #    if defined(OLED_CONTROL_ENABLE) && defined(OLEDCTRL_SPLIT)
     if (oledctrl_is_msg_pending()) {
         oledctrl_get_syncinfo((oledctrl_syncinfo_t *)&serial_oledctrl.oledctrl_sync);
-        if (soft_serial_transaction(PUT_OLEDCTRL) == TRANSACTION_END) {
+        if (transport_transaction(PUT_OLEDCTRL) == TRANSACTION_END) {
             oledctrl_clear_msg_pending();
         }
     }
 #    endif
+
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    transport_shared_master();
+#    endif
     return true;
 }
 
 void transport_slave(matrix_row_t matrix[]) {
     transport_rgblight_slave();
+#    ifdef SPLIT_TRANSPORT_DELTA
+    // status0 belongs to GET_SLAVE_MATRIX, the delta encoder is only told when the master has read it
+    bool matrix_read = status0 == TRANSACTION_ACCEPTED;
+    if (matrix_read) {
+        status0 = TRANSACTION_END;
+    }
+    transport_delta_slave(matrix, matrix_read);
+#    else
     // TODO: if MATRIX_COLS > 8 change to pack()
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         serial_s2m_buffer.smatrix[i] = matrix[i];
     }
+#    endif
 #    ifdef BACKLIGHT_ENABLE
     backlight_set(serial_m2s_buffer.backlight_level);
 #    endif
@@ -330,6 +653,10 @@ void transport_slave(matrix_row_t matrix[]) {
         status_oledctrl = TRANSACTION_END;
     }
 #    endif
+
+#    ifdef SPLIT_SHARED_STATE_ENABLE
+    transport_shared_slave();
+#    endif
 }
 
 #endif
@@ -0,0 +1,253 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "deferred_exec.h"
+#include "timer.h"
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+struct Call {
+    int      id;
+    uint32_t trigger_time;
+    uint32_t now;
+};
+
+static std::vector<Call> calls;
+
+struct Callback {
+    int            id;
+    uint32_t       repeat;
+    int            repeats_left;
+    deferred_token cancel;
+};
+
+static uint32_t record_call(uint32_t trigger_time, void *cb_arg) {
+    Callback *callback = (Callback *)cb_arg;
+    calls.push_back({callback->id, trigger_time, timer_read32()});
+    if (callback->cancel != INVALID_DEFERRED_TOKEN) {
+        cancel_deferred_exec(callback->cancel);
+    }
+    if (callback->repeats_left > 0) {
+        callback->repeats_left--;
+        return callback->repeat;
+    }
+    return 0;
+}
+
+class DeferredExec : public testing::Test {
+   public:
+    DeferredExec() {
+        calls.clear();
+        set_time(1000);
+        deferred_exec_task();
+    }
+
+    ~DeferredExec() {
+        for (deferred_token token : tokens) {
+            cancel_deferred_exec(token);
+        }
+    }
+
+    deferred_token defer(uint32_t delay, Callback *callback) {
+        deferred_token token = defer_exec(delay, record_call, callback);
+        tokens.push_back(token);
+        return token;
+    }
+
+    void run_for(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            deferred_exec_task();
+        }
+    }
+
+    std::vector<deferred_token> tokens;
+};
+
+TEST_F(DeferredExec, RunsAfterTheDelay) {
+    Callback callback = {1};
+    EXPECT_NE(defer(10, &callback), INVALID_DEFERRED_TOKEN);
+    run_for(9);
+    EXPECT_TRUE(calls.empty());
+    run_for(1);
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(calls[0].trigger_time, 1010u);
+    EXPECT_EQ(calls[0].now, 1010u);
+    run_for(100);
+    EXPECT_EQ(calls.size(), 1u);
+}
+
+TEST_F(DeferredExec, ZeroDelayRunsOnTheNextMillisecond) {
+    Callback callback = {1};
+    defer(0, &callback);
+    deferred_exec_task();
+    EXPECT_TRUE(calls.empty());
+    run_for(1);
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(calls[0].trigger_time, 1000u);
+    EXPECT_EQ(calls[0].now, 1001u);
+}
+
+TEST_F(DeferredExec, DelaysLongerThanTheWheel) {
+    Callback first = {1}, second = {2};
+    defer(DEFERRED_EXEC_WHEEL_SIZE * 3 + 5, &first);
+    defer(1000, &second);
+    run_for(DEFERRED_EXEC_WHEEL_SIZE * 3 + 4);
+    EXPECT_TRUE(calls.empty());
+    run_for(1);
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(calls[0].id, 1);
+    run_for(1000);
+    ASSERT_EQ(calls.size(), 2u);
+    EXPECT_EQ(calls[1].id, 2);
+    EXPECT_EQ(calls[1].trigger_time, 2000u);
+    EXPECT_EQ(calls[1].now, 2000u);
+}
+
+TEST_F(DeferredExec, CatchesUpInDeadlineOrder) {
+    Callback callbacks[4] = {{1}, {2}, {3}, {4}};
+    defer(40, &callbacks[0]);
+    defer(5, &callbacks[1]);
+    defer(90, &callbacks[2]);
+    defer(20, &callbacks[3]);
+    // A long time without a task, longer than a turn of the wheel
+    advance_time(100);
+    deferred_exec_task();
+    ASSERT_EQ(calls.size(), 4u);
+    EXPECT_EQ(calls[0].id, 2);
+    EXPECT_EQ(calls[1].id, 4);
+    EXPECT_EQ(calls[2].id, 1);
+    EXPECT_EQ(calls[3].id, 3);
+    EXPECT_EQ(calls[3].trigger_time, 1090u);
+}
+
+TEST_F(DeferredExec, Cancels) {
+    Callback       callback = {1};
+    deferred_token token    = defer(10, &callback);
+    run_for(5);
+    EXPECT_TRUE(cancel_deferred_exec(token));
+    EXPECT_FALSE(cancel_deferred_exec(token));
+    EXPECT_FALSE(extend_deferred_exec(token, 10));
+    run_for(100);
+    EXPECT_TRUE(calls.empty());
+    EXPECT_FALSE(cancel_deferred_exec(INVALID_DEFERRED_TOKEN));
+}
+
+TEST_F(DeferredExec, StaleTokensDontCancelNewCallbacks) {
+    Callback       first = {1}, second = {2};
+    deferred_token token = defer(1, &first);
+    run_for(1);
+    ASSERT_EQ(calls.size(), 1u);
+    // Takes the place of the callback that ran
+    deferred_token new_token = defer(5, &second);
+    EXPECT_NE(new_token, token);
+    EXPECT_FALSE(cancel_deferred_exec(token));
+    run_for(5);
+    ASSERT_EQ(calls.size(), 2u);
+    EXPECT_EQ(calls[1].id, 2);
+}
+
+TEST_F(DeferredExec, Extends) {
+    Callback       callback = {1};
+    deferred_token token    = defer(10, &callback);
+    run_for(8);
+    EXPECT_TRUE(extend_deferred_exec(token, 10));
+    run_for(9);
+    EXPECT_TRUE(calls.empty());
+    run_for(1);
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(calls[0].now, 1018u);
+}
+
+TEST_F(DeferredExec, RepeatsWithoutDrifting) {
+    Callback callback = {1, 7, 3};
+    defer(7, &callback);
+    // The task only runs every 3ms, callbacks run late but stay on schedule
+    for (int i = 0; i < 20; i++) {
+        advance_time(3);
+        deferred_exec_task();
+    }
+    ASSERT_EQ(calls.size(), 4u);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(calls[i].trigger_time, 1007u + i * 7);
+        EXPECT_GE(calls[i].now, calls[i].trigger_time);
+        EXPECT_LT(calls[i].now, calls[i].trigger_time + 3);
+    }
+}
+
+TEST_F(DeferredExec, CallbacksCanCancelOtherDueCallbacks) {
+    Callback second = {2};
+    Callback first  = {1, 0, 0, defer(5, &second)};
+    defer(3, &first);
+    advance_time(10);
+    deferred_exec_task();
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(calls[0].id, 1);
+    run_for(10);
+    EXPECT_EQ(calls.size(), 1u);
+}
+
+TEST_F(DeferredExec, RunsOutOfTasks) {
+    Callback callback = {1};
+    for (int i = 0; i < DEFERRED_EXEC_MAX_TASKS; i++) {
+        EXPECT_NE(defer(10, &callback), INVALID_DEFERRED_TOKEN);
+    }
+    EXPECT_EQ(defer_exec(10, record_call, &callback), INVALID_DEFERRED_TOKEN);
+    run_for(10);
+    EXPECT_EQ(calls.size(), (size_t)DEFERRED_EXEC_MAX_TASKS);
+    EXPECT_NE(defer(10, &callback), INVALID_DEFERRED_TOKEN);
+}
+
+TEST_F(DeferredExec, ReservedTasksAreLeftForFeatures) {
+    Callback callback = {1};
+    Callback feature  = {2};
+    for (int i = 0; i < DEFERRED_EXEC_MAX_TASKS; i++) {
+        EXPECT_NE(defer(10, &callback), INVALID_DEFERRED_TOKEN);
+    }
+    EXPECT_EQ(defer_exec(10, record_call, &callback), INVALID_DEFERRED_TOKEN);
+
+    deferred_token token = defer_exec_reserved(5, record_call, &feature);
+    EXPECT_NE(token, INVALID_DEFERRED_TOKEN);
+    EXPECT_EQ(defer_exec_reserved(5, record_call, &feature), INVALID_DEFERRED_TOKEN);
+    EXPECT_TRUE(extend_deferred_exec(token, 3));
+    run_for(3);
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(calls[0].id, 2);
+
+    // The reserved callback is free again, but the others still aren't
+    token = defer_exec_reserved(5, record_call, &feature);
+    EXPECT_NE(token, INVALID_DEFERRED_TOKEN);
+    tokens.push_back(token);
+    EXPECT_EQ(defer_exec(10, record_call, &callback), INVALID_DEFERRED_TOKEN);
+}
+
+TEST_F(DeferredExec, TimerWrapsAround) {
+    set_time(UINT32_MAX - 5);
+    deferred_exec_task();
+    Callback callback = {1};
+    defer(10, &callback);
+    run_for(9);
+    EXPECT_TRUE(calls.empty());
+    run_for(1);
+    ASSERT_EQ(calls.size(), 1u);
+    EXPECT_EQ(calls[0].now, 4u);
+}
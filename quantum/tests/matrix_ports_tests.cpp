@@ -0,0 +1,117 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix_ports.h"
+}
+
+// Drives the row low, the columns are pulled up and read low through the closed switches
+static const pin_t ROW = GPIO_MOCK_PIN(3, 15);
+
+class MatrixPorts : public testing::Test {
+   public:
+    void SetUp() override {
+        gpio_mock_reset();
+        setPinOutput(ROW);
+        writePinLow(ROW);
+    }
+
+    void init(std::vector<pin_t> pins) {
+        ASSERT_EQ(pins.size(), MATRIX_COLS);
+        cols = pins;
+        for (pin_t pin : cols) {
+            if (pin != NO_PIN) {
+                setPinInputHigh(pin);
+            }
+        }
+        matrix_ports_init(&ports, cols.data(), MATRIX_COLS);
+    }
+
+    void press(matrix_row_t keys) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (cols[col] != NO_PIN) {
+                gpio_mock_switch(cols[col], ROW, keys & (MATRIX_ROW_SHIFTER << col));
+            }
+        }
+    }
+
+    // The row as read_cols_on_row() reads it without the ports, one pin at a time
+    matrix_row_t read_pins(void) {
+        matrix_row_t row = 0;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (cols[col] != NO_PIN && !readPin(cols[col])) {
+                row |= MATRIX_ROW_SHIFTER << col;
+            }
+        }
+        return row;
+    }
+
+    std::vector<pin_t> cols;
+    matrix_ports_t     ports;
+};
+
+TEST_F(MatrixPorts, ConsecutivePinsAreReadTogether) {
+    init({GPIO_MOCK_PIN(1, 0), GPIO_MOCK_PIN(1, 1), GPIO_MOCK_PIN(1, 2), GPIO_MOCK_PIN(1, 3), GPIO_MOCK_PIN(1, 4), GPIO_MOCK_PIN(1, 5), GPIO_MOCK_PIN(1, 6), GPIO_MOCK_PIN(1, 7), GPIO_MOCK_PIN(1, 8), GPIO_MOCK_PIN(1, 9), GPIO_MOCK_PIN(1, 10), GPIO_MOCK_PIN(1, 11)});
+    EXPECT_EQ(ports.port_count, 1);
+    EXPECT_EQ(ports.run_count, 1);
+
+    press(0x0A41);
+    uint32_t reads = gpio_mock_read_count();
+    EXPECT_EQ(matrix_ports_read_low(&ports), 0x0A41);
+    EXPECT_EQ(gpio_mock_read_count() - reads, 1);
+}
+
+TEST_F(MatrixPorts, MixedPinsMatchPerPinReads) {
+    // Two ports, out of order, with gaps, a run that's broken by a pin of another port, and a missing pin
+    init({GPIO_MOCK_PIN(0, 4), GPIO_MOCK_PIN(0, 5), GPIO_MOCK_PIN(2, 6), GPIO_MOCK_PIN(0, 6), GPIO_MOCK_PIN(0, 3), GPIO_MOCK_PIN(2, 0), GPIO_MOCK_PIN(2, 1), NO_PIN, GPIO_MOCK_PIN(2, 3), GPIO_MOCK_PIN(0, 15), GPIO_MOCK_PIN(1, 0), GPIO_MOCK_PIN(2, 15)});
+    EXPECT_EQ(ports.port_count, 3);
+
+    for (uint32_t keys = 0; keys < (1UL << MATRIX_COLS); keys++) {
+        press(keys);
+        ASSERT_EQ(matrix_ports_read_low(&ports), read_pins()) << std::hex << keys;
+    }
+}
+
+TEST_F(MatrixPorts, RandomPinoutsMatchPerPinReads) {
+    uint32_t random = 12345;
+    for (int layout = 0; layout < 200; layout++) {
+        // Distinct pins, mostly packed into a few ports so that runs form
+        std::vector<pin_t> pins;
+        while (pins.size() < MATRIX_COLS) {
+            random    = random * 1103515245 + 12345;
+            pin_t pin = (random >> 16) % 8 == 0 ? NO_PIN : GPIO_MOCK_PIN((random >> 20) % 3, (random >> 24) % 16);
+            if (pin == NO_PIN || std::find(pins.begin(), pins.end(), pin) == pins.end()) {
+                pins.push_back(pin);
+            }
+        }
+        gpio_mock_reset();
+        setPinOutput(ROW);
+        writePinLow(ROW);
+        init(pins);
+
+        for (int i = 0; i < 50; i++) {
+            random = random * 1103515245 + 12345;
+            press(random >> 8);
+            ASSERT_EQ(matrix_ports_read_low(&ports), read_pins()) << "layout " << layout;
+        }
+    }
+}
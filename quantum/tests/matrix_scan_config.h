@@ -0,0 +1,34 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// quantum/matrix.c on the GPIO mock: two rows on one port, and columns spread over two others
+
+#pragma once
+
+#include "gpio.h"
+
+#define MATRIX_ROWS 2
+#define MATRIX_COLS 4
+
+#define MATRIX_ROW_PINS \
+    { GPIO_MOCK_PIN(0, 0), GPIO_MOCK_PIN(0, 1) }
+#define MATRIX_COL_PINS \
+    { GPIO_MOCK_PIN(1, 4), GPIO_MOCK_PIN(1, 5), GPIO_MOCK_PIN(2, 6), GPIO_MOCK_PIN(1, 7) }
+#define DIODE_DIRECTION COL2ROW
+
+#define DEBOUNCE 5
+#define IGNORE_ATOMIC_BLOCK
@@ -0,0 +1,152 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix.h"
+#include "matrix_idle.h"
+#include "timer.h"
+
+void advance_time(uint32_t ms);
+}
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+// Pins armed as wake up sources, and a key the next sleep presses part way through, as an interrupt would
+static std::vector<pin_t> armed;
+static std::vector<pin_t> armed_while_asleep;
+static int                press_during_sleep_after = -1;
+static uint8_t            press_row, press_col;
+
+extern "C" {
+void matrix_init_quantum(void) {}
+
+void matrix_scan_quantum(void) {}
+
+void matrix_idle_enable_wake(pin_t pin) { armed.push_back(pin); }
+
+void matrix_idle_disable_wake(pin_t pin) { armed.erase(std::remove(armed.begin(), armed.end(), pin), armed.end()); }
+
+bool matrix_idle_sleep(uint16_t timeout) {
+    armed_while_asleep = armed;
+    if (press_during_sleep_after >= 0 && press_during_sleep_after < timeout) {
+        advance_time(press_during_sleep_after);
+        press_during_sleep_after = -1;
+        gpio_mock_switch(col_pins[press_col], row_pins[press_row], true);
+        return true;
+    }
+    advance_time(timeout);
+    return false;
+}
+}
+
+class MatrixScan : public testing::Test {
+   public:
+    void SetUp() override {
+        gpio_mock_reset();
+        armed.clear();
+        armed_while_asleep.clear();
+        press_during_sleep_after = -1;
+        matrix_init();
+
+        // Start from an active matrix, a bounce too short to be debounced
+        press(0, 0);
+        matrix_scan();
+        release(0, 0);
+        matrix_scan();
+        advance_time(1);
+
+        stats = *matrix_idle_get_stats();
+    }
+
+    void press(uint8_t row, uint8_t col) { gpio_mock_switch(col_pins[col], row_pins[row], true); }
+    void release(uint8_t row, uint8_t col) { gpio_mock_switch(col_pins[col], row_pins[row], false); }
+
+    // Scans once a millisecond
+    void scan_for(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            matrix_scan();
+            advance_time(1);
+        }
+    }
+
+    uint32_t sleeps() { return matrix_idle_get_stats()->sleeps - stats.sleeps; }
+    uint32_t wakes() { return matrix_idle_get_stats()->wakes - stats.wakes; }
+
+    matrix_idle_stats_t stats;
+};
+
+TEST_F(MatrixScan, ReadsKeysThroughThePins) {
+    press(1, 2);
+    scan_for(DEBOUNCE + 2);
+    EXPECT_EQ(matrix_get_row(0), 0);
+    EXPECT_EQ(matrix_get_row(1), 1 << 2);
+
+    release(1, 2);
+    scan_for(DEBOUNCE + 2);
+    EXPECT_EQ(matrix_get_row(1), 0);
+}
+
+TEST_F(MatrixScan, ArmsTheColumnsWhileIdle) {
+    scan_for(MATRIX_IDLE_TIMEOUT - 1);
+    EXPECT_EQ(sleeps(), 0);
+
+    scan_for(1);
+    EXPECT_EQ(sleeps(), 1);
+    std::vector<pin_t> columns(col_pins, col_pins + MATRIX_COLS);
+    EXPECT_EQ(armed_while_asleep, columns);
+
+    // Disarmed again, with the rows back to their unselected state
+    EXPECT_TRUE(armed.empty());
+    for (pin_t pin : row_pins) {
+        EXPECT_EQ(gpio_mock_get_mode(pin), GPIO_MOCK_INPUT_HIGH);
+    }
+}
+
+TEST_F(MatrixScan, KeyDownIsFoundThroughAnyRow) {
+    scan_for(MATRIX_IDLE_TIMEOUT);
+    EXPECT_EQ(sleeps(), 1);
+
+    // Pressed between two scans, it is found while armed, before going to sleep
+    press(1, 3);
+    uint32_t before = timer_read32();
+    scan_for(1);
+    EXPECT_EQ(wakes(), 1);
+    EXPECT_EQ(timer_read32() - before, 1);
+    release(1, 3);
+}
+
+TEST_F(MatrixScan, WakeLatencyIsTakenAtTheDebouncedPress) {
+    scan_for(MATRIX_IDLE_TIMEOUT);
+    EXPECT_EQ(sleeps(), 1);
+
+    press_during_sleep_after = 3;
+    press_row                = 0;
+    press_col                = 1;
+    scan_for(DEBOUNCE + 2);
+    EXPECT_EQ(wakes(), 1);
+    EXPECT_EQ(matrix_get_row(0), 1 << 1);
+
+    // The press comes through sym_defer_g once it has been stable for longer than DEBOUNCE
+    EXPECT_EQ(matrix_idle_get_stats()->last_wake_latency, DEBOUNCE + 1);
+    release(0, 1);
+}
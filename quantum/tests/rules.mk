@@ -0,0 +1,38 @@
+color_DEFS := -DNO_DEBUG
+
+color_SRC := \
+	$(QUANTUM_PATH)/tests/color_tests.cpp \
+	$(QUANTUM_PATH)/color.c
+
+deferred_exec_DEFS := -DNO_DEBUG -DDEFERRED_EXEC_RESERVED_TASKS=1
+
+deferred_exec_SRC := \
+	$(QUANTUM_PATH)/tests/deferred_exec_tests.cpp \
+	$(QUANTUM_PATH)/deferred_exec.c \
+	$(TMK_PATH)/common/test/timer.c
+
+# The GPIO mock stands in for the platform's pins
+matrix_ports_DEFS := -DNO_DEBUG -DMATRIX_ROWS=1 -DMATRIX_COLS=12
+matrix_ports_CONFIG := $(TMK_PATH)/common/test/gpio.h
+matrix_ports_INC := $(TMK_PATH)/common/test
+
+matrix_ports_SRC := \
+	$(QUANTUM_PATH)/tests/matrix_ports_tests.cpp \
+	$(QUANTUM_PATH)/matrix_ports.c \
+	$(TMK_PATH)/common/test/gpio.c
+
+# quantum/matrix.c, with idle scan suspension
+matrix_scan_DEFS := -DNO_DEBUG -DNO_PRINT -DMATRIX_IDLE_ENABLE
+matrix_scan_CONFIG := $(QUANTUM_PATH)/tests/matrix_scan_config.h
+matrix_scan_INC := $(TMK_PATH)/common/test
+
+matrix_scan_SRC := \
+	$(QUANTUM_PATH)/tests/matrix_scan_tests.cpp \
+	$(QUANTUM_PATH)/matrix.c \
+	$(QUANTUM_PATH)/matrix_common.c \
+	$(QUANTUM_PATH)/matrix_ports.c \
+	$(QUANTUM_PATH)/matrix_idle.c \
+	$(QUANTUM_PATH)/debounce/sym_defer_g.c \
+	$(TMK_PATH)/common/util.c \
+	$(TMK_PATH)/common/test/timer.c \
+	$(TMK_PATH)/common/test/gpio.c
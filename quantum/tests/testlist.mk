@@ -0,0 +1 @@
+TEST_LIST += color deferred_exec matrix_ports matrix_scan
@@ -45,8 +45,13 @@
 #include "raw_hid.h"
 #include "dynamic_keymap.h"
 #include "tmk_core/common/eeprom.h"
+#include "eeprom_deferred.h"
 #include "version.h"  // for QMK_BUILDDATE used in EEPROM magic
 
+#ifdef SPLIT_TELEMETRY_ENABLE
+#    include "split_telemetry.h"
+#endif
+
 // Forward declare some helpers.
 #if defined(VIA_QMK_BACKLIGHT_ENABLE)
 void via_qmk_backlight_set_value(uint8_t *data);
@@ -77,9 +82,12 @@ void via_eeprom_set_valid(bool valid) {
     uint8_t magic1 = ((p[5] & 0x0F) << 4) | (p[6] & 0x0F);
     uint8_t magic2 = ((p[8] & 0x0F) << 4) | (p[9] & 0x0F);
 
-    eeprom_update_byte((void *)VIA_EEPROM_MAGIC_ADDR + 0, valid ? magic0 : 0xFF);
-    eeprom_update_byte((void *)VIA_EEPROM_MAGIC_ADDR + 1, valid ? magic1 : 0xFF);
-    eeprom_update_byte((void *)VIA_EEPROM_MAGIC_ADDR + 2, valid ? magic2 : 0xFF);
+    uint8_t magic[3] = {valid ? magic0 : 0xFF, valid ? magic1 : 0xFF, valid ? magic2 : 0xFF};
+    // The magic is written straight away, so the data it vouches for must be in EEPROM first
+    if (valid) {
+        eeprom_deferred_flush();
+    }
+    eeprom_update_block(magic, (void *)VIA_EEPROM_MAGIC_ADDR, sizeof(magic));
 }
 
 // Flag QMK and VIA/keyboard level EEPROM as invalid.
@@ -102,6 +110,9 @@ __attribute__((weak)) void via_init_kb(void) {}
 
 // Called by QMK core to initialize dynamic keymaps etc.
 void via_init(void) {
+    // Load the dynamic keymaps into RAM before anything reads them.
+    dynamic_keymap_init();
+
     // Let keyboard level test EEPROM valid state,
     // but not set it valid, it is done here.
     via_init_kb();
@@ -126,23 +137,23 @@ void via_init(void) {
 uint32_t via_get_layout_options(void) {
     uint32_t value = 0;
     // Start at the most significant byte
-    void *source = (void *)(VIA_EEPROM_LAYOUT_OPTIONS_ADDR);
+    uint8_t data[VIA_EEPROM_LAYOUT_OPTIONS_SIZE];
+    eeprom_deferred_read_block(data, (void *)VIA_EEPROM_LAYOUT_OPTIONS_ADDR, VIA_EEPROM_LAYOUT_OPTIONS_SIZE);
     for (uint8_t i = 0; i < VIA_EEPROM_LAYOUT_OPTIONS_SIZE; i++) {
         value = value << 8;
-        value |= eeprom_read_byte(source);
-        source++;
+        value |= data[i];
     }
     return value;
 }
 
 void via_set_layout_options(uint32_t value) {
     // Start at the least significant byte
-    void *target = (void *)(VIA_EEPROM_LAYOUT_OPTIONS_ADDR + VIA_EEPROM_LAYOUT_OPTIONS_SIZE - 1);
-    for (uint8_t i = 0; i < VIA_EEPROM_LAYOUT_OPTIONS_SIZE; i++) {
-        eeprom_update_byte(target, value & 0xFF);
-        value = value >> 8;
-        target--;
+    uint8_t data[VIA_EEPROM_LAYOUT_OPTIONS_SIZE];
+    for (int8_t i = VIA_EEPROM_LAYOUT_OPTIONS_SIZE - 1; i >= 0; i--) {
+        data[i] = value & 0xFF;
+        value   = value >> 8;
     }
+    eeprom_deferred_update_block(data, (void *)VIA_EEPROM_LAYOUT_OPTIONS_ADDR, VIA_EEPROM_LAYOUT_OPTIONS_SIZE);
 }
 
 // Called by QMK core to process VIA-specific keycodes.
@@ -266,6 +277,17 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
             }
             break;
         }
+#ifdef SPLIT_TELEMETRY_ENABLE
+        case id_split_telemetry: {
+            // command_data[0] is the page of counters to read, or 0xFF to reset them
+            if (command_data[0] == 0xFF) {
+                split_telemetry_reset();
+            } else {
+                split_telemetry_pack(command_data[0], &command_data[1], length - 2);
+            }
+            break;
+        }
+#endif
         case id_dynamic_keymap_get_keycode: {
             uint16_t keycode = dynamic_keymap_get_keycode(command_data[0], command_data[1], command_data[2]);
             command_data[3]  = keycode >> 8;
@@ -380,6 +402,7 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
             raw_hid_send(data, length);
             // Give host time to read it
             wait_ms(100);
+            eeprom_deferred_flush();
             bootloader_jump();
             break;
         }
@@ -78,13 +78,14 @@ enum via_command_id {
     id_dynamic_keymap_get_layer_count       = 0x11,
     id_dynamic_keymap_get_buffer            = 0x12,
     id_dynamic_keymap_set_buffer            = 0x13,
+    id_split_telemetry                      = 0xFE,  // outside of the VIA range, reads a page of counters, or resets them
     id_unhandled                            = 0xFF,
 };
 
 enum via_keyboard_value_id {
     id_uptime              = 0x01,  //
     id_layout_options      = 0x02,
-    id_switch_matrix_state = 0x03
+    id_switch_matrix_state = 0x03,
 };
 
 enum via_lighting_value {
@@ -0,0 +1,428 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+enum { AB_X, ABC_Y, CD_Z, EF_ACTION, BA_W };
+
+extern "C" {
+const uint16_t PROGMEM ab_combo[]  = {KC_A, KC_B, COMBO_END};
+const uint16_t PROGMEM abc_combo[] = {KC_A, KC_B, KC_C, COMBO_END};
+const uint16_t PROGMEM cd_combo[]  = {KC_C, KC_D, COMBO_END};
+const uint16_t PROGMEM ef_combo[]  = {KC_E, KC_F, COMBO_END};
+const uint16_t PROGMEM ba_combo[]  = {KC_B, KC_A, COMBO_END};
+
+combo_t key_combos[COMBO_COUNT] = {
+    [AB_X]      = COMBO(ab_combo, KC_X),
+    [ABC_Y]     = COMBO(abc_combo, KC_Y),
+    [CD_Z]      = COMBO(cd_combo, KC_Z),
+    [EF_ACTION] = COMBO_ACTION(ef_combo),
+    // Same keys as AB_X, which is defined first and wins
+    [BA_W] = COMBO(ba_combo, KC_W),
+};
+
+uint16_t get_combo_term(uint16_t index, combo_t *combo) {
+    switch (index) {
+        case ABC_Y:
+            return 100;
+        case CD_Z:
+            return 20;
+        default:
+            return COMBO_TERM;
+    }
+}
+}
+
+static std::vector<std::pair<uint16_t, bool>> combo_events;
+
+extern "C" void process_combo_event(uint16_t combo_index, bool pressed) { combo_events.push_back({combo_index, pressed}); }
+
+// Keys on row 0, from A to J
+#define COL(keycode) ((keycode)-KC_A)
+
+class Combo : public TestFixture {
+   public:
+    void SetUp() override { combo_events.clear(); }
+
+    void TearDown() override {
+        // Nothing may be left buffered or held
+        testing::Mock::VerifyAndClearExpectations(&driver);
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    }
+
+    void press(uint16_t keycode) {
+        press_key(COL(keycode), 0);
+        run_one_scan_loop();
+    }
+
+    void release(uint16_t keycode) {
+        release_key(COL(keycode), 0);
+        run_one_scan_loop();
+    }
+
+    TestDriver driver;
+};
+
+TEST_F(Combo, ShortestComboWaitsForLongerOne) {
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(KC_A);
+    press(KC_B);
+    // ABC_Y could still follow
+    idle_for(98);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    idle_for(1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The combo was already released with the first key
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    release(KC_B);
+}
+
+TEST_F(Combo, LongestComboFiresWithoutWaiting) {
+    InSequence s;
+    press(KC_A);
+    press(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Y)));
+    press(KC_C);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_B);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    release(KC_A);
+    release(KC_C);
+}
+
+TEST_F(Combo, OrderOfKeysDoesNotMatter) {
+    InSequence s;
+    press(KC_C);
+    press(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Y)));
+    press(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+    release(KC_B);
+    release(KC_C);
+}
+
+TEST_F(Combo, ComboWithoutLongerCandidatesFiresImmediately) {
+    InSequence s;
+    press(KC_D);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    press(KC_C);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_C);
+    release(KC_D);
+}
+
+TEST_F(Combo, ReleasingAKeyDecidesTheCombo) {
+    InSequence s;
+    press(KC_A);
+    press(KC_B);
+    // Tapping AB_X doesn't have to wait for ABC_Y to time out
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_B);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    release(KC_A);
+}
+
+TEST_F(Combo, ReleasingAKeyWithoutComboSendsIt) {
+    InSequence s;
+    press(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+}
+
+TEST_F(Combo, LoneKeyIsSentAfterItsTerm) {
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(KC_A);
+    // ABC_Y has the longest term of the combos of A
+    idle_for(99);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    idle_for(1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+}
+
+TEST_F(Combo, PerComboTerm) {
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(KC_D);
+    idle_for(19);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // CD_Z only waits for 20ms
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    idle_for(1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Too late for the combo, C waits for combos of its own
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(KC_C);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_D);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_C);
+}
+
+TEST_F(Combo, ExpiredCombosAreIgnored) {
+    InSequence s;
+    press(KC_A);
+    idle_for(60);
+    // AB_X has timed out, but ABC_Y hasn't
+    press(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(38);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    idle_for(1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // B starts over, and could still be part of a combo with another press of A
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(60);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_B)));
+    idle_for(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+    release(KC_B);
+}
+
+TEST_F(Combo, OtherKeySendsBufferedKeysFirst) {
+    InSequence s;
+    press(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_G)));
+    press(KC_G);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_G)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+    release(KC_G);
+}
+
+TEST_F(Combo, OtherKeyFiresCompletedCombo) {
+    InSequence s;
+    press(KC_A);
+    press(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X, KC_G)));
+    press(KC_G);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_G)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+    release(KC_B);
+    release(KC_G);
+}
+
+TEST_F(Combo, KeyThatBreaksTheComboIsLookedAtAgain) {
+    InSequence s;
+    press(KC_A);
+    press(KC_B);
+    // There is no combo with A, B and D, but D may still be part of CD_Z
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    press(KC_D);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X, KC_Z)));
+    press(KC_C);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+    release(KC_D);
+    release(KC_B);
+    release(KC_C);
+}
+
+TEST_F(Combo, KeysWithoutComboAreLookedAtAgain) {
+    InSequence s;
+    press(KC_E);
+    // E and A aren't a combo, E is sent and A starts over
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E)));
+    press(KC_A);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E, KC_Y)));
+    press(KC_B);
+    press(KC_C);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Y)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_E);
+    release(KC_A);
+    release(KC_B);
+    release(KC_C);
+}
+
+TEST_F(Combo, BufferedKeysAreSentInOrder) {
+    InSequence s;
+    press(KC_C);
+    press(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(90);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Released before ABC_Y was complete
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C, KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    release(KC_A);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_C);
+}
+
+TEST_F(Combo, FirstDefinedComboWinsTies) {
+    InSequence s;
+    press(KC_B);
+    press(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+    release(KC_B);
+}
+
+TEST_F(Combo, ComboActions) {
+    press(KC_E);
+    press(KC_F);
+    release(KC_F);
+    release(KC_E);
+    std::vector<std::pair<uint16_t, bool>> expected = {{EF_ACTION, true}, {EF_ACTION, false}};
+    EXPECT_EQ(combo_events, expected);
+}
+
+TEST_F(Combo, SeveralCombosCanBeHeld) {
+    InSequence s;
+    press(KC_C);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    press(KC_D);
+    press(KC_E);
+    press(KC_F);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    std::vector<std::pair<uint16_t, bool>> expected = {{EF_ACTION, true}};
+    EXPECT_EQ(combo_events, expected);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_D);
+    release(KC_E);
+    expected.push_back({EF_ACTION, false});
+    EXPECT_EQ(combo_events, expected);
+    release(KC_C);
+    release(KC_F);
+}
+
+TEST_F(Combo, ComboIsNotFiredWhenTooManyAreHeld) {
+    InSequence s;
+    press(KC_C);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    press(KC_D);
+    press(KC_E);
+    press(KC_F);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Its keys are sent on their own instead, so that nothing gets stuck
+    press(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z, KC_A)));
+    press(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z, KC_A, KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z, KC_B)));
+    release(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    release(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_C);
+    release(KC_D);
+    release(KC_E);
+    release(KC_F);
+    std::vector<std::pair<uint16_t, bool>> expected = {{EF_ACTION, true}, {EF_ACTION, false}};
+    EXPECT_EQ(combo_events, expected);
+}
+
+TEST_F(Combo, ComboCanBeRepeated) {
+    InSequence s;
+    for (int i = 0; i < 3; i++) {
+        press(KC_C);
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+        press(KC_D);
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+        release(KC_C);
+        release(KC_D);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+}
+
+TEST_F(Combo, DisablingSendsBufferedKeys) {
+    InSequence s;
+    press(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    combo_disable();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Combo keys are just keys now
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_B)));
+    press(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_A);
+    release(KC_B);
+    combo_enable();
+}
+
+TEST_F(Combo, HeldComboIsReleasedWhileDisabled) {
+    InSequence s;
+    press(KC_C);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    press(KC_D);
+    combo_disable();
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release(KC_C);
+    release(KC_D);
+    combo_enable();
+}
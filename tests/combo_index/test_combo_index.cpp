@@ -0,0 +1,228 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+enum { AB_ESC, CDE_TAB };
+
+// Keys on rows 1 to 3, which the generated combos are made of
+static const uint16_t pool[] = {
+    KC_K, KC_L, KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_F1, KC_F2, KC_F3, KC_F4, KC_F5, KC_F6, KC_F7, KC_F8, KC_F9, KC_F10, KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0,
+};
+static const uint8_t pool_size = sizeof(pool) / sizeof(pool[0]);
+
+static uint16_t combo_keys[COMBO_COUNT][MAX_COMBO_LENGTH + 1];
+
+extern "C" combo_t key_combos[COMBO_COUNT];
+combo_t            key_combos[COMBO_COUNT];
+
+static std::vector<std::pair<uint16_t, bool>> combo_events;
+
+extern "C" void process_combo_event(uint16_t combo_index, bool pressed) { combo_events.push_back({combo_index, pressed}); }
+
+static keypos_t key_position(uint16_t keycode) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (keymap_key_to_keycode(0, (keypos_t){.col = col, .row = row}) == keycode) {
+                return (keypos_t){.col = col, .row = row};
+            }
+        }
+    }
+    return (keypos_t){.col = 0, .row = 0};
+}
+
+// How process_combo() used to find the combos of a key, walking the keys of every combo
+static uint16_t scan_combos(uint16_t keycode) {
+    uint16_t found = 0;
+    for (uint16_t i = 0; i < COMBO_COUNT; i++) {
+        for (const uint16_t *keys = key_combos[i].keys;; keys++) {
+            uint16_t key = pgm_read_word(keys);
+            if (key == keycode) found++;
+            if (key == COMBO_END) break;
+        }
+    }
+    return found;
+}
+
+class ComboIndex : public TestFixture {
+   public:
+    static void SetUpTestCase() {
+        combo_keys[AB_ESC][0]  = KC_A;
+        combo_keys[AB_ESC][1]  = KC_B;
+        key_combos[AB_ESC]     = COMBO(combo_keys[AB_ESC], KC_ESC);
+        combo_keys[CDE_TAB][0] = KC_C;
+        combo_keys[CDE_TAB][1] = KC_D;
+        combo_keys[CDE_TAB][2] = KC_E;
+        key_combos[CDE_TAB]    = COMBO(combo_keys[CDE_TAB], KC_TAB);
+
+        // Two to four distinct keys from the pool, so that every pool key is in about 50 combos
+        uint32_t random = 12345;
+        for (uint16_t i = CDE_TAB + 1; i < COMBO_COUNT; i++) {
+            random        = random * 1103515245 + 12345;
+            uint8_t count = 2 + (random >> 16) % 3;
+            uint8_t first = (random >> 20) % pool_size;
+            for (uint8_t j = 0; j < count; j++) {
+                combo_keys[i][j] = pool[(first + j * 7) % pool_size];
+            }
+            key_combos[i] = COMBO_ACTION(combo_keys[i]);
+        }
+        TestFixture::SetUpTestCase();
+    }
+
+    void SetUp() override { combo_events.clear(); }
+
+    void press(uint16_t keycode) {
+        keypos_t key = key_position(keycode);
+        press_key(key.col, key.row);
+    }
+
+    void release(uint16_t keycode) {
+        keypos_t key = key_position(keycode);
+        release_key(key.col, key.row);
+    }
+};
+
+TEST_F(ComboIndex, CombosAreTriggered) {
+    TestDriver driver;
+    InSequence s;
+
+    press(KC_A);
+    run_one_scan_loop();
+    press(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    run_one_scan_loop();
+
+    release(KC_A);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    release(KC_B);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    idle_for(COMBO_TERM + 10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    press(KC_E);
+    run_one_scan_loop();
+    press(KC_C);
+    run_one_scan_loop();
+    press(KC_D);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_TAB)));
+    run_one_scan_loop();
+
+    release(KC_C);
+    release(KC_D);
+    release(KC_E);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    idle_for(COMBO_TERM + 10);
+}
+
+TEST_F(ComboIndex, OtherKeysPassThrough) {
+    TestDriver driver;
+    InSequence s;
+
+    press(KC_G);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_G)));
+    run_one_scan_loop();
+    release(KC_G);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(ComboIndex, UnfinishedCombosAreSentAfterTheTerm) {
+    TestDriver driver;
+    InSequence s;
+
+    press(KC_C);
+    run_one_scan_loop();
+    press(KC_D);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(COMBO_TERM - 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Buffered keys are sent as they were pressed
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C, KC_D)));
+    idle_for(2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release(KC_C);
+    release(KC_D);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    idle_for(COMBO_TERM + 10);
+}
+
+TEST_F(ComboIndex, ReportsTheIndexOfTheCombo) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // Of the generated combos with the same keys as the last one, the first one defined fires
+    uint16_t last     = COMBO_COUNT - 1;
+    uint16_t expected = 0;
+    while (memcmp(combo_keys[expected], combo_keys[last], sizeof(combo_keys[last])) != 0) {
+        expected++;
+    }
+
+    for (uint8_t i = 0; combo_keys[last][i] != COMBO_END; i++) {
+        press(combo_keys[last][i]);
+        run_one_scan_loop();
+    }
+    for (uint8_t i = 0; combo_keys[last][i] != COMBO_END; i++) {
+        release(combo_keys[last][i]);
+        run_one_scan_loop();
+    }
+
+    std::vector<std::pair<uint16_t, bool>> expected_events = {{expected, true}, {expected, false}};
+    EXPECT_EQ(combo_events, expected_events);
+}
+
+TEST_F(ComboIndex, Benchmark) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    const int iterations = 2000;
+    for (uint16_t keycode : {KC_G, KC_K}) {
+        volatile uint16_t sink  = 0;
+        auto              start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            sink = scan_combos(keycode);
+        }
+        auto scan = std::chrono::steady_clock::now() - start;
+        (void)sink;
+
+        // Only presses are timed, releasing a combo key sends it to the host
+        keyrecord_t                          record = {.event = {.key = key_position(keycode), .pressed = true, .time = 1}};
+        std::chrono::steady_clock::duration indexed{0};
+        for (int i = 0; i < iterations; i++) {
+            record.event.pressed = true;
+            start                = std::chrono::steady_clock::now();
+            process_combo(keycode, &record);
+            indexed += std::chrono::steady_clock::now() - start;
+            record.event.pressed = false;
+            process_combo(keycode, &record);
+        }
+
+        printf("%u combos, key in %3u of them: scan %7.1f ns/event, indexed %7.1f ns/event\n", COMBO_COUNT, scan_combos(keycode), std::chrono::duration<double, std::nano>(scan).count() / iterations, std::chrono::duration<double, std::nano>(indexed).count() / iterations);
+    }
+    idle_for(COMBO_TERM + 10);
+}
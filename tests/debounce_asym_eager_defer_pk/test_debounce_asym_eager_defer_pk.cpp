@@ -0,0 +1,165 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix.h"
+#include "debounce.h"
+#include "timer.h"
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+class DebounceAsymEagerDeferPk : public ::testing::Test {
+   public:
+    void SetUp() override {
+        set_time(1000);
+        debounce_init(MATRIX_ROWS);
+        memset(raw, 0, sizeof(raw));
+        memset(cooked, 0, sizeof(cooked));
+        memset(previous, 0, sizeof(previous));
+    }
+
+    // Runs a 1 ms scan with the current raw matrix
+    void scan() {
+        advance_time(1);
+        debounce(raw, cooked, MATRIX_ROWS, memcmp(raw, previous, sizeof(raw)) != 0);
+        memcpy(previous, raw, sizeof(raw));
+    }
+
+    // Scans until the key reads as expected, and returns how many scans that took
+    int scans_until(uint8_t row, uint8_t col, bool pressed, int limit = 100) {
+        for (int i = 0; i < limit; i++) {
+            if (is_pressed(row, col) == pressed) {
+                return i;
+            }
+            scan();
+        }
+        return -1;
+    }
+
+    // Lets any running counters expire
+    void idle() {
+        for (int i = 0; i < 2 * DEBOUNCE; i++) {
+            scan();
+        }
+    }
+
+    bool is_pressed(uint8_t row, uint8_t col) { return cooked[row] & ((matrix_row_t)1 << col); }
+    void set(uint8_t row, uint8_t col, bool pressed) { raw[row] = pressed ? raw[row] | ((matrix_row_t)1 << col) : raw[row] & ~((matrix_row_t)1 << col); }
+
+    matrix_row_t raw[MATRIX_ROWS];
+    matrix_row_t cooked[MATRIX_ROWS];
+    matrix_row_t previous[MATRIX_ROWS];
+};
+
+TEST_F(DebounceAsymEagerDeferPk, PressIsImmediate) {
+    set(1, 3, true);
+    scan();
+    EXPECT_TRUE(is_pressed(1, 3));
+}
+
+TEST_F(DebounceAsymEagerDeferPk, ReleaseIsDeferred) {
+    set(1, 3, true);
+    scan();
+    idle();
+    set(1, 3, false);
+    // The scan that first reads the release, then DEBOUNCE ms more
+    EXPECT_EQ(scans_until(1, 3, false), DEBOUNCE + 1);
+}
+
+TEST_F(DebounceAsymEagerDeferPk, BouncesAfterPressAreIgnored) {
+    set(0, 0, true);
+    scan();
+    for (int i = 0; i < DEBOUNCE - 1; i++) {
+        set(0, 0, i % 2);
+        scan();
+        EXPECT_TRUE(is_pressed(0, 0));
+    }
+    set(0, 0, true);
+    for (int i = 0; i < 20; i++) {
+        scan();
+        EXPECT_TRUE(is_pressed(0, 0));
+    }
+}
+
+TEST_F(DebounceAsymEagerDeferPk, ChatterOnReleaseIsRejected) {
+    set(2, 5, true);
+    scan();
+    idle();
+
+    // The contacts chatter while the key is released, which never lasts DEBOUNCE ms
+    for (int i = 0; i < 30; i++) {
+        set(2, 5, i % (DEBOUNCE - 1) != 0);
+        scan();
+        EXPECT_TRUE(is_pressed(2, 5));
+    }
+
+    // Then they settle
+    set(2, 5, false);
+    EXPECT_EQ(scans_until(2, 5, false), DEBOUNCE + 1);
+}
+
+TEST_F(DebounceAsymEagerDeferPk, ReleaseDuringPressLockoutIsPushedLater) {
+    set(3, 9, true);
+    scan();
+    set(3, 9, false);
+    scan();
+    EXPECT_TRUE(is_pressed(3, 9));
+
+    // The release is only looked at once the press has been debounced, and is deferred from there
+    int scans = scans_until(3, 9, false);
+    EXPECT_GE(scans, DEBOUNCE);
+    EXPECT_LE(scans, 2 * DEBOUNCE);
+}
+
+TEST_F(DebounceAsymEagerDeferPk, KeysAreIndependent) {
+    set(0, 1, true);
+    scan();
+    idle();
+    set(0, 1, false);
+    scan();
+
+    // Another key in the same row is pressed while the first one's release is pending
+    set(0, 2, true);
+    scan();
+    EXPECT_TRUE(is_pressed(0, 2));
+    EXPECT_TRUE(is_pressed(0, 1));
+
+    EXPECT_EQ(scans_until(0, 1, false), DEBOUNCE - 1);
+    EXPECT_TRUE(is_pressed(0, 2));
+}
+
+TEST_F(DebounceAsymEagerDeferPk, PressRightAfterAReleaseIsKept) {
+    set(1, 4, true);
+    scan();
+    idle();
+    set(1, 4, false);
+    for (int i = 0; i < DEBOUNCE; i++) {
+        scan();
+        EXPECT_TRUE(is_pressed(1, 4));
+    }
+
+    // The key is pressed again on the scan that pushes its release, so both are kept
+    set(1, 4, true);
+    scan();
+    EXPECT_FALSE(is_pressed(1, 4));
+    scan();
+    EXPECT_TRUE(is_pressed(1, 4));
+}
@@ -0,0 +1,185 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+// Both algorithms are built into their own namespace, so that they can run side by side
+namespace eager_pk {
+#include "debounce/sym_eager_pk.c"
+}
+namespace eager_pk_bp {
+#include "debounce/sym_eager_pk_bp.c"
+}
+
+// The same again with a longer debounce time, that needs more bit planes
+#undef DEBOUNCE
+#undef DEBOUNCE_PLANES
+#undef MAX_ELAPSED
+#define DEBOUNCE 20
+namespace eager_pk_20 {
+#include "debounce/sym_eager_pk.c"
+}
+namespace eager_pk_bp_20 {
+#include "debounce/sym_eager_pk_bp.c"
+}
+
+typedef void (*debounce_f)(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+
+// Keys that are pressed and released at random, and bounce for a few milliseconds each time
+class BouncingMatrix {
+   public:
+    explicit BouncingMatrix(unsigned seed) : seed(seed) {
+        memset(target, 0, sizeof(target));
+        memset(bounce_until, 0, sizeof(bounce_until));
+        memset(raw, 0, sizeof(raw));
+    }
+
+    // Moves time on by 0 to 2 ms, and returns whether the raw matrix changed
+    bool scan(int toggle_chance) {
+        advance_time(rand_r(&seed) % 3);
+        uint32_t     now = timer_read32();
+        matrix_row_t previous[MATRIX_ROWS];
+        memcpy(previous, raw, sizeof(raw));
+
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                matrix_row_t mask = (matrix_row_t)1 << col;
+                if (rand_r(&seed) % toggle_chance == 0) {
+                    target[row] ^= mask;
+                    bounce_until[row][col] = now + rand_r(&seed) % 4;
+                }
+                bool pressed = now < bounce_until[row][col] ? rand_r(&seed) % 2 : target[row] & mask;
+                raw[row]     = pressed ? raw[row] | mask : raw[row] & ~mask;
+            }
+        }
+        return memcmp(previous, raw, sizeof(raw)) != 0;
+    }
+
+    matrix_row_t raw[MATRIX_ROWS];
+
+   private:
+    unsigned     seed;
+    matrix_row_t target[MATRIX_ROWS];
+    uint32_t     bounce_until[MATRIX_ROWS][MATRIX_COLS];
+};
+
+static void expect_same_output(debounce_f reference, debounce_f bit_parallel, int scans, int toggle_chance) {
+    BouncingMatrix matrix(1234);
+    matrix_row_t   reference_cooked[MATRIX_ROWS]    = {0};
+    matrix_row_t   bit_parallel_cooked[MATRIX_ROWS] = {0};
+
+    for (int i = 0; i < scans; i++) {
+        bool changed = matrix.scan(toggle_chance);
+        reference(matrix.raw, reference_cooked, MATRIX_ROWS, changed);
+        bit_parallel(matrix.raw, bit_parallel_cooked, MATRIX_ROWS, changed);
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            ASSERT_EQ(reference_cooked[row], bit_parallel_cooked[row]) << "row " << (int)row << " differs after " << i << " scans";
+        }
+    }
+}
+
+TEST(DebounceBitParallel, SameAsEagerPerKey) {
+    set_time(1000);
+    eager_pk::debounce_init(MATRIX_ROWS);
+    eager_pk_bp::debounce_init(MATRIX_ROWS);
+    expect_same_output(eager_pk::debounce, eager_pk_bp::debounce, 100000, 200);
+}
+
+TEST(DebounceBitParallel, SameAsEagerPerKeyWhenBusy) {
+    set_time(5000);
+    eager_pk::debounce_init(MATRIX_ROWS);
+    eager_pk_bp::debounce_init(MATRIX_ROWS);
+    expect_same_output(eager_pk::debounce, eager_pk_bp::debounce, 100000, 10);
+}
+
+TEST(DebounceBitParallel, SameAsEagerPerKeyWithLongerDebounce) {
+    set_time(9000);
+    eager_pk_20::debounce_init(MATRIX_ROWS);
+    eager_pk_bp_20::debounce_init(MATRIX_ROWS);
+    expect_same_output(eager_pk_20::debounce, eager_pk_bp_20::debounce, 100000, 50);
+}
+
+TEST(DebounceBitParallel, PressIsImmediateAndLocked) {
+    set_time(20000);
+    eager_pk_bp::debounce_init(MATRIX_ROWS);
+    matrix_row_t raw[MATRIX_ROWS]    = {0};
+    matrix_row_t cooked[MATRIX_ROWS] = {0};
+
+    raw[2] = 0x0100;
+    eager_pk_bp::debounce(raw, cooked, MATRIX_ROWS, true);
+    EXPECT_EQ(cooked[2], 0x0100);
+
+    // Bounces are ignored until DEBOUNCE has passed
+    raw[2] = 0;
+    for (int i = 0; i < 5 - 1; i++) {
+        advance_time(1);
+        eager_pk_bp::debounce(raw, cooked, MATRIX_ROWS, i == 0);
+        EXPECT_EQ(cooked[2], 0x0100);
+    }
+    advance_time(1);
+    eager_pk_bp::debounce(raw, cooked, MATRIX_ROWS, false);
+    EXPECT_EQ(cooked[2], 0);
+}
+
+static double time_scans(debounce_f debounce, int scans) {
+    BouncingMatrix matrix(42);
+    matrix_row_t   cooked[MATRIX_ROWS] = {0};
+    // Pre-compute the input, so that only the debouncing is timed
+    matrix_row_t *raws    = new matrix_row_t[scans * MATRIX_ROWS];
+    bool *        changed = new bool[scans];
+    uint32_t *    times   = new uint32_t[scans];
+    for (int i = 0; i < scans; i++) {
+        changed[i] = matrix.scan(20);
+        times[i]   = timer_read32();
+        memcpy(&raws[i * MATRIX_ROWS], matrix.raw, sizeof(matrix.raw));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scans; i++) {
+        set_time(times[i]);
+        debounce(&raws[i * MATRIX_ROWS], cooked, MATRIX_ROWS, changed[i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    delete[] raws;
+    delete[] changed;
+    delete[] times;
+    return std::chrono::duration<double, std::nano>(end - start).count() / scans;
+}
+
+TEST(DebounceBitParallel, Benchmark) {
+    const int scans = 200000;
+    set_time(0);
+    eager_pk::debounce_init(MATRIX_ROWS);
+    eager_pk_bp::debounce_init(MATRIX_ROWS);
+
+    double per_key      = time_scans(eager_pk::debounce, scans);
+    double bit_parallel = time_scans(eager_pk_bp::debounce, scans);
+    printf("%dx%d matrix, DEBOUNCE %d: sym_eager_pk %.1f ns/scan, sym_eager_pk_bp %.1f ns/scan\n", MATRIX_ROWS, MATRIX_COLS, 5, per_key, bit_parallel);
+}
@@ -0,0 +1,135 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "eeprom_driver.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+// A custom EEPROM driver that counts how often it is accessed
+static uint8_t  eeprom_buffer[1024];
+static uint32_t eeprom_reads  = 0;
+static uint32_t eeprom_writes = 0;
+
+extern "C" {
+void eeprom_driver_init(void) {}
+
+void eeprom_driver_erase(void) { memset(eeprom_buffer, 0x00, sizeof(eeprom_buffer)); }
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    eeprom_reads++;
+    memcpy(buf, &eeprom_buffer[(uintptr_t)addr], len);
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    eeprom_writes++;
+    memcpy(&eeprom_buffer[(uintptr_t)addr], buf, len);
+}
+}
+
+class DynamicKeymap : public TestFixture {
+   public:
+    void SetUp() override {
+        dynamic_keymap_reset();
+        eeprom_reads  = 0;
+        eeprom_writes = 0;
+    }
+};
+
+TEST_F(DynamicKeymap, CacheIsEnabled) { EXPECT_TRUE(dynamic_keymap_is_cached()); }
+
+TEST_F(DynamicKeymap, KeyPressDoesNotReadEeprom) {
+    TestDriver driver;
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    keyboard_task();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+    EXPECT_EQ(eeprom_reads, 0);
+}
+
+TEST_F(DynamicKeymap, TransparentKeyOnHigherLayerDoesNotReadEeprom) {
+    TestDriver driver;
+    InSequence s;
+    press_key(2, 0);
+    keyboard_task();
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    keyboard_task();
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B, KC_C)));
+    keyboard_task();
+    release_key(0, 0);
+    release_key(1, 0);
+    release_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    keyboard_task();
+    keyboard_task();
+    keyboard_task();
+    EXPECT_EQ(eeprom_reads, 0);
+}
+
+TEST_F(DynamicKeymap, SetKeycodeWritesThroughToEeprom) {
+    TestDriver driver;
+    dynamic_keymap_set_keycode(0, 0, 0, KC_Z);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_Z);
+    // Big endian in EEPROM
+    EXPECT_EQ(eeprom_buffer[DYNAMIC_KEYMAP_EEPROM_ADDR + 0], 0x00);
+    EXPECT_EQ(eeprom_buffer[DYNAMIC_KEYMAP_EEPROM_ADDR + 1], KC_Z);
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    keyboard_task();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+}
+
+TEST_F(DynamicKeymap, SetBufferUpdatesCache) {
+    uint8_t data[] = {0x00, KC_X, 0x00, KC_Y};
+    dynamic_keymap_set_buffer(0, sizeof(data), data);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_X);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 1), KC_Y);
+    EXPECT_EQ(eeprom_buffer[DYNAMIC_KEYMAP_EEPROM_ADDR + 3], KC_Y);
+
+    // The whole buffer is compared and written as a single block
+    EXPECT_EQ(eeprom_reads, 1);
+    EXPECT_EQ(eeprom_writes, 1);
+
+    uint8_t read_back[4] = {};
+    dynamic_keymap_get_buffer(0, sizeof(read_back), read_back);
+    EXPECT_EQ(memcmp(data, read_back, sizeof(data)), 0);
+    EXPECT_EQ(eeprom_reads, 1);
+}
+
+TEST_F(DynamicKeymap, SetUnchangedBufferDoesNotWrite) {
+    uint8_t data[] = {0x00, KC_A, 0x00, KC_B};
+    dynamic_keymap_set_buffer(0, sizeof(data), data);
+    EXPECT_EQ(eeprom_writes, 0);
+}
+
+TEST_F(DynamicKeymap, InitLoadsCacheFromEeprom) {
+    eeprom_buffer[DYNAMIC_KEYMAP_EEPROM_ADDR + 1] = KC_Q;
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_A);
+    dynamic_keymap_init();
+    EXPECT_EQ(eeprom_reads, 1);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_Q);
+}
@@ -0,0 +1,185 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "eeprom_driver.h"
+#include "eeprom_deferred.h"
+#include "dynamic_keymap.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+// A custom EEPROM driver that counts how often it is written to
+static uint8_t  eeprom_buffer[1024];
+static uint32_t eeprom_writes = 0;
+
+extern "C" {
+void eeprom_driver_init(void) {}
+
+void eeprom_driver_erase(void) { memset(eeprom_buffer, 0x00, sizeof(eeprom_buffer)); }
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) { memcpy(buf, &eeprom_buffer[(uintptr_t)addr], len); }
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    eeprom_writes++;
+    memcpy(&eeprom_buffer[(uintptr_t)addr], buf, len);
+}
+}
+
+#define KEY_ADDRESS(layer, row, column) (DYNAMIC_KEYMAP_EEPROM_ADDR + ((layer)*MATRIX_ROWS * MATRIX_COLS + (row)*MATRIX_COLS + (column)) * 2)
+
+class EepromDeferred : public TestFixture {
+   public:
+    void SetUp() override {
+        dynamic_keymap_reset();
+        eeprom_deferred_flush();
+        eeprom_writes = 0;
+        stats         = *eeprom_deferred_get_stats();
+    }
+
+    // Counters since the start of the test
+    eeprom_deferred_stats_t stats_delta() {
+        const eeprom_deferred_stats_t *now = eeprom_deferred_get_stats();
+        return {now->writes - stats.writes, now->coalesced - stats.coalesced, now->commits - stats.commits, now->overflows - stats.overflows};
+    }
+
+    eeprom_deferred_stats_t stats;
+};
+
+TEST_F(EepromDeferred, WritesArePendingUntilIdle) {
+    TestDriver driver;
+    dynamic_keymap_set_keycode(0, 0, 0, KC_Z);
+    EXPECT_TRUE(eeprom_deferred_pending());
+    EXPECT_EQ(eeprom_writes, 0);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 0), KC_Z);
+
+    idle_for(EEPROM_DEFERRED_IDLE_TIME);
+    EXPECT_EQ(eeprom_writes, 0);
+
+    run_one_scan_loop();
+    EXPECT_FALSE(eeprom_deferred_pending());
+    EXPECT_EQ(eeprom_writes, 1);
+    EXPECT_EQ(eeprom_buffer[KEY_ADDRESS(0, 0, 0) + 1], KC_Z);
+}
+
+TEST_F(EepromDeferred, RepeatedWritesAreCoalesced) {
+    TestDriver driver;
+    for (uint16_t keycode = KC_A; keycode <= KC_J; keycode++) {
+        dynamic_keymap_set_keycode(0, 0, 0, keycode);
+        idle_for(10);
+    }
+    // Neighbouring keys end up in the same block
+    dynamic_keymap_set_keycode(0, 0, 1, KC_K);
+    idle_for(EEPROM_DEFERRED_IDLE_TIME + 1);
+
+    eeprom_deferred_stats_t delta = stats_delta();
+    EXPECT_EQ(delta.writes, 11);
+    EXPECT_EQ(delta.coalesced, 10);
+    EXPECT_EQ(delta.commits, 1);
+    EXPECT_EQ(eeprom_writes, 1);
+    EXPECT_EQ(eeprom_buffer[KEY_ADDRESS(0, 0, 0) + 1], KC_J);
+    EXPECT_EQ(eeprom_buffer[KEY_ADDRESS(0, 0, 1) + 1], KC_K);
+}
+
+TEST_F(EepromDeferred, HeldKeyDelaysCommitUntilMaxDelay) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    press_key(5, 3);
+    dynamic_keymap_set_keycode(1, 3, 3, KC_Z);
+    idle_for(EEPROM_DEFERRED_IDLE_TIME * 2);
+    EXPECT_TRUE(eeprom_deferred_pending());
+
+    idle_for(EEPROM_DEFERRED_MAX_DELAY - EEPROM_DEFERRED_IDLE_TIME * 2 + 1);
+    EXPECT_FALSE(eeprom_deferred_pending());
+    EXPECT_EQ(eeprom_buffer[KEY_ADDRESS(1, 3, 3) + 1], KC_Z);
+    release_key(5, 3);
+}
+
+TEST_F(EepromDeferred, ReadsSeePendingWrites) {
+    uint8_t data[] = {1, 2, 3, 4};
+    eeprom_deferred_update_block(data, (void *)10, sizeof(data));
+    uint8_t patch[] = {0xAA, 0xBB, 0xCC};
+    eeprom_deferred_update_block(patch, (void *)12, sizeof(patch));
+
+    uint8_t read_back[8];
+    eeprom_deferred_read_block(read_back, (void *)8, sizeof(read_back));
+    uint8_t expected[] = {eeprom_buffer[8], eeprom_buffer[9], 1, 2, 0xAA, 0xBB, 0xCC, eeprom_buffer[15]};
+    EXPECT_EQ(memcmp(read_back, expected, sizeof(expected)), 0);
+
+    eeprom_deferred_flush();
+    EXPECT_EQ(memcmp(&eeprom_buffer[8], expected, sizeof(expected)), 0);
+}
+
+TEST_F(EepromDeferred, OverlappingWritesKeepTheLatestValue) {
+    // Two blocks that can't be merged, and a write that overlaps both of them
+    uint8_t low[]  = {1, 1, 1, 1, 1, 1, 1, 1};
+    uint8_t high[] = {2, 2, 2, 2, 2, 2, 2, 2};
+    uint8_t span[] = {3, 3, 3, 3};
+    eeprom_deferred_update_block(low, (void *)16, sizeof(low));
+    eeprom_deferred_update_block(high, (void *)24, sizeof(high));
+    eeprom_deferred_update_block(span, (void *)22, sizeof(span));
+    eeprom_deferred_flush();
+
+    uint8_t expected[] = {1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2};
+    EXPECT_EQ(memcmp(&eeprom_buffer[16], expected, sizeof(expected)), 0);
+}
+
+TEST_F(EepromDeferred, FullQueueIsFlushed) {
+    for (uint8_t i = 0; i <= EEPROM_DEFERRED_QUEUE_SIZE; i++) {
+        uint8_t value = i;
+        eeprom_deferred_update_block(&value, (void *)(uintptr_t)(i * 32), 1);
+    }
+    EXPECT_EQ(stats_delta().overflows, 1);
+    EXPECT_EQ(eeprom_writes, EEPROM_DEFERRED_QUEUE_SIZE);
+    EXPECT_TRUE(eeprom_deferred_pending());
+    eeprom_deferred_flush();
+}
+
+TEST_F(EepromDeferred, MaxDelayRestartsAfterFullQueue) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    press_key(5, 3);
+    for (uint8_t i = 0; i < EEPROM_DEFERRED_QUEUE_SIZE; i++) {
+        uint8_t value = i;
+        eeprom_deferred_update_block(&value, (void *)(uintptr_t)(i * 32), 1);
+    }
+    idle_for(EEPROM_DEFERRED_MAX_DELAY / 2);
+    // Flushes the full queue, and leaves only this write pending
+    uint8_t value = 0xAA;
+    eeprom_deferred_update_block(&value, (void *)(uintptr_t)(EEPROM_DEFERRED_QUEUE_SIZE * 32), 1);
+    EXPECT_EQ(stats_delta().overflows, 1);
+
+    idle_for(EEPROM_DEFERRED_MAX_DELAY / 2 + 1);
+    EXPECT_TRUE(eeprom_deferred_pending());
+
+    idle_for(EEPROM_DEFERRED_MAX_DELAY / 2);
+    EXPECT_FALSE(eeprom_deferred_pending());
+    release_key(5, 3);
+}
+
+TEST_F(EepromDeferred, ResetKeyboardFlushes) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    dynamic_keymap_set_keycode(0, 1, 1, KC_Z);
+    reset_keyboard();
+    EXPECT_FALSE(eeprom_deferred_pending());
+    EXPECT_EQ(eeprom_buffer[KEY_ADDRESS(0, 1, 1) + 1], KC_Z);
+}
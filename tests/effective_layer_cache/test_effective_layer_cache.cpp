@@ -0,0 +1,138 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+// The lookup as done without the cache, walking the layers from the top
+static uint8_t uncached_get_layer(keypos_t key) {
+    layer_state_t layers = layer_state | default_layer_state;
+    for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
+        if ((layers & (1UL << i)) && action_for_key(i, key).code != ACTION_TRANSPARENT) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+class EffectiveLayerCache : public TestFixture {
+   public:
+    void SetUp() override {
+        // Changing layers sends reports
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        default_layer_set(1);
+    }
+
+    void TearDown() override { testing::Mock::VerifyAndClearExpectations(&driver); }
+
+    void expect_matches_uncached(void) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                keypos_t key = {.col = col, .row = row};
+                ASSERT_EQ(layer_switch_get_layer(key), uncached_get_layer(key)) << "row " << (int)row << " col " << (int)col << " layers " << std::hex << (layer_state | default_layer_state);
+            }
+        }
+    }
+
+    TestDriver driver;
+};
+
+TEST_F(EffectiveLayerCache, MatchesUncachedLookup) {
+    uint32_t random = 12345;
+    for (int i = 0; i < 1000; i++) {
+        random = random * 1103515245 + 12345;
+        // Mostly toggle single layers, sometimes replace the whole state
+        if (i % 8 == 0) {
+            layer_state_set(random);
+        } else {
+            layer_invert((random >> 16) % MAX_LAYER);
+        }
+        expect_matches_uncached();
+    }
+}
+
+TEST_F(EffectiveLayerCache, FollowsDefaultLayerChanges) {
+    layer_on(3);
+    default_layer_set(1UL << 2);
+    expect_matches_uncached();
+    default_layer_set(0);
+    expect_matches_uncached();
+    layer_clear();
+    expect_matches_uncached();
+}
+
+TEST_F(EffectiveLayerCache, PicksUpDirectAssignment) {
+    layer_state = (1UL << 5) | (1UL << 7);
+    expect_matches_uncached();
+    layer_state = 0;
+    expect_matches_uncached();
+}
+
+TEST_F(EffectiveLayerCache, KeyPressUsesResolvedLayer) {
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    InSequence s;
+
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    press_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_2)));
+    run_one_scan_loop();
+
+    release_key(2, 0);
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    idle_for(2);
+}
+
+TEST_F(EffectiveLayerCache, Benchmark) {
+    const int iterations = 20000;
+    for (uint8_t active : {4, 16, 32}) {
+        layer_state_set(active == 32 ? ~(layer_state_t)0 : ((1UL << active) - 1));
+
+        volatile uint8_t sink     = 0;
+        auto             start    = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            sink = uncached_get_layer((keypos_t){.col = (uint8_t)(i % MATRIX_COLS), .row = (uint8_t)((i / MATRIX_COLS) % MATRIX_ROWS)});
+        }
+        auto uncached = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            sink = layer_switch_get_layer((keypos_t){.col = (uint8_t)(i % MATRIX_COLS), .row = (uint8_t)((i / MATRIX_COLS) % MATRIX_ROWS)});
+        }
+        auto cached = std::chrono::steady_clock::now() - start;
+
+        // Includes the incremental update of the cache
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations / 100; i++) {
+            layer_invert(active - 1);
+        }
+        auto update = std::chrono::steady_clock::now() - start;
+        (void)sink;
+
+        printf("%2u active layers: uncached %5.1f ns/event, cached %5.1f ns/event, layer change %7.1f ns\n", active, std::chrono::duration<double, std::nano>(uncached).count() / iterations, std::chrono::duration<double, std::nano>(cached).count() / iterations, std::chrono::duration<double, std::nano>(update).count() / (iterations / 100));
+        expect_matches_uncached();
+    }
+}
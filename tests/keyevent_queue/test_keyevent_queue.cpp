@@ -0,0 +1,158 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "keyevent_queue.h"
+#include "timer.h"
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::InSequence;
+
+static keyevent_t make_event(uint8_t row, uint8_t col, bool pressed, uint16_t time) { return (keyevent_t){.key = (keypos_t){.col = col, .row = row}, .pressed = pressed, .time = time}; }
+
+class KeyeventQueue : public testing::Test {
+   public:
+    void SetUp() override { keyevent_queue_clear(); }
+    // Don't leave events behind for the tests that run the keyboard task
+    void TearDown() override { keyevent_queue_clear(); }
+};
+
+TEST_F(KeyeventQueue, PopsInOrderOfTime) {
+    EXPECT_TRUE(keyevent_queue_push(make_event(0, 1, true, 100)));
+    EXPECT_TRUE(keyevent_queue_push(make_event(0, 2, true, 100)));
+    EXPECT_TRUE(keyevent_queue_push(make_event(0, 3, true, 99)));
+    EXPECT_TRUE(keyevent_queue_push(make_event(0, 4, false, 101)));
+    EXPECT_EQ(keyevent_queue_count(), 4);
+
+    keyevent_t event;
+    const uint8_t expected_cols[] = {3, 1, 2, 4};
+    for (uint8_t col : expected_cols) {
+        ASSERT_TRUE(keyevent_queue_pop(&event));
+        EXPECT_EQ(event.key.col, col);
+    }
+    EXPECT_FALSE(keyevent_queue_pop(&event));
+}
+
+TEST_F(KeyeventQueue, TimesWrapAround) {
+    keyevent_queue_push(make_event(0, 1, true, 2));
+    keyevent_queue_push(make_event(0, 2, true, 65535));
+
+    keyevent_t event;
+    ASSERT_TRUE(keyevent_queue_pop(&event));
+    EXPECT_EQ(event.key.col, 2);
+    ASSERT_TRUE(keyevent_queue_pop(&event));
+    EXPECT_EQ(event.key.col, 1);
+}
+
+TEST_F(KeyeventQueue, RefusesEventsWhenFull) {
+    uint32_t overflows = keyevent_queue_get_stats()->overflows;
+    for (uint8_t i = 0; i < KEYEVENT_QUEUE_SIZE; i++) {
+        EXPECT_TRUE(keyevent_queue_push(make_event(1, i, true, 10 + i)));
+    }
+    EXPECT_FALSE(keyevent_queue_push(make_event(2, 0, true, 500)));
+    EXPECT_EQ(keyevent_queue_get_stats()->overflows, overflows + 1);
+    EXPECT_EQ(keyevent_queue_get_stats()->max_count, KEYEVENT_QUEUE_SIZE);
+
+    // The queue keeps working across the end of its buffer
+    keyevent_t event;
+    for (uint8_t i = 0; i < KEYEVENT_QUEUE_SIZE * 2; i++) {
+        ASSERT_TRUE(keyevent_queue_pop(&event));
+        EXPECT_EQ(event.time, 10 + i);
+        EXPECT_TRUE(keyevent_queue_push(make_event(1, 0, true, 10 + KEYEVENT_QUEUE_SIZE + i)));
+    }
+    EXPECT_EQ(keyevent_queue_count(), KEYEVENT_QUEUE_SIZE);
+}
+
+// Every event that reaches process_record_user()
+static std::vector<keyevent_t> events;
+
+extern "C" bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    events.push_back(record->event);
+    return true;
+}
+
+class KeyeventQueueTask : public TestFixture {
+   public:
+    void SetUp() override { events.clear(); }
+};
+
+TEST_F(KeyeventQueueTask, SimultaneousKeysAreProcessedInOneScan) {
+    TestDriver driver;
+    InSequence s;
+    press_key(1, 0);
+    press_key(0, 2);
+    press_key(0, 1);
+
+    // In matrix order, all in the same scan
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B, KC_K)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B, KC_K, KC_LSFT)));
+    keyboard_task();
+
+    release_key(1, 0);
+    release_key(0, 2);
+    release_key(0, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_K, KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+}
+
+TEST_F(KeyeventQueueTask, EventsCarryTheScanTime) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(2);
+    press_key(3, 0);
+    press_key(4, 1);
+    uint16_t scan_time = timer_read() | 1;
+    keyboard_task();
+
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].time, scan_time);
+    EXPECT_EQ(events[1].time, scan_time);
+    EXPECT_TRUE(events[0].pressed);
+    EXPECT_EQ(events[0].key.row, 0);
+    EXPECT_EQ(events[1].key.row, 1);
+}
+
+TEST_F(KeyeventQueueTask, MoreKeysThanTheQueueHoldsAreStillProcessedInOneScan) {
+    TestDriver driver;
+    uint32_t   overflows = keyevent_queue_get_stats()->overflows;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(KEYEVENT_QUEUE_SIZE + 2);
+    for (uint8_t col = 0; col < KEYEVENT_QUEUE_SIZE + 2; col++) {
+        press_key(col, 1);
+    }
+    keyboard_task();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_EQ(events.size(), KEYEVENT_QUEUE_SIZE + 2u);
+    EXPECT_GT(keyevent_queue_get_stats()->overflows, overflows);
+    for (uint8_t i = 0; i < events.size(); i++) {
+        EXPECT_EQ(events[i].key.col, i);
+        EXPECT_EQ(events[i].time, events[0].time);
+    }
+
+    // Nothing is left over for the next scan
+    events.clear();
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    keyboard_task();
+    EXPECT_TRUE(events.empty());
+}
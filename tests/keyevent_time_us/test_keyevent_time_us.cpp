@@ -0,0 +1,97 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "timer.h"
+void advance_time_us(uint32_t us);
+}
+
+using testing::_;
+using testing::InSequence;
+
+// Every event that reaches process_record_user()
+static std::vector<keyevent_t> events;
+
+extern "C" bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    events.push_back(record->event);
+    return true;
+}
+
+class KeyeventTimeUs : public TestFixture {
+   public:
+    void SetUp() override { events.clear(); }
+
+    // Moves to the given number of microseconds into the current millisecond
+    void align_time_us(uint32_t us) { advance_time_us(1000 - timer_read_us() % 1000 + us); }
+};
+
+TEST_F(KeyeventTimeUs, EventsCarryTheTimeOfTheScan) {
+    TestDriver driver;
+    align_time_us(250);
+    uint32_t scan_time = timer_read_us();
+
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    keyboard_task();
+
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].time_us, scan_time);
+    EXPECT_EQ(events[0].time, (timer_read() | 1));
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    advance_time_us(1500);
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[1].time_us - events[0].time_us, 1500);
+}
+
+TEST_F(KeyeventTimeUs, TapIsDecidedOnMicroseconds) {
+    TestDriver driver;
+    InSequence s;
+    // 199.6ms between the scans, while the millisecond timer has moved on by 200
+    align_time_us(900);
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    keyboard_task();
+
+    advance_time_us(TAPPING_TERM * 1000 - 400);
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+}
+
+TEST_F(KeyeventTimeUs, HoldAfterTappingTerm) {
+    TestDriver driver;
+    InSequence s;
+    align_time_us(900);
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    keyboard_task();
+
+    advance_time_us(TAPPING_TERM * 1000);
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+}
@@ -0,0 +1,151 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "matrix_idle.h"
+#include "timer.h"
+#include "wait.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+// Lets a test press a key part way through a sleep, as a wake up interrupt would
+static int      press_during_sleep_after = -1;
+static bool     idle_allowed             = true;
+static uint32_t slept                    = 0;
+
+extern "C" {
+bool matrix_idle_sleep(uint16_t timeout) {
+    if (press_during_sleep_after >= 0 && press_during_sleep_after < timeout) {
+        wait_ms(press_during_sleep_after);
+        slept += press_during_sleep_after;
+        press_during_sleep_after = -1;
+        press_key(0, 0);
+        return true;
+    }
+    wait_ms(timeout);
+    slept += timeout;
+    return false;
+}
+
+bool matrix_idle_allowed_user(void) { return idle_allowed; }
+}
+
+class MatrixIdle : public TestFixture {
+   public:
+    void SetUp() override {
+        press_during_sleep_after = -1;
+        idle_allowed             = true;
+
+        // Start from an active matrix
+        TestDriver driver;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        press_key(1, 0);
+        run_one_scan_loop();
+        release_key(1, 0);
+        run_one_scan_loop();
+
+        stats = *matrix_idle_get_stats();
+        slept = 0;
+    }
+
+    uint32_t sleeps() { return matrix_idle_get_stats()->sleeps - stats.sleeps; }
+    uint32_t wakes() { return matrix_idle_get_stats()->wakes - stats.wakes; }
+
+    matrix_idle_stats_t stats;
+};
+
+TEST_F(MatrixIdle, SleepsOnceIdle) {
+    TestDriver driver;
+    idle_for(MATRIX_IDLE_TIMEOUT - 1);
+    EXPECT_EQ(sleeps(), 0);
+    EXPECT_EQ(slept, 0);
+
+    run_one_scan_loop();
+    EXPECT_EQ(sleeps(), 1);
+    EXPECT_EQ(slept, MATRIX_IDLE_MAX_SLEEP);
+
+    // Without a key press, it goes straight back to sleep
+    idle_for(5);
+    EXPECT_EQ(sleeps(), 6);
+    EXPECT_EQ(wakes(), 0);
+}
+
+TEST_F(MatrixIdle, KeyPressWakesUp) {
+    TestDriver driver;
+    idle_for(MATRIX_IDLE_TIMEOUT);
+    EXPECT_EQ(sleeps(), 1);
+
+    // The key is reported in the same scan that woke up
+    press_during_sleep_after = 3;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_EQ(sleeps(), 2);
+    EXPECT_EQ(wakes(), 1);
+    EXPECT_EQ(matrix_idle_get_stats()->last_wake_latency, 0);
+
+    // Full rate scanning resumes, and stays on for the timeout after release
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(MATRIX_IDLE_TIMEOUT);
+    EXPECT_EQ(sleeps(), 2);
+}
+
+TEST_F(MatrixIdle, KeyAlreadyDownSkipsSleep) {
+    TestDriver driver;
+    idle_for(MATRIX_IDLE_TIMEOUT);
+    EXPECT_EQ(sleeps(), 1);
+
+    // Pressed between two scans, it is found before going to sleep
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    uint32_t before = slept;
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_EQ(slept, before);
+    EXPECT_EQ(wakes(), 1);
+
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(MatrixIdle, HeldKeyKeepsScanning) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    press_key(0, 0);
+    idle_for(MATRIX_IDLE_TIMEOUT * 3);
+    EXPECT_EQ(sleeps(), 0);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(0, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(MatrixIdle, CanBeHeldOff) {
+    TestDriver driver;
+    idle_allowed = false;
+    idle_for(MATRIX_IDLE_TIMEOUT * 3);
+    EXPECT_EQ(sleeps(), 0);
+
+    idle_allowed = true;
+    run_one_scan_loop();
+    EXPECT_EQ(sleeps(), 1);
+}
@@ -0,0 +1,61 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+#include "test_rgb_matrix_geometry.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {{KC_A}},
+};
+
+// clang-format off
+#define R(row) \
+    {  0, row * 12}, { 13, row * 12}, { 26, row * 12}, { 39, row * 12}, { 52, row * 12}, { 65, row * 12}, \
+    { 78, row * 12}, { 91, row * 12}, {104, row * 12}, {117, row * 12}, {130, row * 12}, {143, row * 12}, \
+    {156, row * 12}, {169, row * 12}, {182, row * 12}, {195, row * 12}, {208, row * 12}, {221, row * 12}
+
+led_config_t g_led_config = {
+    {{0}},
+    {R(0), R(1), R(2), R(3), R(4), R(5)},
+    {[0 ... DRIVER_LED_TOTAL - 1] = LED_FLAG_KEYLIGHT},
+};
+// clang-format on
+
+RGB      test_leds[DRIVER_LED_TOTAL];
+uint32_t test_frames;
+
+static void test_init(void) {}
+
+static void test_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {
+    test_leds[index].r = r;
+    test_leds[index].g = g;
+    test_leds[index].b = b;
+}
+
+static void test_set_color_all(uint8_t r, uint8_t g, uint8_t b) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        test_set_color(i, r, g, b);
+    }
+}
+
+static void test_flush(void) { test_frames++; }
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+    .init          = test_init,
+    .set_color     = test_set_color,
+    .set_color_all = test_set_color_all,
+    .flush         = test_flush,
+};
@@ -0,0 +1,105 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "test_common.hpp"
+#include "test_rgb_matrix_geometry.h"
+
+extern "C" {
+#include "rgb_matrix.h"
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+class RgbMatrixGeometry : public TestFixture {
+   public:
+    void SetUp() override {
+        rgb_matrix_enable_noeeprom();
+        rgb_matrix_sethsv_noeeprom(0, 255, 255);
+        rgb_matrix_set_speed_noeeprom(128);
+    }
+
+    // Runs the task until the next frame has been flushed to the driver
+    void render_frame() {
+        uint32_t frames = test_frames;
+        while (test_frames == frames) {
+            rgb_matrix_task();
+            advance_time(1);
+        }
+    }
+
+    // Renders a frame of the given effect at the given time
+    void render(uint8_t mode, uint32_t time, RGB *leds) {
+        rgb_matrix_mode_noeeprom(mode);
+        set_time(time);
+        render_frame();
+        memcpy(leds, test_leds, sizeof(RGB) * DRIVER_LED_TOTAL);
+    }
+
+    double time_frames(uint8_t mode, int frames) {
+        rgb_matrix_mode_noeeprom(mode);
+        render_frame();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            render_frame();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / frames;
+    }
+};
+
+// UNCACHED_SPIRAL is CYCLE_SPIRAL as it was rendered before the geometry was
+// cached, working out the distance and angle of every LED on every frame.
+TEST_F(RgbMatrixGeometry, CachedSpiralMatchesUncached) {
+    TestDriver driver;
+    RGB        cached[DRIVER_LED_TOTAL];
+    RGB        uncached[DRIVER_LED_TOTAL];
+
+    for (uint32_t time = 0; time < 1000; time += 97) {
+        render(RGB_MATRIX_CYCLE_SPIRAL, time, cached);
+        render(RGB_MATRIX_CUSTOM_UNCACHED_SPIRAL, time, uncached);
+        EXPECT_EQ(0, memcmp(cached, uncached, sizeof(cached))) << "time " << time;
+    }
+}
+
+TEST_F(RgbMatrixGeometry, UpdateAfterMovingLeds) {
+    TestDriver driver;
+    RGB        cached[DRIVER_LED_TOTAL];
+    RGB        uncached[DRIVER_LED_TOTAL];
+    point_t    saved = g_led_config.point[0];
+
+    g_led_config.point[0] = g_led_config.point[DRIVER_LED_TOTAL - 1];
+    rgb_matrix_update_geometry();
+    render(RGB_MATRIX_CYCLE_SPIRAL, 500, cached);
+    render(RGB_MATRIX_CUSTOM_UNCACHED_SPIRAL, 500, uncached);
+    EXPECT_EQ(0, memcmp(cached, uncached, sizeof(cached)));
+    EXPECT_EQ(0, memcmp(&cached[0], &cached[DRIVER_LED_TOTAL - 1], sizeof(RGB)));
+
+    g_led_config.point[0] = saved;
+    rgb_matrix_update_geometry();
+}
+
+TEST_F(RgbMatrixGeometry, Benchmark) {
+    TestDriver driver;
+    const int  frames = 20000;
+
+    double uncached_us = time_frames(RGB_MATRIX_CUSTOM_UNCACHED_SPIRAL, frames);
+    double cached_us   = time_frames(RGB_MATRIX_CYCLE_SPIRAL, frames);
+    printf("CYCLE_SPIRAL, %d LEDs: uncached %.2f us/frame (%.0f fps), cached %.2f us/frame (%.0f fps)\n", DRIVER_LED_TOTAL, uncached_us, 1e6 / uncached_us, cached_us, 1e6 / cached_us);
+}
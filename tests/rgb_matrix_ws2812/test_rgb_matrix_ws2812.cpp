@@ -0,0 +1,72 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "rgb_matrix.h"
+void advance_time(uint32_t ms);
+
+extern LED_TYPE ws2812_mock_leds[];
+extern uint32_t ws2812_mock_frames;
+bool            ws2812_mock_frame_pending(void);
+void            ws2812_mock_finish_frame(void);
+void            ws2812_mock_reset(void);
+}
+
+class RgbMatrixWs2812 : public TestFixture {
+   public:
+    void SetUp() override {
+        ws2812_mock_reset();
+        rgb_matrix_enable_noeeprom();
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+        rgb_matrix_sethsv_noeeprom(HSV_RED);
+    }
+
+    // Runs the task long enough to render and flush a few frames
+    void run_task(int scans) {
+        for (int i = 0; i < scans; i++) {
+            rgb_matrix_task();
+            advance_time(1);
+        }
+    }
+};
+
+TEST_F(RgbMatrixWs2812, FlushIsSkippedWhileAFrameIsInFlight) {
+    run_task(20);
+    EXPECT_EQ(ws2812_mock_frames, 1u);
+    EXPECT_TRUE(ws2812_frame_in_flight());
+    // The frames rendered meanwhile are dropped, rather than queued up behind it
+    EXPECT_FALSE(ws2812_mock_frame_pending());
+    EXPECT_EQ(ws2812_mock_leds[0].r, 255);
+    EXPECT_EQ(ws2812_mock_leds[0].g, 0);
+
+    rgb_matrix_sethsv_noeeprom(HSV_GREEN);
+    ws2812_mock_finish_frame();
+    run_task(20);
+    EXPECT_EQ(ws2812_mock_frames, 2u);
+    EXPECT_EQ(ws2812_mock_leds[0].r, 0);
+    EXPECT_EQ(ws2812_mock_leds[0].g, 255);
+}
+
+TEST_F(RgbMatrixWs2812, FramesAreSentBackToBackOnceTheBusIsFree) {
+    for (uint32_t frame = 1; frame <= 5; frame++) {
+        run_task(20);
+        EXPECT_EQ(ws2812_mock_frames, frame);
+        ws2812_mock_finish_frame();
+    }
+}
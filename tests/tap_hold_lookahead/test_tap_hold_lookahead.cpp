@@ -0,0 +1,111 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "test_common.hpp"
+#include "action_tapping.h"
+
+// The lookahead can be switched off, to compare with the plain tapping code
+static bool lookahead = true;
+
+extern "C" tap_hold_decision_t get_tap_hold_decision(uint16_t keycode, keyrecord_t *tapping_key, const tap_hold_event_t *events, uint8_t count, uint16_t now) {
+    return lookahead ? tap_hold_lookahead_decision(keycode, tapping_key, events, count, now) : TAP_HOLD_UNDECIDED;
+}
+
+enum { Q, A_GUI, S_ALT, D_CTL, F_SFT, J_SFT, K_CTL, L_ALT, U, LCTL };
+
+struct TapHoldTrace {
+    const char *name;
+    Trace       events;
+    // What the typist meant, letters in the order they were typed, with the modifiers held for them
+    std::string expected;
+};
+
+#define DOWN(time, col) \
+    { time, col, 0, true }
+#define UP(time, col) \
+    { time, col, 0, false }
+
+// clang-format off
+static const std::vector<TapHoldTrace> traces = {
+    {"tap", {DOWN(0, F_SFT), UP(60, F_SFT)}, "f"},
+    {"roll across hands", {DOWN(0, F_SFT), DOWN(40, J_SFT), UP(70, F_SFT), UP(110, J_SFT)}, "f j"},
+    {"roll on one hand", {DOWN(0, D_CTL), DOWN(30, F_SFT), UP(60, D_CTL), UP(100, F_SFT)}, "d f"},
+    {"roll into a plain key", {DOWN(0, F_SFT), DOWN(25, Q), UP(50, F_SFT), UP(90, Q)}, "f q"},
+    {"three key roll", {DOWN(0, D_CTL), DOWN(35, J_SFT), UP(60, D_CTL), DOWN(80, K_CTL), UP(100, J_SFT), UP(140, K_CTL)}, "d j k"},
+    {"tap then letter", {DOWN(0, F_SFT), UP(40, F_SFT), DOWN(60, U), UP(100, U)}, "f u"},
+    {"quick shifted letter", {DOWN(0, F_SFT), DOWN(60, U), UP(110, U), UP(160, F_SFT)}, "S-u"},
+    {"slow shifted letter", {DOWN(0, F_SFT), DOWN(150, U), UP(190, U), UP(260, F_SFT)}, "S-u"},
+    {"control held over a letter", {DOWN(0, D_CTL), DOWN(90, U), UP(260, U), UP(300, D_CTL)}, "C-u"},
+    {"shifted mod-tap", {DOWN(0, J_SFT), DOWN(50, D_CTL), UP(90, D_CTL), UP(150, J_SFT)}, "S-d"},
+    {"hold on its own", {DOWN(0, F_SFT), UP(400, F_SFT)}, ""},
+    {"roll under a plain control", {DOWN(0, LCTL), DOWN(100, D_CTL), DOWN(130, F_SFT), UP(160, D_CTL), UP(200, F_SFT), DOWN(250, U), UP(290, U), UP(400, LCTL)}, "C-d C-f C-u"},
+};
+// clang-format on
+
+static uint16_t keycode_at(uint8_t col) { return keymap_key_to_keycode(0, (keypos_t){.col = col, .row = 0}); }
+
+static uint8_t mod_tap_bits(uint16_t keycode) {
+    uint8_t mods = (keycode >> 8) & 0x1F;
+    return mods & 0x10 ? (mods & 0x0F) << 4 : mods;
+}
+
+// Sum over the tap-hold keys of the time from their press to the first report that shows them
+static uint32_t tap_hold_latency(const TraceResult &result) {
+    uint32_t latency = 0;
+    for (auto &press : result.events) {
+        uint16_t keycode = keycode_at(press.event.col);
+        if (!press.event.pressed || keycode < QK_MOD_TAP || keycode > QK_MOD_TAP_MAX) continue;
+        for (auto &timed : result.reports) {
+            if (timed.time < press.event.time) continue;
+            if ((timed.report.mods & mod_tap_bits(keycode)) || std::find(std::begin(timed.report.keys), std::end(timed.report.keys), keycode & 0xFF) != std::end(timed.report.keys)) {
+                latency += timed.time - press.event.time;
+                break;
+            }
+        }
+    }
+    return latency;
+}
+
+class TapHoldLookahead : public TestFixture {};
+
+TEST_F(TapHoldLookahead, SettlesTheTraceCorpus) {
+    uint32_t baseline_latency = 0, lookahead_latency = 0;
+    uint8_t  baseline_misfires = 0, lookahead_misfires = 0;
+
+    for (auto &trace : traces) {
+        lookahead            = false;
+        TraceResult baseline = replay_trace(trace.events, TAPPING_TERM + 10);
+        lookahead            = true;
+        TraceResult settled  = replay_trace(trace.events, TAPPING_TERM + 10);
+
+        EXPECT_EQ(settled.typed(), trace.expected) << trace.name;
+        EXPECT_LE(tap_hold_latency(settled), tap_hold_latency(baseline)) << trace.name;
+
+        baseline_latency += tap_hold_latency(baseline);
+        lookahead_latency += tap_hold_latency(settled);
+        baseline_misfires += baseline.typed() != trace.expected;
+        lookahead_misfires += settled.typed() != trace.expected;
+        printf("%-28s %-8s baseline %-8s %4u ms, lookahead %-8s %4u ms\n", trace.name, trace.expected.c_str(), baseline.typed().c_str(), tap_hold_latency(baseline), settled.typed().c_str(), tap_hold_latency(settled));
+    }
+    printf("%zu traces: baseline %u misfires, %u ms; lookahead %u misfires, %u ms\n", traces.size(), baseline_misfires, baseline_latency, lookahead_misfires, lookahead_latency);
+
+    EXPECT_LE(lookahead_misfires, baseline_misfires);
+    EXPECT_LT(lookahead_latency, baseline_latency);
+}
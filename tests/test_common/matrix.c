@@ -17,8 +17,15 @@
 #include "matrix.h"
 #include "test_matrix.h"
 #include <string.h>
+#ifdef MATRIX_IDLE_ENABLE
+#    include "matrix_idle.h"
+#    include "wait.h"
+#endif
 
 static matrix_row_t matrix[MATRIX_ROWS] = {};
+#ifdef MATRIX_IDLE_ENABLE
+static matrix_row_t previous_matrix[MATRIX_ROWS] = {};
+#endif
 
 void matrix_init(void) {
     clear_all_keys();
@@ -26,6 +33,16 @@ void matrix_init(void) {
 }
 
 uint8_t matrix_scan(void) {
+#ifdef MATRIX_IDLE_ENABLE
+    matrix_idle_wait();
+
+    bool changed = memcmp(previous_matrix, matrix, sizeof(matrix)) != 0;
+    memcpy(previous_matrix, matrix, sizeof(matrix));
+    matrix_idle_update(changed, matrix_idle_key_down());
+#endif
+#ifdef KEYEVENT_TIME_US
+    matrix_scan_timestamp();
+#endif
     matrix_scan_quantum();
     return 1;
 }
@@ -44,4 +61,25 @@ void release_key(uint8_t col, uint8_t row) { matrix[row] &= ~(1 << col); }
 
 void clear_all_keys(void) { memset(matrix, 0, sizeof(matrix)); }
 
+#ifdef MATRIX_IDLE_ENABLE
+void matrix_idle_arm(void) {}
+
+void matrix_idle_disarm(void) {}
+
+bool matrix_idle_key_down(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (matrix[row]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Nothing can press a key while a test is blocked in here, so time just passes
+__attribute__((weak)) bool matrix_idle_sleep(uint16_t timeout) {
+    wait_ms(timeout);
+    return false;
+}
+#endif
+
 void led_set(uint8_t usb_led) {}
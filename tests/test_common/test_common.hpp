@@ -24,3 +24,4 @@ extern "C" {
 #include "test_matrix.h"
 #include "keyboard_report_util.hpp"
 #include "test_fixture.hpp"
+#include "trace_replay.hpp"
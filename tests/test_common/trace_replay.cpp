@@ -0,0 +1,156 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace_replay.hpp"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include "gmock/gmock.h"
+#include "test_driver.hpp"
+#include "test_matrix.h"
+
+extern "C" {
+#include "keyboard.h"
+#include "keycode.h"
+#include "timer.h"
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::Invoke;
+
+Trace parse_trace(const char* text) {
+    Trace              trace;
+    std::istringstream lines(text);
+    std::string        line;
+    while (std::getline(lines, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        uint32_t           time;
+        std::string        action;
+        unsigned           col, row;
+        if (!(fields >> time)) continue;
+        if (!(fields >> action >> col >> row) || (action != "press" && action != "release")) {
+            ADD_FAILURE() << "Invalid trace line: " << line;
+            continue;
+        }
+        trace.push_back({time, (uint8_t)col, (uint8_t)row, action == "press"});
+    }
+    return trace;
+}
+
+static bool report_has_key(const report_keyboard_t& report, uint8_t key) { return std::find(std::begin(report.keys), std::end(report.keys), key) != std::end(report.keys); }
+
+static std::string key_name(uint8_t key) {
+    if (key >= KC_A && key <= KC_Z) return std::string(1, 'a' + key - KC_A);
+    if (key >= KC_1 && key <= KC_9) return std::string(1, '1' + key - KC_1);
+    if (key == KC_0) return "0";
+    if (key == KC_SPACE) return "spc";
+    return "kc" + std::to_string(key);
+}
+
+std::string TraceResult::typed() const {
+    std::string       result;
+    report_keyboard_t previous = {};
+    for (auto& timed : reports) {
+        const report_keyboard_t& report = timed.report;
+        for (uint8_t key : report.keys) {
+            if (key == KC_NO || report_has_key(previous, key)) continue;
+            if (!result.empty()) result += " ";
+            if (report.mods & MOD_MASK_CTRL) result += "C-";
+            if (report.mods & MOD_MASK_ALT) result += "A-";
+            if (report.mods & MOD_MASK_SHIFT) result += "S-";
+            if (report.mods & MOD_MASK_GUI) result += "G-";
+            result += key_name(key);
+        }
+        previous = report;
+    }
+    return result;
+}
+
+double TraceResult::mean_latency_ms() const {
+    uint32_t total = 0, count = 0;
+    for (auto& event : events) {
+        if (event.latency_ms < 0) continue;
+        total += event.latency_ms;
+        count++;
+    }
+    return count ? (double)total / count : 0;
+}
+
+int32_t TraceResult::max_latency_ms() const {
+    int32_t result = -1;
+    for (auto& event : events) {
+        result = std::max(result, event.latency_ms);
+    }
+    return result;
+}
+
+double TraceResult::mean_processing_ns() const {
+    uint64_t total = 0;
+    for (auto& event : events) {
+        total += event.processing_ns;
+    }
+    return events.empty() ? 0 : (double)total / events.size();
+}
+
+TraceResult replay_trace(const Trace& trace, uint32_t settle_time) {
+    TestDriver  driver;
+    TraceResult result = {};
+    uint32_t    start  = timer_read32();
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([&](report_keyboard_t& report) { result.reports.push_back({timer_read32() - start, report}); }));
+
+    Trace events = trace;
+    std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.time < b.time; });
+
+    auto     next = events.begin();
+    uint32_t end  = (events.empty() ? 0 : events.back().time) + settle_time;
+    for (uint32_t time = 0; time <= end; time++) {
+        auto found = next;
+        for (; next != events.end() && next->time == time; next++) {
+            if (next->pressed) {
+                press_key(next->col, next->row);
+            } else {
+                release_key(next->col, next->row);
+            }
+        }
+
+        auto scan_start = std::chrono::steady_clock::now();
+        keyboard_task();
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - scan_start).count();
+        result.total_ns += elapsed;
+        for (; found != next; found++) {
+            result.events.push_back({*found, elapsed, -1});
+        }
+        advance_time(1);
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    for (auto& event : result.events) {
+        for (auto& report : result.reports) {
+            if (report.time >= event.event.time) {
+                event.latency_ms = report.time - event.event.time;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+void print_trace_result(const char* name, const TraceResult& result) {
+    printf("%-24s %3zu events %3zu reports, latency mean %6.1f ms max %4d ms, processing %8.1f ns/event %10.1f us total\n", name, result.events.size(), result.reports.size(), result.mean_latency_ms(), result.max_latency_ms(), result.mean_processing_ns(), result.total_ns / 1000.0);
+}
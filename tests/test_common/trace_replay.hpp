@@ -0,0 +1,75 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "report.h"
+
+/* Replays timelines of matrix events against the whole keyboard, one matrix
+ * scan per simulated millisecond, and records the reports that come out.
+ *
+ * A trace can be written as text, one event per line:
+ *
+ *     # time(ms) press|release col row
+ *     0   press   4 0
+ *     60  release 4 0
+ */
+
+struct TraceEvent {
+    uint32_t time;
+    uint8_t  col;
+    uint8_t  row;
+    bool     pressed;
+};
+
+typedef std::vector<TraceEvent> Trace;
+
+Trace parse_trace(const char* text);
+
+struct TraceReport {
+    uint32_t          time;
+    report_keyboard_t report;
+};
+
+struct TraceEventResult {
+    TraceEvent event;
+    // Wall clock time of the scan that found the event, which includes any other event found by the same scan
+    uint64_t processing_ns;
+    // Simulated time until the first report sent at or after the event, -1 if none was. Events that send no
+    // report of their own, such as the release of a swallowed key, count until the report of a later event.
+    int32_t latency_ms;
+};
+
+struct TraceResult {
+    std::vector<TraceEventResult> events;
+    std::vector<TraceReport>      reports;
+    // Wall clock time of all scans, including those without events
+    uint64_t total_ns;
+
+    // The keys as they were pressed, with the modifiers held for them, such as "a S-b"
+    std::string typed() const;
+    double      mean_latency_ms() const;
+    int32_t     max_latency_ms() const;
+    double      mean_processing_ns() const;
+};
+
+// Replays the trace from the current simulated time, and keeps scanning for settle_time after its last event
+TraceResult replay_trace(const Trace& trace, uint32_t settle_time);
+// Prints a summary of the result on one line, in a fixed format that can be diffed between runs
+void print_trace_result(const char* name, const TraceResult& result);
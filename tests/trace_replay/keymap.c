@@ -0,0 +1,39 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+enum { TD_F_G };
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] =
+        {
+            // 0    1     2     3            4             5              6           7      8      9
+            {KC_A, KC_B, KC_C, SFT_T(KC_D), LT(1, KC_E), OSM(MOD_LSFT), TD(TD_F_G), MO(1), KC_H, KC_SPC},
+        },
+    [1] =
+        {
+            {KC_1, KC_2, KC_3, KC_4, _______, _______, _______, _______, KC_5, KC_0},
+        },
+};
+
+const uint16_t PROGMEM ab_combo[] = {KC_A, KC_B, COMBO_END};
+
+combo_t key_combos[COMBO_COUNT] = {COMBO(ab_combo, KC_X)};
+
+qk_tap_dance_action_t tap_dance_actions[] = {
+    [TD_F_G] = ACTION_TAP_DANCE_DOUBLE(KC_F, KC_G),
+};
@@ -0,0 +1,136 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+// Columns of the keymap
+//  0: A   1: B   2: C   3: SFT_T(D)   4: LT(1, E)   5: OSM(SFT)   6: TD(F, G)   7: MO(1)   8: H   9: SPC
+// A and B are a combo for X, layer 1 has numbers on A, B, C, D, H and SPC.
+
+struct Scenario {
+    const char *name;
+    const char *trace;
+    const char *typed;
+};
+
+// clang-format off
+static const Scenario scenarios[] = {
+    {"typing", R"(
+        0   press   2 0
+        40  press   8 0
+        60  release 2 0
+        90  release 8 0
+        120 press   9 0
+        150 release 9 0
+    )", "c h spc"},
+    {"tapping", R"(
+        # tapped
+        0   press   3 0
+        50  release 3 0
+        # held past the tapping term
+        300 press   3 0
+        520 press   0 0
+        560 release 0 0
+        600 release 3 0
+    )", "d S-a"},
+    {"combos", R"(
+        0   press   0 0
+        10  press   1 0
+        60  release 0 0
+        65  release 1 0
+        # too slow for the combo
+        200 press   0 0
+        250 release 0 0
+        # interrupted by a key outside the combo
+        400 press   1 0
+        405 press   2 0
+        440 release 1 0
+        445 release 2 0
+    )", "x a b c"},
+    {"tap dance", R"(
+        0   press   6 0
+        40  release 6 0
+        500 press   6 0
+        540 release 6 0
+        600 press   6 0
+        640 release 6 0
+    )", "f g"},
+    {"one-shot mods", R"(
+        0   press   5 0
+        30  release 5 0
+        100 press   2 0
+        140 release 2 0
+        300 press   2 0
+        340 release 2 0
+    )", "S-c c"},
+    {"layers", R"(
+        # momentary
+        0   press   7 0
+        50  press   0 0
+        90  release 0 0
+        120 release 7 0
+        # layer-tap, tapped then held
+        300 press   4 0
+        340 release 4 0
+        600 press   4 0
+        850 press   1 0
+        890 release 1 0
+        950 release 4 0
+    )", "1 e 2"},
+};
+// clang-format on
+
+class TraceReplay : public TestFixture {};
+
+TEST_F(TraceReplay, ParsesTraces) {
+    Trace trace = parse_trace(R"(
+        # comment
+        0  press   3 0
+        25 release 3 0  # trailing comment
+    )");
+    ASSERT_EQ(trace.size(), 2u);
+    EXPECT_EQ(trace[0].time, 0u);
+    EXPECT_EQ(trace[0].col, 3);
+    EXPECT_TRUE(trace[0].pressed);
+    EXPECT_EQ(trace[1].time, 25u);
+    EXPECT_FALSE(trace[1].pressed);
+}
+
+TEST_F(TraceReplay, MeasuresReportsAndLatency) {
+    TraceResult result = replay_trace(parse_trace(scenarios[0].trace), TAPPING_TERM);
+    // Plain keys are reported by the scan that finds them
+    EXPECT_EQ(result.reports.size(), 6u);
+    EXPECT_EQ(result.events.size(), 6u);
+    EXPECT_EQ(result.max_latency_ms(), 0);
+
+    result = replay_trace(parse_trace(R"(
+        0  press   3 0
+        50 release 3 0
+    )"), TAPPING_TERM);
+    // A tap is only reported once the key is released
+    ASSERT_EQ(result.events.size(), 2u);
+    EXPECT_EQ(result.events[0].latency_ms, 50);
+    EXPECT_EQ(result.events[1].latency_ms, 0);
+    EXPECT_EQ(result.typed(), "d");
+}
+
+TEST_F(TraceReplay, Scenarios) {
+    for (auto &scenario : scenarios) {
+        TraceResult result = replay_trace(parse_trace(scenario.trace), TAPPING_TERM + 10);
+        EXPECT_EQ(result.typed(), scenario.typed) << scenario.name;
+        print_trace_result(scenario.name, result);
+    }
+}
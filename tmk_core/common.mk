@@ -66,6 +66,11 @@ ifeq ($(strip $(KEYBOARD_SHARED_EP)), yes)
     MOUSE_SHARED_EP = yes
 endif
 
+ifeq ($(strip $(KEYEVENT_QUEUE_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/keyevent_queue.c
+    TMK_COMMON_DEFS += -DKEYEVENT_QUEUE_ENABLE
+endif
+
 ifeq ($(strip $(MOUSEKEY_ENABLE)), yes)
     TMK_COMMON_SRC += $(COMMON_DIR)/mousekey.c
     TMK_COMMON_DEFS += -DMOUSEKEY_ENABLE
@@ -14,6 +14,59 @@
  */
 layer_state_t default_layer_state = 0;
 
+#if defined(EFFECTIVE_LAYER_CACHE) && !defined(NO_ACTION_LAYER)
+/** \brief effective layer cache
+ *
+ * The topmost non-transparent layer of every key, for the layer state in effective_layer_cache_state
+ */
+static uint8_t       effective_layer_cache[MATRIX_ROWS][MATRIX_COLS];
+static layer_state_t effective_layer_cache_state = 0;
+static bool          effective_layer_cache_valid = false;
+
+static uint8_t effective_layer_resolve(keypos_t key, layer_state_t layers) {
+    /* check top layer first */
+    for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
+        if (layers & ((layer_state_t)1 << i)) {
+            if (action_for_key(i, key).code != ACTION_TRANSPARENT) {
+                return i;
+            }
+        }
+    }
+    /* fall back to layer 0 */
+    return 0;
+}
+
+/** \brief update effective layer cache
+ *
+ * Brings the cache up to date with the current layer state. A key can only
+ * resolve to a different layer if a layer at or above the one it currently
+ * resolves to was switched, so all other keys are left alone.
+ */
+void effective_layer_cache_update(void) {
+    layer_state_t layers = layer_state | default_layer_state;
+    if (effective_layer_cache_valid && layers == effective_layer_cache_state) {
+        return;
+    }
+
+    layer_state_t changed = effective_layer_cache_valid ? layers ^ effective_layer_cache_state : ~(layer_state_t)0;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (changed >> effective_layer_cache[row][col]) {
+                effective_layer_cache[row][col] = effective_layer_resolve((keypos_t){.row = row, .col = col}, layers);
+            }
+        }
+    }
+    effective_layer_cache_state = layers;
+    effective_layer_cache_valid = true;
+}
+
+/** \brief invalidate effective layer cache
+ *
+ * Needs to be called when the keymap itself changes, e.g. by dynamic keymaps
+ */
+void effective_layer_cache_invalidate(void) { effective_layer_cache_valid = false; }
+#endif
+
 /** \brief Default Layer State Set At user Level
  *
  * Run user code on default layer state change
@@ -38,6 +91,9 @@ static void default_layer_state_set(layer_state_t state) {
     default_layer_state = state;
     default_layer_debug();
     debug("\n");
+#if defined(EFFECTIVE_LAYER_CACHE) && !defined(NO_ACTION_LAYER)
+    effective_layer_cache_update();
+#endif
 #ifdef STRICT_LAYER_RELEASE
     clear_keyboard_but_mods();  // To avoid stuck keys
 #else
@@ -104,6 +160,9 @@ void layer_state_set(layer_state_t state) {
     layer_state = state;
     layer_debug();
     dprintln();
+#    ifdef EFFECTIVE_LAYER_CACHE
+    effective_layer_cache_update();
+#    endif
 #    ifdef STRICT_LAYER_RELEASE
     clear_keyboard_but_mods();  // To avoid stuck keys
 #    else
@@ -251,7 +310,15 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
  * Gets the layer based on key info
  */
 uint8_t layer_switch_get_layer(keypos_t key) {
-#ifndef NO_ACTION_LAYER
+#if defined(EFFECTIVE_LAYER_CACHE) && !defined(NO_ACTION_LAYER)
+    // Keys outside of the matrix have no place in the cache
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return effective_layer_resolve(key, layer_state | default_layer_state);
+    }
+    // Also catches layer_state being assigned directly
+    effective_layer_cache_update();
+    return effective_layer_cache[key.row][key.col];
+#elif !defined(NO_ACTION_LAYER)
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
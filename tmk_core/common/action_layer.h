@@ -115,6 +115,11 @@ uint8_t read_source_layers_cache(keypos_t key);
 #endif
 action_t store_or_get_action(bool pressed, keypos_t key);
 
+#if defined(EFFECTIVE_LAYER_CACHE) && !defined(NO_ACTION_LAYER)
+void effective_layer_cache_update(void);
+void effective_layer_cache_invalidate(void);
+#endif
+
 /* return the topmost non-transparent layer currently associated with key */
 uint8_t layer_switch_get_layer(keypos_t key);
 
@@ -1,9 +1,11 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "action.h"
 #include "action_layer.h"
 #include "action_tapping.h"
 #include "keycode.h"
+#include "matrix.h"
 #include "timer.h"
 
 #ifdef DEBUG_ACTION
@@ -21,10 +23,21 @@
 
 __attribute__((weak)) uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) { return TAPPING_TERM; }
 
+#    ifdef KEYEVENT_TIME_US
+// Decisions are made on the time the matrix scans found the events at
+#        define TAPPING_ELAPSED(e) TIMER_DIFF_32(e.time_us, tapping_key.event.time_us)
+#        define TAPPING_TERM_TIME(term) ((uint32_t)(term)*1000)
+#        define TAPPING_ELAPSED_MS(e) (TAPPING_ELAPSED(e) / 1000)
+#    else
+#        define TAPPING_ELAPSED(e) TIMER_DIFF_16(e.time, tapping_key.event.time)
+#        define TAPPING_TERM_TIME(term) (term)
+#        define TAPPING_ELAPSED_MS(e) TAPPING_ELAPSED(e)
+#    endif
+
 #    ifdef TAPPING_TERM_PER_KEY
-#        define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16(e.time, tapping_key.event.time) < get_tapping_term(get_event_keycode(tapping_key.event, false), &tapping_key))
+#        define WITHIN_TAPPING_TERM(e) (TAPPING_ELAPSED(e) < TAPPING_TERM_TIME(get_tapping_term(get_event_keycode(tapping_key.event, false), &tapping_key)))
 #    else
-#        define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16(e.time, tapping_key.event.time) < TAPPING_TERM)
+#        define WITHIN_TAPPING_TERM(e) (TAPPING_ELAPSED(e) < TAPPING_TERM_TIME(TAPPING_TERM))
 #    endif
 
 #    ifdef TAPPING_FORCE_HOLD_PER_KEY
@@ -40,7 +53,17 @@ static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t     waiting_buffer_head                 = 0;
 static uint8_t     waiting_buffer_tail                 = 0;
 
+#    ifdef TAP_HOLD_LOOKAHEAD
+// Keys tapped by the lookahead and released before they physically were
+static matrix_row_t released_early[MATRIX_ROWS] = {};
+#    endif
+
 static bool process_tapping(keyrecord_t *record);
+#    ifdef TAP_HOLD_LOOKAHEAD
+static bool tap_hold_lookahead(keyrecord_t *keyp);
+static void tap_hold_release_early(keyevent_t event);
+static bool tap_hold_released_early(keyevent_t event);
+#    endif
 static bool waiting_buffer_enq(keyrecord_t record);
 static void waiting_buffer_clear(void);
 static bool waiting_buffer_typed(keyevent_t event);
@@ -67,6 +90,9 @@ void action_tapping_process(keyrecord_t record) {
             clear_keyboard();
             waiting_buffer_clear();
             tapping_key = (keyrecord_t){};
+#    ifdef TAP_HOLD_LOOKAHEAD
+            memset(released_early, 0, sizeof(released_early));
+#    endif
         }
     }
 
@@ -99,6 +125,14 @@ void action_tapping_process(keyrecord_t record) {
 bool process_tapping(keyrecord_t *keyp) {
     keyevent_t event = keyp->event;
 
+#    ifdef TAP_HOLD_LOOKAHEAD
+    // its tap was already released, so this must not be taken for the release of a hold
+    if (tap_hold_released_early(event)) {
+        debug("Tapping: Lookahead. Release of a key released early.\n");
+        return true;
+    }
+#    endif
+
     // if tapping
     if (IS_TAPPING_PRESSED()) {
         if (WITHIN_TAPPING_TERM(event)) {
@@ -115,6 +149,12 @@ bool process_tapping(keyrecord_t *keyp) {
                     // enqueue
                     return false;
                 }
+#    ifdef TAP_HOLD_LOOKAHEAD
+                else if (tap_hold_lookahead(keyp)) {
+                    // enqueue, the waiting buffer is processed again with the key settled
+                    return false;
+                }
+#    endif
                 /* Process a key typed within TAPPING_TERM
                  * This can register the key before settlement of tapping,
                  * useful for long TAPPING_TERM but may prevent fast typing.
@@ -180,10 +220,22 @@ bool process_tapping(keyrecord_t *keyp) {
                     debug_tapping_key();
                     return true;
                 } else if (is_tap_key(event.key) && event.pressed) {
-                    if (tapping_key.tap.count > 1) {
+                    if (tapping_key.tap.count > 1
+#    ifdef TAP_HOLD_LOOKAHEAD
+                        // tapped by the lookahead while still held
+                        || !waiting_buffer_typed(tapping_key.event)
+#    endif
+                    ) {
                         debug("Tapping: Start new tap with releasing last tap(>1).\n");
                         // unregister key
-                        process_record(&(keyrecord_t){.tap = tapping_key.tap, .event.key = tapping_key.event.key, .event.time = event.time, .event.pressed = false});
+                        // takes the time(s) of the event that ends the tap
+                        keyrecord_t release   = {.tap = tapping_key.tap, .event = event};
+                        release.event.key     = tapping_key.event.key;
+                        release.event.pressed = false;
+                        process_record(&release);
+#    ifdef TAP_HOLD_LOOKAHEAD
+                        tap_hold_release_early(tapping_key.event);
+#    endif
                     } else {
                         debug("Tapping: Start while last tap(1).\n");
                     }
@@ -218,10 +270,21 @@ bool process_tapping(keyrecord_t *keyp) {
                     tapping_key = (keyrecord_t){};
                     return true;
                 } else if (is_tap_key(event.key) && event.pressed) {
-                    if (tapping_key.tap.count > 1) {
+                    if (tapping_key.tap.count > 1
+#    ifdef TAP_HOLD_LOOKAHEAD
+                        || !waiting_buffer_typed(tapping_key.event)
+#    endif
+                    ) {
                         debug("Tapping: Start new tap with releasing last timeout tap(>1).\n");
                         // unregister key
-                        process_record(&(keyrecord_t){.tap = tapping_key.tap, .event.key = tapping_key.event.key, .event.time = event.time, .event.pressed = false});
+                        // takes the time(s) of the event that ends the tap
+                        keyrecord_t release   = {.tap = tapping_key.tap, .event = event};
+                        release.event.key     = tapping_key.event.key;
+                        release.event.pressed = false;
+                        process_record(&release);
+#    ifdef TAP_HOLD_LOOKAHEAD
+                        tap_hold_release_early(tapping_key.event);
+#    endif
                     } else {
                         debug("Tapping: Start while last timeout tap(1).\n");
                     }
@@ -310,6 +373,108 @@ bool process_tapping(keyrecord_t *keyp) {
     }
 }
 
+#    ifdef TAP_HOLD_LOOKAHEAD
+__attribute__((weak)) tap_hold_hand_t get_tap_hold_hand(keypos_t key) {
+#        ifdef SPLIT_KEYBOARD
+    return key.row < MATRIX_ROWS / 2 ? TAP_HOLD_HAND_LEFT : TAP_HOLD_HAND_RIGHT;
+#        else
+    return key.col < MATRIX_COLS / 2 ? TAP_HOLD_HAND_LEFT : TAP_HOLD_HAND_RIGHT;
+#        endif
+}
+
+__attribute__((weak)) tap_hold_decision_t get_tap_hold_decision(uint16_t keycode, keyrecord_t *tapping_key, const tap_hold_event_t *events, uint8_t count, uint16_t now) { return tap_hold_lookahead_decision(keycode, tapping_key, events, count, now); }
+
+/** \brief Default tap-hold decision
+ *
+ * Goes through the keys pressed after the tap-hold key, in order. The first
+ * one that gives any evidence settles it:
+ * - a key of the same hand means typing, and settles it as tapped
+ * - a key released while the tap-hold key is held settles it as held
+ * - so does a key held along with it for TAP_HOLD_OVERLAP_TERM
+ * Keys of either hand(TAP_HOLD_HAND_ANY) only count as the latter.
+ */
+tap_hold_decision_t tap_hold_lookahead_decision(uint16_t keycode, keyrecord_t *tapping_key, const tap_hold_event_t *events, uint8_t count, uint16_t now) {
+    tap_hold_hand_t hand = get_tap_hold_hand(tapping_key->event.key);
+
+    for (uint8_t i = 0; i < count; i++) {
+        // releases of keys pressed before the tap-hold key say nothing
+        if (!events[i].pressed) continue;
+
+        if (hand != TAP_HOLD_HAND_ANY && get_tap_hold_hand(events[i].key) == hand) {
+            return TAP_HOLD_TAP;
+        }
+        for (uint8_t j = i + 1; j < count; j++) {
+            if (!events[j].pressed && KEYEQ(events[j].key, events[i].key)) {
+                return TAP_HOLD_HOLD;
+            }
+        }
+        if (now - events[i].time >= TAP_HOLD_OVERLAP_TERM) {
+            return TAP_HOLD_HOLD;
+        }
+    }
+    return TAP_HOLD_UNDECIDED;
+}
+
+/** \brief Tap-hold lookahead
+ *
+ * Settles the tapping key as soon as the waiting buffer and the current
+ * event(or scan) are enough to tell. Returns true if it was settled.
+ */
+static bool tap_hold_lookahead(keyrecord_t *keyp) {
+    tap_hold_event_t events[WAITING_BUFFER_SIZE];
+    uint8_t          count = 0;
+
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+        events[count++] = (tap_hold_event_t){.key = waiting_buffer[i].event.key, .pressed = waiting_buffer[i].event.pressed, .time = TAPPING_ELAPSED_MS(waiting_buffer[i].event)};
+    }
+    // the buffer holds one event less than its size, so there is room for the current one
+    if (!IS_NOEVENT(keyp->event)) {
+        events[count++] = (tap_hold_event_t){.key = keyp->event.key, .pressed = keyp->event.pressed, .time = TAPPING_ELAPSED_MS(keyp->event)};
+    }
+
+    switch (get_tap_hold_decision(get_event_keycode(tapping_key.event, false), &tapping_key, events, count, TAPPING_ELAPSED_MS(keyp->event))) {
+        case TAP_HOLD_TAP:
+            debug("Tapping: Lookahead. Tap.\n");
+            tapping_key.tap.count       = 1;
+            tapping_key.tap.interrupted = false;
+            process_record(&tapping_key);
+            debug_tapping_key();
+            return true;
+        case TAP_HOLD_HOLD:
+            debug("Tapping: Lookahead. Hold.\n");
+            process_record(&tapping_key);
+            tapping_key = (keyrecord_t){};
+            debug_tapping_key();
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** \brief Tap-hold release early
+ *
+ * Remembers a key whose tap was released while the key is still held, so
+ * that its physical release can be swallowed.
+ */
+static void tap_hold_release_early(keyevent_t event) {
+    if (!event.pressed || event.key.row >= MATRIX_ROWS || event.key.col >= MATRIX_COLS) return;
+    released_early[event.key.row] |= (matrix_row_t)1 << event.key.col;
+}
+
+/** \brief Tap-hold released early
+ *
+ * Returns true, and forgets the key, for the physical release of a key
+ * released early.
+ */
+static bool tap_hold_released_early(keyevent_t event) {
+    if (event.pressed || event.key.row >= MATRIX_ROWS || event.key.col >= MATRIX_COLS) return false;
+    matrix_row_t bit = (matrix_row_t)1 << event.key.col;
+    if (!(released_early[event.key.row] & bit)) return false;
+    released_early[event.key.row] &= ~bit;
+    return true;
+}
+#    endif
+
 /** \brief Waiting buffer enq
  *
  * FIXME: Needs docs
@@ -29,6 +29,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define WAITING_BUFFER_SIZE 8
 
+/* time another key has to be held along with a tap-hold key before the lookahead settles it as held(ms) */
+#ifndef TAP_HOLD_OVERLAP_TERM
+#    define TAP_HOLD_OVERLAP_TERM 70
+#endif
+
 #ifndef NO_ACTION_TAPPING
 uint16_t get_event_keycode(keyevent_t event, bool update_layer_cache);
 void     action_tapping_process(keyrecord_t record);
@@ -38,4 +43,33 @@ bool get_permissive_hold(uint16_t keycode, keyrecord_t *record);
 bool get_ignore_mod_tap_interrupt(uint16_t keycode, keyrecord_t *record);
 bool get_tapping_force_hold(uint16_t keycode, keyrecord_t *record);
 bool get_retro_tapping(uint16_t keycode, keyrecord_t *record);
+
+#    ifdef TAP_HOLD_LOOKAHEAD
+typedef enum {
+    TAP_HOLD_UNDECIDED,
+    TAP_HOLD_TAP,
+    TAP_HOLD_HOLD,
+} tap_hold_decision_t;
+
+typedef enum {
+    TAP_HOLD_HAND_ANY,
+    TAP_HOLD_HAND_LEFT,
+    TAP_HOLD_HAND_RIGHT,
+} tap_hold_hand_t;
+
+/* An event that followed the press of the tap-hold key, in order */
+typedef struct {
+    keypos_t key;
+    bool     pressed;
+    uint16_t time; /* ms after the press of the tap-hold key */
+} tap_hold_event_t;
+
+/* Called while a tap-hold key is held and undecided, with the events waiting
+ * behind it, and the time(ms after its press) of the latest scan.
+ */
+tap_hold_decision_t get_tap_hold_decision(uint16_t keycode, keyrecord_t *tapping_key, const tap_hold_event_t *events, uint8_t count, uint16_t now);
+/* The default decision, for get_tap_hold_decision() to fall back on */
+tap_hold_decision_t tap_hold_lookahead_decision(uint16_t keycode, keyrecord_t *tapping_key, const tap_hold_event_t *events, uint8_t count, uint16_t now);
+tap_hold_hand_t     get_tap_hold_hand(keypos_t key);
+#    endif
 #endif
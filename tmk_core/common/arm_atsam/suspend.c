@@ -3,6 +3,10 @@
 #include "md_rgb_matrix.h"
 #include "suspend.h"
 
+#ifdef EEPROM_DEFERRED_ENABLE
+#    include "eeprom_deferred.h"
+#endif
+
 /** \brief Suspend idle
  *
  * FIXME: needs doc
@@ -27,6 +31,10 @@ __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+#ifdef EEPROM_DEFERRED_ENABLE
+    // Power may be cut while suspended, so commit pending settings now
+    eeprom_deferred_flush();
+#endif
 #ifdef RGB_MATRIX_ENABLE
     I2C3733_Control_Set(0);  // Disable LED driver
 #endif
@@ -16,4 +16,21 @@ uint16_t timer_elapsed(uint16_t tlast) { return TIMER_DIFF_16(timer_read(), tlas
 
 uint32_t timer_elapsed32(uint32_t tlast) { return TIMER_DIFF_32(timer_read32(), tlast); }
 
+// TC4 counts microseconds up to the next millisecond tick
+uint32_t timer_read_us(void) {
+    uint64_t ms;
+    uint16_t us;
+    do {
+        ms                        = ms_clk;
+        TC4->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_READSYNC;
+        while (TC4->COUNT16.SYNCBUSY.bit.CTRLB || TC4->COUNT16.SYNCBUSY.bit.COUNT) {
+        }
+        us = TC4->COUNT16.COUNT.reg;
+    } while (ms != ms_clk);  // read again if a millisecond tick happened in between
+
+    return (uint32_t)(ms * 1000 + us);
+}
+
+uint32_t timer_elapsed_us(uint32_t tlast) { return TIMER_DIFF_32(timer_read_us(), tlast); }
+
 void timer_clear(void) { set_time(0); }
@@ -22,6 +22,10 @@
 #    include "audio.h"
 #endif /* AUDIO_ENABLE */
 
+#ifdef EEPROM_DEFERRED_ENABLE
+#    include "eeprom_deferred.h"
+#endif
+
 #if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE)
 #    include "rgblight.h"
 extern rgblight_config_t rgblight_config;
@@ -135,6 +139,10 @@ static void power_down(uint8_t wdto) {
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+#ifdef EEPROM_DEFERRED_ENABLE
+    // Power may be cut while suspended, so commit pending settings now
+    eeprom_deferred_flush();
+#endif
     suspend_power_down_kb();
 
 #ifndef NO_SUSPEND_POWER_DOWN
@@ -130,4 +130,45 @@ inline uint32_t timer_elapsed32(uint32_t last) {
 #else
 #    define TIMER_INTERRUPT_VECTOR TIMER0_COMP_vect
 #endif
+
+#if defined(__AVR_ATmega32A__)
+#    define TIMER_INTERRUPT_FLAGS TIFR
+#    define TIMER_INTERRUPT_FLAG OCF0
+#elif defined(__AVR_ATtiny85__)
+#    define TIMER_INTERRUPT_FLAGS TIFR
+#    define TIMER_INTERRUPT_FLAG OCF0A
+#else
+#    define TIMER_INTERRUPT_FLAGS TIFR0
+#    define TIMER_INTERRUPT_FLAG OCF0A
+#endif
+
+/** \brief timer read microseconds
+ *
+ * Combines the millisecond count with the raw value of Timer0, so the
+ * resolution is one Timer0 tick (4us at 16MHz).
+ */
+uint32_t timer_read_us(void) {
+    uint32_t t;
+    uint8_t  raw;
+    bool     pending;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t       = timer_count;
+        raw     = TIMER_RAW;
+        pending = TIMER_INTERRUPT_FLAGS & _BV(TIMER_INTERRUPT_FLAG);
+    }
+    // Timer0 has already wrapped around, but the interrupt hasn't counted it yet
+    if (pending && raw < TIMER_RAW_TOP / 2) {
+        t++;
+    }
+
+    return t * 1000 + (uint32_t)raw * 1000 / (TIMER_RAW_TOP + 1);
+}
+
+/** \brief timer elapsed microseconds
+ *
+ * Microseconds since last, a value returned by timer_read_us(). The count
+ * wraps around every 71 minutes, so only shorter intervals can be measured.
+ */
+uint32_t timer_elapsed_us(uint32_t last) { return TIMER_DIFF_32(timer_read_us(), last); }
 ISR(TIMER_INTERRUPT_VECTOR, ISR_NOBLOCK) { timer_count++; }
@@ -102,6 +102,80 @@ uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
     }
     return FlashStatus;
 }
+/*****************************************************************************
+ *  Writes a block of data bytes, touching each affected page at most once.
+ *  If all changed bytes within a page are still empty, they are simply
+ *  programmed, otherwise the page is erased and rewritten with all of its
+ *  changes applied at once. Pages without changes are skipped.
+ *******************************************************************************/
+uint16_t EEPROM_WriteDataBlock(uint16_t Address, const uint8_t *DataBlock, uint16_t Length) {
+    FLASH_Status FlashStatus = FLASH_COMPLETE;
+
+    uint32_t page;
+    uint16_t count;
+    bool     changed;
+    bool     rewrite;
+    int      i;
+
+    // clamp to the limit (e.G. under 2048 Bytes for 4 pages)
+    if (Address > FEE_DENSITY_BYTES) {
+        return 0;
+    }
+    if (Length > FEE_DENSITY_BYTES + 1 - Address) {
+        Length = FEE_DENSITY_BYTES + 1 - Address;
+    }
+
+    while (Length > 0) {
+        // calculate which page is affected, and how many of the bytes are within it
+        page  = FEE_ADDR_OFFSET(Address) / FEE_PAGE_SIZE;
+        count = ((page + 1) * (FEE_PAGE_SIZE / 2)) - Address;
+        if (count > Length) {
+            count = Length;
+        }
+
+        changed = false;
+        rewrite = false;
+        for (i = 0; i < count; i++) {
+            if (EEPROM_ReadDataByte(Address + i) != DataBlock[i]) {
+                changed = true;
+                if ((*(__IO uint16_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address + i))) != FEE_EMPTY_WORD) {
+                    rewrite = true;
+                    break;
+                }
+            }
+        }
+
+        if (rewrite) {
+            // Copy Page to a buffer, and apply all the changes to it
+            memcpy(DataBuf, (uint8_t *)FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE), FEE_PAGE_SIZE);
+            for (i = 0; i < count; i++) {
+                DataBuf[FEE_ADDR_OFFSET(Address + i) % FEE_PAGE_SIZE] = DataBlock[i];
+            }
+
+            // Erase Page
+            FlashStatus = FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE));
+
+            // Write new data (whole page) to flash
+            for (i = 0; i < (FEE_PAGE_SIZE / 2); i++) {
+                if ((__IO uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]) != 0xFFFF) {
+                    FlashStatus = FLASH_ProgramHalfWord((FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE)) + (i * 2), (uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]));
+                }
+            }
+        } else if (changed) {
+            // Only empty bytes are affected, just overwrite them with the new ones
+            for (i = 0; i < count; i++) {
+                if (EEPROM_ReadDataByte(Address + i) != DataBlock[i]) {
+                    FlashStatus = FLASH_ProgramHalfWord(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address + i), (uint16_t)(0x00FF & DataBlock[i]));
+                }
+            }
+        }
+
+        Address += count;
+        DataBlock += count;
+        Length -= count;
+    }
+    return FlashStatus;
+}
 /*****************************************************************************
  *  Read once data byte from a specified address.
  *******************************************************************************/
@@ -138,16 +212,12 @@ uint16_t eeprom_read_word(const uint16_t *Address) {
 }
 
 void eeprom_write_word(uint16_t *Address, uint16_t Value) {
-    uint16_t p = (uint32_t)Address;
-    EEPROM_WriteDataByte(p, (uint8_t)Value);
-    EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
+    uint16_t p       = (uint32_t)Address;
+    uint8_t  data[2] = {(uint8_t)Value, (uint8_t)(Value >> 8)};
+    EEPROM_WriteDataBlock(p, data, 2);
 }
 
-void eeprom_update_word(uint16_t *Address, uint16_t Value) {
-    uint16_t p = (uint32_t)Address;
-    EEPROM_WriteDataByte(p, (uint8_t)Value);
-    EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
-}
+void eeprom_update_word(uint16_t *Address, uint16_t Value) { eeprom_write_word(Address, Value); }
 
 uint32_t eeprom_read_dword(const uint32_t *Address) {
     const uint16_t p = (const uint32_t)Address;
@@ -155,23 +225,12 @@ uint32_t eeprom_read_dword(const uint32_t *Address) {
 }
 
 void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
-    uint16_t p = (const uint32_t)Address;
-    EEPROM_WriteDataByte(p, (uint8_t)Value);
-    EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
-    EEPROM_WriteDataByte(p + 2, (uint8_t)(Value >> 16));
-    EEPROM_WriteDataByte(p + 3, (uint8_t)(Value >> 24));
+    uint16_t p       = (const uint32_t)Address;
+    uint8_t  data[4] = {(uint8_t)Value, (uint8_t)(Value >> 8), (uint8_t)(Value >> 16), (uint8_t)(Value >> 24)};
+    EEPROM_WriteDataBlock(p, data, 4);
 }
 
-void eeprom_update_dword(uint32_t *Address, uint32_t Value) {
-    uint16_t p             = (const uint32_t)Address;
-    uint32_t existingValue = EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8) | (EEPROM_ReadDataByte(p + 2) << 16) | (EEPROM_ReadDataByte(p + 3) << 24);
-    if (Value != existingValue) {
-        EEPROM_WriteDataByte(p, (uint8_t)Value);
-        EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
-        EEPROM_WriteDataByte(p + 2, (uint8_t)(Value >> 16));
-        EEPROM_WriteDataByte(p + 3, (uint8_t)(Value >> 24));
-    }
-}
+void eeprom_update_dword(uint32_t *Address, uint32_t Value) { eeprom_write_dword(Address, Value); }
 
 void eeprom_read_block(void *buf, const void *addr, size_t len) {
     const uint8_t *p    = (const uint8_t *)addr;
@@ -182,17 +241,8 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
 }
 
 void eeprom_write_block(const void *buf, void *addr, size_t len) {
-    uint8_t *      p   = (uint8_t *)addr;
-    const uint8_t *src = (const uint8_t *)buf;
-    while (len--) {
-        eeprom_write_byte(p++, *src++);
-    }
+    uint16_t p = (uint32_t)addr;
+    EEPROM_WriteDataBlock(p, (const uint8_t *)buf, len);
 }
 
-void eeprom_update_block(const void *buf, void *addr, size_t len) {
-    uint8_t *      p   = (uint8_t *)addr;
-    const uint8_t *src = (const uint8_t *)buf;
-    while (len--) {
-        eeprom_write_byte(p++, *src++);
-    }
-}
+void eeprom_update_block(const void *buf, void *addr, size_t len) { eeprom_write_block(buf, addr, len); }
@@ -81,4 +81,5 @@
 uint16_t EEPROM_Init(void);
 void     EEPROM_Erase(void);
 uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte);
+uint16_t EEPROM_WriteDataBlock(uint16_t Address, const uint8_t *DataBlock, uint16_t Length);
 uint8_t  EEPROM_ReadDataByte(uint16_t Address);
@@ -16,6 +16,10 @@
 #    include "backlight.h"
 #endif
 
+#ifdef EEPROM_DEFERRED_ENABLE
+#    include "eeprom_deferred.h"
+#endif
+
 #if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE)
 #    include "rgblight.h"
 extern rgblight_config_t rgblight_config;
@@ -48,6 +52,10 @@ __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+#ifdef EEPROM_DEFERRED_ENABLE
+    // Power may be cut while suspended, so commit pending settings now
+    eeprom_deferred_flush();
+#endif
 #ifdef BACKLIGHT_ENABLE
     backlight_set(0);
 #endif
@@ -7,6 +7,8 @@ static uint32_t reset_point = 0;
 static uint32_t last_systime = 0;
 static uint32_t overflow     = 0;
 #endif
+static systime_t us_last_systime = 0;
+static uint64_t  us_ticks        = 0;
 
 void timer_init(void) { timer_clear(); }
 
@@ -45,3 +47,24 @@ uint32_t timer_read32(void) {
 uint16_t timer_elapsed(uint16_t last) { return TIMER_DIFF_16(timer_read(), last); }
 
 uint32_t timer_elapsed32(uint32_t last) { return TIMER_DIFF_32(timer_read32(), last); }
+
+uint32_t timer_read_us(void) {
+    // The system timer is free-running, its ticks are accumulated so that the
+    // conversion to microseconds doesn't jump when the tick counter wraps around.
+    // As for timer_read32(), this has to be called at least once per wrap around.
+    chSysLock();
+    systime_t systime = chVTGetSystemTimeX();
+    us_ticks += chTimeDiffX(us_last_systime, systime);
+    us_last_systime = systime;
+    uint64_t ticks  = us_ticks;
+    chSysUnlock();
+
+    // The conversion is left out of the critical section, a 64-bit division takes long on Cortex-M
+#if 1000000 % CH_CFG_ST_FREQUENCY == 0
+    return (uint32_t)ticks * (1000000 / CH_CFG_ST_FREQUENCY);
+#else
+    return (uint32_t)(ticks * 1000000 / CH_CFG_ST_FREQUENCY);
+#endif
+}
+
+uint32_t timer_elapsed_us(uint32_t last) { return TIMER_DIFF_32(timer_read_us(), last); }
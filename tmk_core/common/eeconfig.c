@@ -1,8 +1,10 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "eeprom.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "eeprom_deferred.h"
 
 #ifdef STM32_EEPROM_ENABLE
 #    include <hal.h>
@@ -17,6 +19,11 @@
 #    include "haptic.h"
 #endif
 
+// Helpers to fill in a copy of the eeconfig area in RAM, in the same byte order as eeprom_update_word() and friends
+static inline void eeconfig_set_byte(uint8_t *eeconfig, uint8_t *addr, uint8_t value) { eeconfig[(uintptr_t)addr] = value; }
+static inline void eeconfig_set_word(uint8_t *eeconfig, uint16_t *addr, uint16_t value) { memcpy(&eeconfig[(uintptr_t)addr], &value, sizeof(value)); }
+static inline void eeconfig_set_dword(uint8_t *eeconfig, uint32_t *addr, uint32_t value) { memcpy(&eeconfig[(uintptr_t)addr], &value, sizeof(value)); }
+
 /** \brief eeconfig enable
  *
  * FIXME: needs doc
@@ -37,45 +44,49 @@ __attribute__((weak)) void eeconfig_init_kb(void) {
  * FIXME: needs doc
  */
 void eeconfig_init_quantum(void) {
+    // Anything still pending predates the reset
+    eeprom_deferred_discard();
 #ifdef STM32_EEPROM_ENABLE
     EEPROM_Erase();
 #endif
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
 #endif
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
-    eeprom_update_byte(EECONFIG_DEBUG, 0);
-    eeprom_update_byte(EECONFIG_DEFAULT_LAYER, 0);
+    // Build the defaults in RAM and write them out as one block, so the EEPROM
+    // driver can coalesce them into as few writes as possible. Anything not
+    // reset here keeps its current value.
+    uint8_t eeconfig[EECONFIG_SIZE];
+    eeprom_read_block(eeconfig, 0, EECONFIG_SIZE);
+    eeconfig_set_word(eeconfig, EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeconfig_set_byte(eeconfig, EECONFIG_DEBUG, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_DEFAULT_LAYER, 0);
     default_layer_state = 0;
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
-    eeprom_update_byte(EECONFIG_BACKLIGHT, 0);
-    eeprom_update_byte(EECONFIG_AUDIO, 0xFF);  // On by default
-    eeprom_update_dword(EECONFIG_RGBLIGHT, 0);
-    eeprom_update_byte(EECONFIG_STENOMODE, 0);
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
-    eeprom_update_byte(EECONFIG_VELOCIKEY, 0);
-    eeprom_update_dword(EECONFIG_RGB_MATRIX, 0);
-    eeprom_update_byte(EECONFIG_RGB_MATRIX_SPEED, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_KEYMAP_LOWER_BYTE, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_KEYMAP_UPPER_BYTE, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_MOUSEKEY_ACCEL, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_BACKLIGHT, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_AUDIO, 0xFF);  // On by default
+    eeconfig_set_dword(eeconfig, EECONFIG_RGBLIGHT, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_STENOMODE, 0);
+    eeconfig_set_dword(eeconfig, EECONFIG_HAPTIC, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_VELOCIKEY, 0);
+    eeconfig_set_dword(eeconfig, EECONFIG_RGB_MATRIX, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_RGB_MATRIX_SPEED, 0);
 
     // TODO: Remove once ARM has a way to configure EECONFIG_HANDEDNESS
     //        within the emulated eeprom via dfu-util or another tool
 #if defined INIT_EE_HANDS_LEFT
 #    pragma message "Faking EE_HANDS for left hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 1);
+    eeconfig_set_byte(eeconfig, EECONFIG_HANDEDNESS, 1);
 #elif defined INIT_EE_HANDS_RIGHT
 #    pragma message "Faking EE_HANDS for right hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 0);
+    eeconfig_set_byte(eeconfig, EECONFIG_HANDEDNESS, 0);
 #endif
 
+    eeprom_update_block(eeconfig, 0, EECONFIG_SIZE);
+
 #if defined(HAPTIC_ENABLE)
     haptic_reset();
-#else
-    // this is used in case haptic is disabled, but we still want sane defaults
-    // in the haptic configuration eeprom. All zero will trigger a haptic_reset
-    // when a haptic-enabled firmware is loaded onto the keyboard.
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
 #endif
 
     eeconfig_init_kb();
@@ -159,12 +170,16 @@ void eeconfig_update_keymap(uint16_t val) {
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_backlight(void) { return eeprom_read_byte(EECONFIG_BACKLIGHT); }
+uint8_t eeconfig_read_backlight(void) {
+    uint8_t val;
+    eeprom_deferred_read_block(&val, EECONFIG_BACKLIGHT, sizeof(val));
+    return val;
+}
 /** \brief eeconfig update backlight
  *
  * FIXME: needs doc
  */
-void eeconfig_update_backlight(uint8_t val) { eeprom_update_byte(EECONFIG_BACKLIGHT, val); }
+void eeconfig_update_backlight(uint8_t val) { eeprom_deferred_update_block(&val, EECONFIG_BACKLIGHT, sizeof(val)); }
 
 /** \brief eeconfig read audio
  *
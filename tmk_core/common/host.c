@@ -21,6 +21,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#ifdef SPLIT_LED_STATE_ENABLE
+#    include "keyboard.h"
+#    include "split_shared.h"
+#endif
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -36,11 +40,18 @@ void host_set_driver(host_driver_t *d) { driver = d; }
 host_driver_t *host_get_driver(void) { return driver; }
 
 uint8_t host_keyboard_leds(void) {
+#ifdef SPLIT_LED_STATE_ENABLE
+    // The slave only knows them from the master
+    if (!is_keyboard_master()) return split_shared_led_state();
+#endif
     if (!driver) return 0;
     return (*driver->keyboard_leds)();
 }
 
 led_t host_keyboard_led_state(void) {
+#ifdef SPLIT_LED_STATE_ENABLE
+    if (!is_keyboard_master()) return (led_t)split_shared_led_state();
+#endif
     if (!driver) return (led_t){0};
     return (led_t)((*driver->keyboard_leds)());
 }
@@ -92,9 +92,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VIA_ENABLE
 #    include "via.h"
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#    include "dynamic_keymap.h"
+#endif
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
+#ifdef EEPROM_DEFERRED_ENABLE
+#    include "eeprom_deferred.h"
+#endif
+#ifdef I2C_ASYNC_ENABLE
+#    include "i2c_async.h"
+#endif
+#ifdef DEFERRED_EXEC_ENABLE
+#    include "deferred_exec.h"
+#endif
+#ifdef KEYEVENT_QUEUE_ENABLE
+#    include "keyevent_queue.h"
+#endif
 
 // Only enable this if console is enabled to print to
 #if defined(DEBUG_MATRIX_SCAN_RATE) && defined(CONSOLE_ENABLE)
@@ -178,6 +193,21 @@ void disable_jtag(void) {
  */
 __attribute__((weak)) void matrix_setup(void) {}
 
+#ifdef KEYEVENT_TIME_US
+static uint32_t scan_time_us = 0;
+
+/** \brief Records the time of the current matrix scan
+ *
+ * keyboard_task() calls this just before matrix_scan(), matrices call it
+ * again when they actually read the switches.
+ */
+void matrix_scan_timestamp(void) { scan_time_us = timer_read_us(); }
+
+/** \brief Time of the last matrix scan, in microseconds
+ */
+uint32_t matrix_scan_time_us(void) { return scan_time_us; }
+#endif
+
 /** \brief keyboard_pre_init_user
  *
  * FIXME: needs doc
@@ -258,6 +288,8 @@ void keyboard_init(void) {
     matrix_init();
 #ifdef VIA_ENABLE
     via_init();
+#elif defined(DYNAMIC_KEYMAP_ENABLE)
+    dynamic_keymap_init();
 #endif
 #ifdef QWIIC_ENABLE
     qwiic_init();
@@ -312,6 +344,51 @@ void keyboard_init(void) {
     keyboard_post_init_kb(); /* Always keep this last */
 }
 
+#ifdef KEYEVENT_QUEUE_ENABLE
+/** \brief Queues the changes between the matrix and matrix_prev
+ *
+ * Returns false if the queue filled up before all of them were queued, the
+ * rest are left in the difference for the next call.
+ */
+static bool queue_matrix_changes(matrix_row_t matrix_prev[], uint16_t time) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row_t matrix_row    = matrix_get_row(r);
+        matrix_row_t matrix_change = matrix_row ^ matrix_prev[r];
+        if (matrix_change) {
+#    ifdef MATRIX_HAS_GHOST
+            if (has_ghost_in_row(r, matrix_row)) {
+                continue;
+            }
+#    endif
+            if (debug_matrix) matrix_print();
+            matrix_row_t col_mask = 1;
+            for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
+                if (matrix_change & col_mask) {
+                    keyevent_t event = {.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = time};
+#    ifdef KEYEVENT_TIME_US
+                    event.time_us = matrix_scan_time_us();
+#    endif
+                    if (!keyevent_queue_push(event)) {
+                        return false;
+                    }
+                    // record a queued key
+                    matrix_prev[r] ^= col_mask;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static inline bool keys_per_scan_reached(uint16_t keys_processed) {
+#    ifdef QMK_KEYS_PER_SCAN
+    return keys_processed >= QMK_KEYS_PER_SCAN;
+#    else
+    return false;
+#    endif
+}
+#endif
+
 /** \brief Keyboard task: Do keyboard routine jobs
  *
  * Do routine keyboard jobs:
@@ -326,22 +403,58 @@ void keyboard_init(void) {
  */
 void keyboard_task(void) {
     static matrix_row_t matrix_prev[MATRIX_ROWS];
-    static uint8_t      led_status    = 0;
-    matrix_row_t        matrix_row    = 0;
-    matrix_row_t        matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
+    static uint8_t      led_status = 0;
+#ifndef KEYEVENT_QUEUE_ENABLE
+    matrix_row_t matrix_row    = 0;
+    matrix_row_t matrix_change = 0;
+#    ifdef QMK_KEYS_PER_SCAN
     uint8_t keys_processed = 0;
+#    endif
 #endif
 
+#ifdef EEPROM_DEFERRED_ENABLE
+    eeprom_deferred_task();
+#endif
+#ifdef I2C_ASYNC_ENABLE
+    i2c_async_task();
+#endif
+#ifdef DEFERRED_EXEC_ENABLE
+    deferred_exec_task();
+#endif
     housekeeping_task_kb();
     housekeeping_task_user();
 
+#ifdef KEYEVENT_TIME_US
+    matrix_scan_timestamp();
+#endif
 #if defined(OLED_DRIVER_ENABLE) && !defined(OLED_DISABLE_TIMEOUT)
     uint8_t ret = matrix_scan();
 #else
     matrix_scan();
 #endif
 
+#ifdef KEYEVENT_QUEUE_ENABLE
+    // Every change found by this scan is processed in this call, stamped with the time of the scan,
+    // unless QMK_KEYS_PER_SCAN leaves some of them queued for the next calls
+    uint16_t keys_processed = 0;
+    if (should_process_keypress()) {
+        uint16_t scan_time = timer_read() | 1; /* time should not be 0 */
+        bool     queued_all;
+        do {
+            queued_all = queue_matrix_changes(matrix_prev, scan_time);
+
+            keyevent_t event;
+            while (!keys_per_scan_reached(keys_processed) && keyevent_queue_pop(&event)) {
+                action_exec(event);
+                keys_processed++;
+            }
+        } while (!queued_all && !keys_per_scan_reached(keys_processed));
+    }
+    // call with pseudo tick event when no real key event.
+    if (!keys_processed) {
+        action_exec(TICK);
+    }
+#else
     if (should_process_keypress()) {
         for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
             matrix_row    = matrix_get_row(r);
@@ -356,9 +469,13 @@ void keyboard_task(void) {
                 matrix_row_t col_mask = 1;
                 for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
                     if (matrix_change & col_mask) {
-                        action_exec((keyevent_t){
+                        keyevent_t event = {
                             .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
-                        });
+                        };
+#ifdef KEYEVENT_TIME_US
+                        event.time_us = matrix_scan_time_us();
+#endif
+                        action_exec(event);
                         // record a processed key
                         matrix_prev[r] ^= col_mask;
 #ifdef QMK_KEYS_PER_SCAN
@@ -380,6 +497,7 @@ void keyboard_task(void) {
         action_exec(TICK);
 
 MATRIX_LOOP_END:
+#endif
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
@@ -35,6 +35,9 @@ typedef struct {
     keypos_t key;
     bool     pressed;
     uint16_t time;
+#ifdef KEYEVENT_TIME_US
+    uint32_t time_us; /* time of the matrix scan that found the event, in microseconds */
+#endif
 } keyevent_t;
 
 /* equivalent test of keypos_t */
@@ -49,8 +52,13 @@ static inline bool IS_PRESSED(keyevent_t event) { return (!IS_NOEVENT(event) &&
 static inline bool IS_RELEASED(keyevent_t event) { return (!IS_NOEVENT(event) && !event.pressed); }
 
 /* Tick event */
-#define TICK \
-    (keyevent_t) { .key = (keypos_t){.row = 255, .col = 255}, .pressed = false, .time = (timer_read() | 1) }
+#ifdef KEYEVENT_TIME_US
+#    define TICK \
+        (keyevent_t) { .key = (keypos_t){.row = 255, .col = 255}, .pressed = false, .time = (timer_read() | 1), .time_us = timer_read_us() }
+#else
+#    define TICK \
+        (keyevent_t) { .key = (keypos_t){.row = 255, .col = 255}, .pressed = false, .time = (timer_read() | 1) }
+#endif
 
 /* it runs once at early stage of startup before keyboard_init. */
 void keyboard_setup(void);
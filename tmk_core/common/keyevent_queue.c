@@ -0,0 +1,73 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyevent_queue.h"
+
+#if KEYEVENT_QUEUE_SIZE > 255
+#    error "KEYEVENT_QUEUE_SIZE must be 255 or less."
+#endif
+
+static keyevent_t             queue[KEYEVENT_QUEUE_SIZE];
+static uint8_t                queue_head  = 0;
+static uint8_t                queue_count = 0;
+static keyevent_queue_stats_t stats;
+
+#define QUEUE_INDEX(i) ((uint8_t)((queue_head + (i)) % KEYEVENT_QUEUE_SIZE))
+
+// Times are compared as a difference so that they can wrap around
+#ifdef KEYEVENT_TIME_US
+#    define EVENT_IS_OLDER(a, b) ((int32_t)((a).time_us - (b).time_us) < 0)
+#else
+#    define EVENT_IS_OLDER(a, b) ((int16_t)((a).time - (b).time) < 0)
+#endif
+
+bool keyevent_queue_push(keyevent_t event) {
+    if (queue_count == KEYEVENT_QUEUE_SIZE) {
+        stats.overflows++;
+        return false;
+    }
+
+    // Move newer events up to make room
+    uint8_t i = queue_count;
+    while (i > 0 && EVENT_IS_OLDER(event, queue[QUEUE_INDEX(i - 1)])) {
+        queue[QUEUE_INDEX(i)] = queue[QUEUE_INDEX(i - 1)];
+        i--;
+    }
+    queue[QUEUE_INDEX(i)] = event;
+    queue_count++;
+
+    stats.pushed++;
+    if (queue_count > stats.max_count) {
+        stats.max_count = queue_count;
+    }
+    return true;
+}
+
+bool keyevent_queue_pop(keyevent_t *event) {
+    if (queue_count == 0) {
+        return false;
+    }
+    *event     = queue[queue_head];
+    queue_head = QUEUE_INDEX(1);
+    queue_count--;
+    return true;
+}
+
+uint8_t keyevent_queue_count(void) { return queue_count; }
+
+void keyevent_queue_clear(void) { queue_count = 0; }
+
+const keyevent_queue_stats_t *keyevent_queue_get_stats(void) { return &stats; }
@@ -0,0 +1,56 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Queue of key events, drained in chronological order.
+ *
+ * Events are timestamped by whoever produces them, for the matrix at scan time.
+ * An event older than the ones already queued is inserted ahead of them, so
+ * that events are always popped oldest first, and in the order they were
+ * pushed for the same time. When the queue is full, the event is refused and
+ * the producer has to hold on to it until the queue has been drained.
+ */
+
+#ifndef KEYEVENT_QUEUE_SIZE
+#    define KEYEVENT_QUEUE_SIZE 16
+#endif
+
+typedef struct {
+    uint32_t pushed;     // events queued
+    uint32_t overflows;  // events refused because the queue was full
+    uint8_t  max_count;  // most events queued at once
+} keyevent_queue_stats_t;
+
+bool    keyevent_queue_push(keyevent_t event);
+bool    keyevent_queue_pop(keyevent_t *event);
+uint8_t keyevent_queue_count(void);
+void    keyevent_queue_clear(void);
+
+const keyevent_queue_stats_t *keyevent_queue_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -57,6 +57,13 @@ void matrix_print(void);
 /* delay between changing matrix pin state and reading values */
 void matrix_io_delay(void);
 
+#ifdef KEYEVENT_TIME_US
+/* records the current time as the time of the scan, called by matrix_scan() when it reads the switches */
+void matrix_scan_timestamp(void);
+/* time of the last scan, in microseconds */
+uint32_t matrix_scan_time_us(void);
+#endif
+
 /* power control */
 void matrix_power_up(void);
 void matrix_power_down(void);
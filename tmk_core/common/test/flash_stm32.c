@@ -0,0 +1,143 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "flash_stm32.h"
+
+#define FLASH_SIM_PAGES (FLASH_SIM_SIZE / FLASH_SIM_PAGE_SIZE)
+
+static uint16_t flash[FLASH_SIM_SIZE / 2];
+static uint32_t erase_counts[FLASH_SIM_PAGES];
+static uint32_t program_count;
+static uint32_t error_count;
+static uint64_t busy_time;
+static bool     locked = true;
+static uint32_t operations_until_power_loss;
+static bool     power_loss_pending;
+
+// Returns false if the power has been cut, in which case the operation has no effect
+static bool has_power(void) {
+    if (!power_loss_pending) {
+        return true;
+    }
+    if (operations_until_power_loss == 0) {
+        return false;
+    }
+    operations_until_power_loss--;
+    return true;
+}
+
+void flash_sim_reset(void) {
+    memset(flash, 0xFF, sizeof(flash));
+    memset(erase_counts, 0, sizeof(erase_counts));
+    program_count = 0;
+    error_count   = 0;
+    busy_time     = 0;
+    locked        = true;
+    flash_sim_restore_power();
+}
+
+void flash_sim_cut_power_after(uint32_t operations) {
+    operations_until_power_loss = operations;
+    power_loss_pending          = true;
+}
+
+void flash_sim_restore_power(void) { power_loss_pending = false; }
+
+FLASH_Status FLASH_WaitForLastOperation(uint32_t Timeout) { return FLASH_COMPLETE; }
+
+FLASH_Status FLASH_ErasePage(uint32_t Page_Address) {
+    if (!IS_FLASH_ADDRESS(Page_Address)) {
+        error_count++;
+        return FLASH_BAD_ADDRESS;
+    }
+    if (locked) {
+        error_count++;
+        return FLASH_ERROR_WRP;
+    }
+    if (!has_power()) {
+        return FLASH_TIMEOUT;
+    }
+    uint32_t page = (Page_Address - FLASH_SIM_BASE_ADDRESS) / FLASH_SIM_PAGE_SIZE;
+    memset(&flash[page * FLASH_SIM_PAGE_SIZE / 2], 0xFF, FLASH_SIM_PAGE_SIZE);
+    erase_counts[page]++;
+    busy_time += FLASH_SIM_ERASE_TIME_US;
+    return FLASH_COMPLETE;
+}
+
+FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data) {
+    if (!IS_FLASH_ADDRESS(Address) || (Address & 1)) {
+        error_count++;
+        return FLASH_BAD_ADDRESS;
+    }
+    if (locked) {
+        error_count++;
+        return FLASH_ERROR_WRP;
+    }
+    uint16_t *halfword = &flash[(Address - FLASH_SIM_BASE_ADDRESS) / 2];
+    if (*halfword != 0xFFFF && Data != 0) {
+        error_count++;
+        return FLASH_ERROR_PG;
+    }
+    if (!has_power()) {
+        return FLASH_TIMEOUT;
+    }
+    *halfword = Data;
+    program_count++;
+    busy_time += FLASH_SIM_PROGRAM_TIME_US;
+    return FLASH_COMPLETE;
+}
+
+uint16_t FLASH_ReadHalfWord(uint32_t Address) {
+    if (!IS_FLASH_ADDRESS(Address)) {
+        error_count++;
+        return 0xFFFF;
+    }
+    return flash[(Address - FLASH_SIM_BASE_ADDRESS) / 2];
+}
+
+void FLASH_Unlock(void) { locked = false; }
+
+void FLASH_Lock(void) { locked = true; }
+
+void FLASH_ClearFlag(uint32_t FLASH_FLAG) {}
+
+uint32_t flash_sim_erase_count(uint32_t Page_Address) { return erase_counts[(Page_Address - FLASH_SIM_BASE_ADDRESS) / FLASH_SIM_PAGE_SIZE]; }
+
+uint32_t flash_sim_max_erase_count(void) {
+    uint32_t max = 0;
+    for (uint32_t page = 0; page < FLASH_SIM_PAGES; page++) {
+        if (erase_counts[page] > max) {
+            max = erase_counts[page];
+        }
+    }
+    return max;
+}
+
+uint32_t flash_sim_total_erase_count(void) {
+    uint32_t total = 0;
+    for (uint32_t page = 0; page < FLASH_SIM_PAGES; page++) {
+        total += erase_counts[page];
+    }
+    return total;
+}
+
+uint32_t flash_sim_program_count(void) { return program_count; }
+
+uint32_t flash_sim_error_count(void) { return error_count; }
+
+uint64_t flash_sim_busy_time(void) { return busy_time; }
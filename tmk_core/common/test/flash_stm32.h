@@ -0,0 +1,80 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host-side simulation of the STM32 flash, used to test flash based EEPROM emulation.
+ *
+ * Like the real thing, erasing sets a whole page to 0xFF, and programming a half
+ * word is only allowed when it is erased, or when clearing it to zero. Erase and
+ * program operations are counted per page, and accumulate simulated busy time.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#ifndef FLASH_SIM_BASE_ADDRESS
+#    define FLASH_SIM_BASE_ADDRESS 0x08000000
+#endif
+#ifndef FLASH_SIM_PAGE_SIZE
+#    define FLASH_SIM_PAGE_SIZE 0x400
+#endif
+#ifndef FLASH_SIM_SIZE
+#    define FLASH_SIM_SIZE (32 * 1024)
+#endif
+
+// Typical timings of an STM32F0/F1
+#ifndef FLASH_SIM_ERASE_TIME_US
+#    define FLASH_SIM_ERASE_TIME_US 20000
+#endif
+#ifndef FLASH_SIM_PROGRAM_TIME_US
+#    define FLASH_SIM_PROGRAM_TIME_US 50
+#endif
+
+typedef enum { FLASH_BUSY = 1, FLASH_ERROR_PG, FLASH_ERROR_WRP, FLASH_ERROR_OPT, FLASH_COMPLETE, FLASH_TIMEOUT, FLASH_BAD_ADDRESS } FLASH_Status;
+
+#define IS_FLASH_ADDRESS(ADDRESS) (((ADDRESS) >= FLASH_SIM_BASE_ADDRESS) && ((ADDRESS) < FLASH_SIM_BASE_ADDRESS + FLASH_SIM_SIZE))
+
+FLASH_Status FLASH_WaitForLastOperation(uint32_t Timeout);
+FLASH_Status FLASH_ErasePage(uint32_t Page_Address);
+FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data);
+uint16_t     FLASH_ReadHalfWord(uint32_t Address);
+
+void FLASH_Unlock(void);
+void FLASH_Lock(void);
+void FLASH_ClearFlag(uint32_t FLASH_FLAG);
+
+// Erases the whole flash, locks it and clears all statistics. Must be called before first use.
+void     flash_sim_reset(void);
+uint32_t flash_sim_erase_count(uint32_t Page_Address);
+uint32_t flash_sim_max_erase_count(void);
+uint32_t flash_sim_total_erase_count(void);
+uint32_t flash_sim_program_count(void);
+// Failed operations, e.g. programming a half word that isn't erased
+uint32_t flash_sim_error_count(void);
+// Lets the given number of erase/program operations complete, and silently drops all after that
+void flash_sim_cut_power_after(uint32_t operations);
+void flash_sim_restore_power(void);
+// Simulated time spent erasing and programming, in microseconds
+uint64_t flash_sim_busy_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,106 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gpio.h"
+
+#define GPIO_MOCK_PINS (GPIO_MOCK_PORTS * 16)
+
+typedef struct {
+    pin_t a;
+    pin_t b;
+} gpio_mock_switch_t;
+
+static gpio_mock_mode_t   modes[GPIO_MOCK_PINS];
+static bool               levels[GPIO_MOCK_PINS];
+static gpio_mock_switch_t switches[GPIO_MOCK_SWITCHES];
+static uint8_t            switch_count;
+static uint32_t           read_count;
+
+void gpio_mock_reset(void) {
+    for (uint16_t pin = 0; pin < GPIO_MOCK_PINS; pin++) {
+        modes[pin]  = GPIO_MOCK_INPUT;
+        levels[pin] = false;
+    }
+    switch_count = 0;
+    read_count   = 0;
+}
+
+static bool gpio_mock_valid(pin_t pin) { return pin < GPIO_MOCK_PINS; }
+
+void gpio_mock_switch(pin_t a, pin_t b, bool closed) {
+    for (uint8_t i = 0; i < switch_count; i++) {
+        if ((switches[i].a == a && switches[i].b == b) || (switches[i].a == b && switches[i].b == a)) {
+            if (!closed) {
+                switches[i] = switches[--switch_count];
+            }
+            return;
+        }
+    }
+    if (closed && switch_count < GPIO_MOCK_SWITCHES) {
+        switches[switch_count++] = (gpio_mock_switch_t){.a = a, .b = b};
+    }
+}
+
+gpio_mock_mode_t gpio_mock_get_mode(pin_t pin) { return gpio_mock_valid(pin) ? modes[pin] : GPIO_MOCK_INPUT; }
+
+void gpio_mock_set_mode(pin_t pin, gpio_mock_mode_t mode) {
+    if (gpio_mock_valid(pin)) {
+        modes[pin] = mode;
+    }
+}
+
+void gpio_mock_write(pin_t pin, bool level) {
+    if (gpio_mock_valid(pin)) {
+        levels[pin] = level;
+    }
+}
+
+static bool gpio_mock_level(pin_t pin) {
+    if (!gpio_mock_valid(pin)) {
+        return true;
+    }
+    if (modes[pin] == GPIO_MOCK_OUTPUT) {
+        return levels[pin];
+    }
+
+    bool driven = false, level = true;
+    for (uint8_t i = 0; i < switch_count; i++) {
+        pin_t other = switches[i].a == pin ? switches[i].b : switches[i].b == pin ? switches[i].a : pin;
+        if (other != pin && gpio_mock_valid(other) && modes[other] == GPIO_MOCK_OUTPUT) {
+            driven = true;
+            level &= levels[other];
+        }
+    }
+    // A floating input reads high, as if it had a weak pull up
+    return driven ? level : modes[pin] != GPIO_MOCK_INPUT_LOW;
+}
+
+bool gpio_mock_read(pin_t pin) {
+    read_count++;
+    return gpio_mock_level(pin);
+}
+
+port_data_t gpio_mock_read_port(pin_port_t port) {
+    read_count++;
+    port_data_t data = 0;
+    for (uint8_t pad = 0; pad < 16; pad++) {
+        data |= (port_data_t)gpio_mock_level(GPIO_MOCK_PIN(port, pad)) << pad;
+    }
+    return data;
+}
+
+uint32_t gpio_mock_read_count(void) { return read_count; }
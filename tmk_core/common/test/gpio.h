@@ -0,0 +1,90 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host-side mock of the GPIO pins, used to test matrix code.
+ *
+ * Pins are numbered like on AVR, 16 to a port. An input reads the level of
+ * the outputs that closed switches connect it to, low winning over high, and
+ * its pull otherwise. Switches have no diodes, so ghosting isn't modelled.
+ *
+ * Tests force it into their sources with <test>_CONFIG, so that it stands in
+ * for the platform's GPIO macros.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t  pin_t;
+typedef uint8_t  pin_port_t;
+typedef uint16_t port_data_t;
+
+#ifndef GPIO_MOCK_PORTS
+#    define GPIO_MOCK_PORTS 4
+#endif
+
+#ifndef GPIO_MOCK_SWITCHES
+#    define GPIO_MOCK_SWITCHES 32
+#endif
+
+#define GPIO_MOCK_PIN(port, pad) ((pin_t)((port) << 4 | (pad)))
+
+typedef enum {
+    GPIO_MOCK_INPUT,
+    GPIO_MOCK_INPUT_HIGH,
+    GPIO_MOCK_INPUT_LOW,
+    GPIO_MOCK_OUTPUT,
+} gpio_mock_mode_t;
+
+void        gpio_mock_set_mode(pin_t pin, gpio_mock_mode_t mode);
+void        gpio_mock_write(pin_t pin, bool level);
+bool        gpio_mock_read(pin_t pin);
+port_data_t gpio_mock_read_port(pin_port_t port);
+
+#define setPinInput(pin) gpio_mock_set_mode(pin, GPIO_MOCK_INPUT)
+#define setPinInputHigh(pin) gpio_mock_set_mode(pin, GPIO_MOCK_INPUT_HIGH)
+#define setPinInputLow(pin) gpio_mock_set_mode(pin, GPIO_MOCK_INPUT_LOW)
+#define setPinOutput(pin) gpio_mock_set_mode(pin, GPIO_MOCK_OUTPUT)
+
+#define writePinHigh(pin) gpio_mock_write(pin, true)
+#define writePinLow(pin) gpio_mock_write(pin, false)
+#define writePin(pin, level) gpio_mock_write(pin, level)
+
+#define readPin(pin) gpio_mock_read(pin)
+
+#define togglePin(pin) gpio_mock_write(pin, !gpio_mock_read(pin))
+
+#define getPinPort(pin) ((pin_port_t)((pin) >> 4))
+#define getPinPad(pin) ((pin)&0xF)
+#define readPort(port) gpio_mock_read_port(port)
+
+void gpio_mock_reset(void);
+// Closes or opens the switch between two pins
+void             gpio_mock_switch(pin_t a, pin_t b, bool closed);
+gpio_mock_mode_t gpio_mock_get_mode(pin_t pin);
+
+// Reads done since the last reset, a port read counting as one
+uint32_t gpio_mock_read_count(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,163 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "i2c_master.h"
+#include "i2c_async.h"
+
+typedef struct {
+    uint8_t  address;
+    uint8_t* registers;
+    uint16_t size;
+    uint16_t pointer;
+} i2c_mock_device_t;
+
+static i2c_mock_device_t       devices[I2C_MOCK_BUS_DEVICES];
+static uint8_t                 device_count;
+static i2c_status_t            next_failure;
+static i2c_mock_bus_transfer_t transfer_log[I2C_MOCK_BUS_LOG_SIZE];
+static uint16_t                transfer_count;
+
+void i2c_mock_bus_reset(void) {
+    i2c_mock_bus_run();
+    i2c_async_task();
+    device_count   = 0;
+    next_failure   = I2C_STATUS_SUCCESS;
+    transfer_count = 0;
+}
+
+void i2c_mock_bus_add_device(uint8_t address, uint8_t* registers, uint16_t size) {
+    if (device_count < I2C_MOCK_BUS_DEVICES) {
+        devices[device_count++] = (i2c_mock_device_t){.address = address, .registers = registers, .size = size};
+    }
+}
+
+void i2c_mock_bus_fail_next(i2c_status_t status) { next_failure = status; }
+
+static i2c_mock_device_t* i2c_mock_bus_find(uint8_t address) {
+    for (uint8_t i = 0; i < device_count; i++) {
+        if (devices[i].address == address) {
+            return &devices[i];
+        }
+    }
+    return NULL;
+}
+
+static void i2c_mock_device_write(i2c_mock_device_t* device, const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        device->registers[device->pointer++ % device->size] = data[i];
+    }
+}
+
+static void i2c_mock_device_read(i2c_mock_device_t* device, uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = device->registers[device->pointer++ % device->size];
+    }
+}
+
+static i2c_status_t i2c_mock_bus_execute(const i2c_async_request_t* request) {
+    if (next_failure != I2C_STATUS_SUCCESS) {
+        i2c_status_t status = next_failure;
+        next_failure        = I2C_STATUS_SUCCESS;
+        return status;
+    }
+
+    i2c_mock_device_t* device = i2c_mock_bus_find(request->address);
+    if (device == NULL) {
+        return I2C_STATUS_ERROR;
+    }
+
+    switch (request->operation) {
+        case I2C_ASYNC_TRANSMIT:
+            if (request->length > 0) {
+                device->pointer = request->data[0];
+                i2c_mock_device_write(device, request->data + 1, request->length - 1);
+            }
+            break;
+        case I2C_ASYNC_RECEIVE:
+            i2c_mock_device_read(device, request->data, request->length);
+            break;
+        case I2C_ASYNC_WRITE_REG:
+            device->pointer = request->reg;
+            i2c_mock_device_write(device, request->data, request->length);
+            break;
+        case I2C_ASYNC_READ_REG:
+            device->pointer = request->reg;
+            i2c_mock_device_read(device, request->data, request->length);
+            break;
+    }
+    return I2C_STATUS_SUCCESS;
+}
+
+bool i2c_mock_bus_step(void) {
+    const i2c_async_request_t* request = i2c_async_next();
+    if (request == NULL) {
+        return false;
+    }
+
+    i2c_status_t status = i2c_mock_bus_execute(request);
+    if (transfer_count < I2C_MOCK_BUS_LOG_SIZE) {
+        transfer_log[transfer_count] = (i2c_mock_bus_transfer_t){.address = request->address, .operation = request->operation, .length = request->length, .status = status};
+    }
+    transfer_count++;
+    i2c_async_complete(status);
+    return true;
+}
+
+void i2c_mock_bus_run(void) {
+    while (i2c_mock_bus_step()) {
+    }
+}
+
+uint16_t i2c_mock_bus_transfer_count(void) { return transfer_count; }
+
+const i2c_mock_bus_transfer_t* i2c_mock_bus_transfer(uint16_t index) { return index < transfer_count && index < I2C_MOCK_BUS_LOG_SIZE ? &transfer_log[index] : NULL; }
+
+void i2c_async_backend_init(void) {}
+
+void i2c_async_backend_kick(void) {}
+
+void i2c_async_backend_lock(void) {}
+
+void i2c_async_backend_unlock(void) {}
+
+// The bus makes progress while somebody is waiting on it
+void i2c_async_backend_wait(void) { i2c_mock_bus_step(); }
+
+void i2c_init(void) {}
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_request_t request = {.operation = I2C_ASYNC_TRANSMIT, .address = address, .data = (uint8_t*)data, .length = length, .timeout = timeout};
+    return i2c_async_transfer(&request);
+}
+
+i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_request_t request = {.operation = I2C_ASYNC_RECEIVE, .address = address, .data = data, .length = length, .timeout = timeout};
+    return i2c_async_transfer(&request);
+}
+
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_request_t request = {.operation = I2C_ASYNC_WRITE_REG, .address = devaddr, .reg = regaddr, .data = (uint8_t*)data, .length = length, .timeout = timeout};
+    return i2c_async_transfer(&request);
+}
+
+i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_request_t request = {.operation = I2C_ASYNC_READ_REG, .address = devaddr, .reg = regaddr, .data = data, .length = length, .timeout = timeout};
+    return i2c_async_transfer(&request);
+}
+
+void i2c_stop(void) { i2c_async_flush(); }
@@ -0,0 +1,80 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host-side mock of the I2C master driver, used to test I2C code.
+ *
+ * Devices are register files attached to the bus at an address. A transmit
+ * sets the register pointer from its first byte and writes the rest, a receive
+ * reads from the register pointer, which auto-increments like on most devices.
+ * Transactions to an address without a device fail like a NACK would.
+ *
+ * Queued asynchronous transactions only progress when the test steps the bus,
+ * or while a blocking call waits for its own transaction.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int16_t i2c_status_t;
+
+#define I2C_STATUS_SUCCESS (0)
+#define I2C_STATUS_ERROR (-1)
+#define I2C_STATUS_TIMEOUT (-2)
+
+void         i2c_init(void);
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
+void         i2c_stop(void);
+
+#ifndef I2C_MOCK_BUS_DEVICES
+#    define I2C_MOCK_BUS_DEVICES 4
+#endif
+
+#ifndef I2C_MOCK_BUS_LOG_SIZE
+#    define I2C_MOCK_BUS_LOG_SIZE 32
+#endif
+
+typedef struct {
+    uint8_t      address;
+    uint8_t      operation;  // i2c_async_operation_t
+    uint16_t     length;
+    i2c_status_t status;
+} i2c_mock_bus_transfer_t;
+
+void i2c_mock_bus_reset(void);
+void i2c_mock_bus_add_device(uint8_t address, uint8_t* registers, uint16_t size);
+// Makes the next transaction fail with the given status
+void i2c_mock_bus_fail_next(i2c_status_t status);
+// Carries out the next queued transaction, returns false if there was none
+bool i2c_mock_bus_step(void);
+void i2c_mock_bus_run(void);
+
+// Transactions carried out since the last reset, oldest first
+uint16_t                       i2c_mock_bus_transfer_count(void);
+const i2c_mock_bus_transfer_t* i2c_mock_bus_transfer(uint16_t index);
+
+#ifdef __cplusplus
+}
+#endif
@@ -16,18 +16,32 @@
 
 #include "timer.h"
 
-static uint32_t current_time = 0;
+static uint32_t current_time    = 0;
+static uint16_t current_time_us = 0;  // microseconds into the current millisecond
 
-void timer_init(void) { current_time = 0; }
+void timer_init(void) { timer_clear(); }
 
-void timer_clear(void) { current_time = 0; }
+void timer_clear(void) {
+    current_time    = 0;
+    current_time_us = 0;
+}
 
 uint16_t timer_read(void) { return current_time & 0xFFFF; }
 uint32_t timer_read32(void) { return current_time; }
 uint16_t timer_elapsed(uint16_t last) { return TIMER_DIFF_16(timer_read(), last); }
 uint32_t timer_elapsed32(uint32_t last) { return TIMER_DIFF_32(timer_read32(), last); }
+uint32_t timer_read_us(void) { return current_time * 1000 + current_time_us; }
+uint32_t timer_elapsed_us(uint32_t last) { return TIMER_DIFF_32(timer_read_us(), last); }
 
-void set_time(uint32_t t) { current_time = t; }
+void set_time(uint32_t t) {
+    current_time    = t;
+    current_time_us = 0;
+}
 void advance_time(uint32_t ms) { current_time += ms; }
+void advance_time_us(uint32_t us) {
+    us += current_time_us;
+    current_time += us / 1000;
+    current_time_us = us % 1000;
+}
 
 void wait_ms(uint32_t ms) { advance_time(ms); }
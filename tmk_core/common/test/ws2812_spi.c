@@ -0,0 +1,81 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Host-side stand-in for the ChibiOS SPI WS2812 driver, used to test code
+ * that streams frames to it. A frame stays in flight until the test finishes
+ * it with ws2812_mock_finish_frame(). Like the real driver, a frame sent while
+ * another is in flight is kept, and started once that one has finished.
+ */
+
+#include <string.h>
+
+#include "ws2812.h"
+
+#ifndef WS2812_MOCK_MAX_LEDS
+#    define WS2812_MOCK_MAX_LEDS 256
+#endif
+
+LED_TYPE ws2812_mock_leds[WS2812_MOCK_MAX_LEDS];
+uint32_t ws2812_mock_frames;
+
+static LED_TYPE pending_leds[WS2812_MOCK_MAX_LEDS];
+static uint16_t pending_count;
+static bool     pending   = false;
+static bool     in_flight = false;
+
+static void ws2812_mock_start_frame(LED_TYPE *ledarray, uint16_t leds) {
+    memcpy(ws2812_mock_leds, ledarray, sizeof(LED_TYPE) * leds);
+    ws2812_mock_frames++;
+    in_flight = true;
+}
+
+void ws2812_setleds_async(LED_TYPE *ledarray, uint16_t leds) {
+    if (leds > WS2812_MOCK_MAX_LEDS) {
+        leds = WS2812_MOCK_MAX_LEDS;
+    }
+    if (in_flight) {
+        memcpy(pending_leds, ledarray, sizeof(LED_TYPE) * leds);
+        pending_count = leds;
+        pending       = true;
+        return;
+    }
+    ws2812_mock_start_frame(ledarray, leds);
+}
+
+void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) { ws2812_setleds_async(ledarray, leds); }
+
+bool ws2812_frame_in_flight(void) { return in_flight; }
+
+__attribute__((weak)) void ws2812_frame_complete(void) {}
+
+bool ws2812_mock_frame_pending(void) { return pending; }
+
+void ws2812_mock_finish_frame(void) {
+    in_flight = false;
+    if (pending) {
+        pending = false;
+        ws2812_mock_start_frame(pending_leds, pending_count);
+    }
+    ws2812_frame_complete();
+}
+
+void ws2812_mock_reset(void) {
+    in_flight          = false;
+    pending            = false;
+    ws2812_mock_frames = 0;
+}